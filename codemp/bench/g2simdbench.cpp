@@ -0,0 +1,165 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// g2simdbench.cpp -- times the Ghoul2 scalar and SSE2 kernels on random
+// skeletons and checks they agree. Exits non-zero if they don't.
+//
+// usage: g2simdbench [iterations]
+
+#include "ghoul2/G2_simd.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define NUM_BONES		72		// a humanoid skeleton
+#define NUM_VERTS		4096
+
+typedef struct benchVert_s {
+	int		numWeights;
+	int		bones[iMAX_G2_BONEWEIGHTS_PER_VERT];
+	float	weights[iMAX_G2_BONEWEIGHTS_PER_VERT];
+	vec3_t	coords;
+} benchVert_t;
+
+static std::mt19937 rng( 1234 );
+
+static float RandomFloat( float lo, float hi ) {
+	return std::uniform_real_distribution<float>( lo, hi )( rng );
+}
+
+// a rotation close to orthonormal with a translation, like the bone cache holds
+static void RandomBone( mdxaBone_t *bone ) {
+	vec3_t angles, axis[3];
+
+	VectorSet( angles, RandomFloat( -180, 180 ), RandomFloat( -180, 180 ), RandomFloat( -180, 180 ) );
+	AnglesToAxis( angles, axis );
+
+	for ( int i = 0; i < 3; i++ ) {
+		for ( int j = 0; j < 3; j++ ) {
+			bone->matrix[i][j] = axis[j][i];
+		}
+		bone->matrix[i][3] = RandomFloat( -64, 64 );
+	}
+}
+
+static void RandomVert( benchVert_t *v ) {
+	float total = 0.0f;
+
+	v->numWeights = 1 + rng() % iMAX_G2_BONEWEIGHTS_PER_VERT;
+	for ( int k = 0; k < v->numWeights; k++ ) {
+		v->bones[k] = rng() % NUM_BONES;
+		v->weights[k] = RandomFloat( 0.05f, 1.0f );
+		total += v->weights[k];
+	}
+	for ( int k = 0; k < v->numWeights; k++ ) {
+		v->weights[k] /= total;
+	}
+	VectorSet( v->coords, RandomFloat( -48, 48 ), RandomFloat( -48, 48 ), RandomFloat( -48, 48 ) );
+}
+
+static double Seconds( std::chrono::steady_clock::time_point start ) {
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+template<typename Kernel>
+static double TimeConcat( const std::vector<mdxaBone_t> &bones, std::vector<mdxaBone_t> &out, int iterations, Kernel kernel ) {
+	auto start = std::chrono::steady_clock::now();
+
+	for ( int it = 0; it < iterations; it++ ) {
+		for ( int i = 0; i < NUM_BONES; i++ ) {
+			kernel( &out[i], &bones[i], &bones[(i + it + 1) % NUM_BONES] );
+		}
+	}
+
+	return Seconds( start ) * 1e9 / ( (double)iterations * NUM_BONES );
+}
+
+template<typename Kernel>
+static double TimeSkin( const std::vector<mdxaBone_t> &bones, const std::vector<benchVert_t> &verts, std::vector<float> &out, int iterations, Kernel kernel ) {
+	const vec3_t scale = { 1.0f, 1.0f, 1.0f };
+	auto start = std::chrono::steady_clock::now();
+
+	for ( int it = 0; it < iterations; it++ ) {
+		for ( int j = 0; j < NUM_VERTS; j++ ) {
+			const benchVert_t &v = verts[j];
+			const mdxaBone_t *vertBones[iMAX_G2_BONEWEIGHTS_PER_VERT];
+
+			for ( int k = 0; k < v.numWeights; k++ ) {
+				vertBones[k] = &bones[v.bones[k]];
+			}
+			kernel( vertBones, v.weights, v.numWeights, v.coords, scale, &out[j * 4] );
+		}
+	}
+
+	return Seconds( start ) * 1e9 / ( (double)iterations * NUM_VERTS );
+}
+
+int main( int argc, char **argv ) {
+	const int iterations = argc > 1 ? Q_max( 1, atoi( argv[1] ) ) : 2000;
+	std::vector<mdxaBone_t> bones( NUM_BONES ), concatScalar( NUM_BONES );
+	std::vector<benchVert_t> verts( NUM_VERTS );
+	std::vector<float> skinScalar( NUM_VERTS * 4 );
+
+	for ( auto &bone : bones ) {
+		RandomBone( &bone );
+	}
+	for ( auto &v : verts ) {
+		RandomVert( &v );
+	}
+
+	const double concatScalarNs = TimeConcat( bones, concatScalar, iterations, G2_Multiply3x4_Scalar );
+	const double skinScalarNs = TimeSkin( bones, verts, skinScalar, iterations / 16 + 1, G2_SkinVertex_Scalar );
+
+	printf( "Multiply_3x4Matrix  scalar %7.2f ns\n", concatScalarNs );
+	printf( "skin vertex         scalar %7.2f ns\n", skinScalarNs );
+
+#if idsse2
+	std::vector<mdxaBone_t> concatSimd( NUM_BONES );
+	std::vector<float> skinSimd( NUM_VERTS * 4 );
+	float concatError = 0.0f, skinError = 0.0f;
+
+	const double concatSimdNs = TimeConcat( bones, concatSimd, iterations, G2_Multiply3x4_SSE2 );
+	const double skinSimdNs = TimeSkin( bones, verts, skinSimd, iterations / 16 + 1, G2_SkinVertex_SSE2 );
+
+	printf( "Multiply_3x4Matrix  SSE2   %7.2f ns (%.2fx)\n", concatSimdNs, concatScalarNs / concatSimdNs );
+	printf( "skin vertex         SSE2   %7.2f ns (%.2fx)\n", skinSimdNs, skinScalarNs / skinSimdNs );
+
+	// both ran the same last iteration, so the outputs are directly comparable
+	for ( int i = 0; i < NUM_BONES; i++ ) {
+		concatError = Q_max( concatError, G2_SimdError( &concatScalar[i].matrix[0][0], &concatSimd[i].matrix[0][0], 12 ) );
+	}
+	for ( int j = 0; j < NUM_VERTS; j++ ) {
+		skinError = Q_max( skinError, G2_SimdError( &skinScalar[j * 4], &skinSimd[j * 4], 3 ) );
+	}
+
+	printf( "max relative error: Multiply_3x4Matrix %g, skin vertex %g (tolerance %g)\n", concatError, skinError, G2_SIMD_TOLERANCE );
+	if ( concatError > G2_SIMD_TOLERANCE || skinError > G2_SIMD_TOLERANCE ) {
+		printf( "FAILED\n" );
+		return 1;
+	}
+#else
+	printf( "built without SSE2, nothing to compare\n" );
+#endif
+
+	return 0;
+}
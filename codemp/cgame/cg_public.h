@@ -435,7 +435,10 @@ typedef enum cgameImportLegacy_e {
 	CG_RE_INIT_RENDERER_TERRAIN,
 	CG_R_WEATHER_CONTENTS_OVERRIDE,
 	CG_R_WORLDEFFECTCOMMAND,
-	CG_WE_ADDWEATHERZONE
+	CG_WE_ADDWEATHERZONE,
+	CG_G2_GETBONENUM,
+	CG_G2_ANGLEOVERRIDE_NUM,
+	CG_G2_PLAYANIM_NUM
 } cgameImportLegacy_t;
 
 typedef enum cgameExportLegacy_e {
@@ -717,6 +720,11 @@ typedef struct cgameImport_s {
 	struct {
 		float			(*R_Font_StrLenPixels)					( const char *text, const int iFontIndex, const float scale );
 	} ext;
+
+	// bone setters by skeleton bone number, resolved once with G2API_GetBoneNum
+	int				(*G2API_GetBoneNum)						( void *ghoul2, int modelIndex, const char *boneName );
+	qboolean		(*G2API_SetBoneAnglesNum)				( void *ghoul2, int modelIndex, int boneNum, const vec3_t angles, const int flags, const int up, const int right, const int forward, qhandle_t *modelList, int blendTime , int currentTime );
+	qboolean		(*G2API_SetBoneAnimNum)					( void *ghoul2, const int modelIndex, int boneNum, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime );
 } cgameImport_t;
 
 typedef struct cgameExport_s {
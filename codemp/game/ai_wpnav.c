@@ -2016,6 +2016,95 @@ void CalculateJumpRoutes(void)
 	}
 }
 
+//the parsed waypoints are kept by the engine between maps, see LoadPathData
+#define ROUTE_DATA_VERSION 1
+
+typedef struct routeData_s
+{
+	int levelFlags;
+	int numWaypoints;
+	wpobject_t waypoints[1];	//numWaypoints of them, as read from the file
+} routeData_t;
+
+static void LoadPathData_Finish(void)
+{
+	if (level.gametype == GT_SIEGE)
+	{
+		CalculateSiegeGoals();
+	}
+
+	CalculateWeightGoals();
+	//calculate weights for idle activity goals when
+	//the bot has absolutely nothing else to do
+
+	CalculateJumpRoutes();
+	//Look at jump points and mark them as requiring
+	//force jumping as needed
+}
+
+static qboolean LoadPathData_Cached(const char *filename, int sourceChecksum)
+{
+	routeData_t *data = NULL;
+	int size, i;
+
+	size = trap->PD_LoadBlob(va("game/botroutes/%s", filename), ROUTE_DATA_VERSION, sourceChecksum, NULL, 0);
+	if (size < (int)sizeof(routeData_t))
+	{
+		return qfalse;
+	}
+
+	trap->TrueMalloc((void **)&data, size);
+	if (!data)
+	{
+		return qfalse;
+	}
+
+	trap->PD_LoadBlob(va("game/botroutes/%s", filename), ROUTE_DATA_VERSION, sourceChecksum, data, size);
+	if (data->numWaypoints < 0 || data->numWaypoints > MAX_WPARRAY_SIZE ||
+		size != (int)(sizeof(routeData_t) + (data->numWaypoints - 1) * sizeof(wpobject_t)))
+	{
+		trap->TrueFree((void **)&data);
+		return qfalse;
+	}
+
+	gLevelFlags = data->levelFlags;
+	for (i = 0; i < data->numWaypoints; i++)
+	{
+		CreateNewWP_FromObject(&data->waypoints[i]);
+	}
+
+	trap->TrueFree((void **)&data);
+	return qtrue;
+}
+
+static void LoadPathData_Store(const char *filename, int sourceChecksum)
+{
+	routeData_t *data = NULL;
+	int size, i;
+
+	if (!gWPNum)
+	{
+		return;
+	}
+
+	size = sizeof(routeData_t) + (gWPNum - 1) * sizeof(wpobject_t);
+	trap->TrueMalloc((void **)&data, size);
+	if (!data)
+	{
+		return;
+	}
+
+	data->levelFlags = gLevelFlags;
+	data->numWaypoints = gWPNum;
+	for (i = 0; i < gWPNum; i++)
+	{
+		data->waypoints[i] = *gWPArray[i];
+	}
+
+	trap->PD_StoreBlob(va("game/botroutes/%s", filename), ROUTE_DATA_VERSION, sourceChecksum, data, size);
+	trap->TrueFree((void **)&data);
+}
+
 int LoadPathData(const char *filename)
 {
 	fileHandle_t f;
@@ -2026,6 +2115,7 @@ int LoadPathData(const char *filename)
 	int len;
 	int i, i_cv;
 	int nei_num;
+	int sourceChecksum;
 
 	i = 0;
 	i_cv = 0;
@@ -2034,6 +2124,15 @@ int LoadPathData(const char *filename)
 
 	Com_sprintf(routePath, 1024, "botroutes/%s.wnt\0", filename);
 
+	//skip parsing the route file again if it hasn't changed since the last time
+	sourceChecksum = trap->PD_FileChecksum(routePath);
+	if (sourceChecksum && LoadPathData_Cached(filename, sourceChecksum))
+	{
+		B_TempFree(1024); //routePath
+		LoadPathData_Finish();
+		return 1;
+	}
+
 	len = trap->FS_Open(routePath, &f, FS_READ);
 
 	B_TempFree(1024); //routePath
@@ -2246,18 +2345,10 @@ int LoadPathData(const char *filename)
 
 	trap->FS_Close(f);
 
-	if (level.gametype == GT_SIEGE)
-	{
-		CalculateSiegeGoals();
-	}
-
-	CalculateWeightGoals();
-	//calculate weights for idle activity goals when
-	//the bot has absolutely nothing else to do
+	//before the goals and jump routes are worked out, those depend on the entities
+	LoadPathData_Store(filename, sourceChecksum);
 
-	CalculateJumpRoutes();
-	//Look at jump points and mark them as requiring
-	//force jumping as needed
+	LoadPathData_Finish();
 
 	return 1;
 }
@@ -1676,16 +1676,32 @@ qboolean BG_LegalizedForcePowers(char *powerOut, size_t powerOutSize, int maxRan
 // given a boltmatrix, return in vec a normalised vector for the axis requested in flags
 void BG_GiveMeVectorFromMatrix(mdxaBone_t *boltMatrix, int flags, vec3_t vec);
 
-void BG_IK_MoveArm(void *ghoul2, int lHandBolt, int time, entityState_t *ent, int basePose, vec3_t desiredPos, qboolean *ikInProgress,
+// humanoid bones the BG animation code sets every frame, by skeleton bone number
+typedef enum {
+	G2BONE_LOWER_LUMBAR,
+	G2BONE_UPPER_LUMBAR,
+	G2BONE_THORACIC,
+	G2BONE_CERVICAL,
+	G2BONE_CRANIUM,
+	G2BONE_MODEL_ROOT,
+	G2BONE_MOTION,
+	G2BONE_LHUMERUS,
+	G2BONE_LRADIUS,
+	G2BONE_NUM
+} g2Bone_t;
+
+void BG_G2ResolveBones(void *ghoul2, int *bones);
+
+void BG_IK_MoveArm(void *ghoul2, const int *bones, int lHandBolt, int time, entityState_t *ent, int basePose, vec3_t desiredPos, qboolean *ikInProgress,
 					 vec3_t origin, vec3_t angles, vec3_t scale, int blendTime, qboolean forceHalt);
 
-void BG_G2PlayerAngles(void *ghoul2, int motionBolt, entityState_t *cent, int time, vec3_t cent_lerpOrigin,
+void BG_G2PlayerAngles(void *ghoul2, const int *bones, int motionBolt, entityState_t *cent, int time, vec3_t cent_lerpOrigin,
 					   vec3_t cent_lerpAngles, matrix3_t legs, vec3_t legsAngles, qboolean *tYawing,
 					   qboolean *tPitching, qboolean *lYawing, float *tYawAngle, float *tPitchAngle,
 					   float *lYawAngle, int frametime, vec3_t turAngles, vec3_t modelScale, int ciLegs,
 					   int ciTorso, int *corrTime, vec3_t lookAngles, vec3_t lastHeadAngles, int lookTime,
 					   entityState_t *emplaced, int *crazySmoothFactor);
-void BG_G2ATSTAngles(void *ghoul2, int time, vec3_t cent_lerpAngles );
+void BG_G2ATSTAngles(void *ghoul2, const int *bones, int time, vec3_t cent_lerpAngles );
 
 //BG anim utility functions:
 
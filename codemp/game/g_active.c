@@ -1119,6 +1119,24 @@ static const float maxJediMasterFOV = 100.0f;
 static const float maxForceSightDistance = Square( 1500.0f ) * 1500.0f; // x^2, optimisation
 static const float maxForceSightFOV = 100.0f;
 
+// can other see self, using the client matrix when self is a client
+static qboolean G_BroadcastInView( gentity_t *self, gentity_t *other, float maxDist, float fov ) {
+	vec3_t angles;
+
+	if ( self->s.number < MAX_CLIENTS ) {
+		return ( G_ClientDistanceSquared( other->s.number, self->s.number ) < maxDist
+			&& G_ClientInFieldOfVision( other->s.number, self->s.number, fov ) ) ? qtrue : qfalse;
+	}
+
+	VectorSubtract( self->client->ps.origin, other->client->ps.origin, angles );
+	if ( VectorLengthSquared( angles ) >= maxDist ) {
+		return qfalse;
+	}
+	vectoangles( angles, angles );
+
+	return InFieldOfVision( other->client->ps.viewangles, fov, angles ) ? qtrue : qfalse;
+}
+
 void G_UpdateClientBroadcasts( gentity_t *self ) {
 	int i;
 	gentity_t *other;
@@ -1133,8 +1151,6 @@ void G_UpdateClientBroadcasts( gentity_t *self ) {
 
 	for ( i = 0, other = g_entities; i < MAX_CLIENTS; i++, other++ ) {
 		qboolean send = qfalse;
-		float dist;
-		vec3_t angles;
 
 		if ( !other->inuse || other->client->pers.connected != CON_CONNECTED ) {
 			// no need to compute visibility for non-connected clients
@@ -1146,23 +1162,17 @@ void G_UpdateClientBroadcasts( gentity_t *self ) {
 			continue;
 		}
 
-		VectorSubtract( self->client->ps.origin, other->client->ps.origin, angles );
-		dist = VectorLengthSquared( angles );
-		vectoangles( angles, angles );
-
 		// broadcast jedi master to everyone if we are in distance/field of view
 		if ( level.gametype == GT_JEDIMASTER && self->client->ps.isJediMaster ) {
-			if ( dist < maxJediMasterDistance
-				&& InFieldOfVision( other->client->ps.viewangles, maxJediMasterFOV, angles ) )
+			if ( G_BroadcastInView( self, other, maxJediMasterDistance, maxJediMasterFOV ) )
 			{
 				send = qtrue;
 			}
 		}
 
 		// broadcast this client to everyone using force sight if we are in distance/field of view
-		if ( (other->client->ps.fd.forcePowersActive & (1 << FP_SEE)) ) {
-			if ( dist < maxForceSightDistance
-				&& InFieldOfVision( other->client->ps.viewangles, maxForceSightFOV, angles ) )
+		if ( !send && (other->client->ps.fd.forcePowersActive & (1 << FP_SEE)) ) {
+			if ( G_BroadcastInView( self, other, maxForceSightDistance, maxForceSightFOV ) )
 			{
 				send = qtrue;
 			}
@@ -3497,7 +3507,12 @@ void ClientThink_real( gentity_t *ent ) {
 	// perform once-a-second actions
 	ClientTimerActions( ent, msec );
 
-	G_UpdateClientBroadcasts ( ent );
+	if ( ent->s.number < MAX_CLIENTS ) {
+		// done with everyone else's at the end of the frame
+		client->broadcastsPending = qtrue;
+	} else {
+		G_UpdateClientBroadcasts( ent );
+	}
 
 	//try some idle anims on ent if getting no input and not moving for some time
 	G_CheckClientIdle( ent, ucmd );
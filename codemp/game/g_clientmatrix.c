@@ -0,0 +1,181 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// g_clientmatrix.c
+// Distances and view directions between every pair of connected clients,
+// worked out once a frame instead of by each caller
+//
+
+#include "g_local.h"
+
+/*
+  Everything is kept by slot rather than client number so the kernel runs
+  over packed arrays with no holes or branches. Rows are the viewer and
+  columns the target, and the two dot products are the cosines of the yaw
+  and pitch between the viewer's angles and the direction to the target,
+  which is exactly what InFieldOfVision compares against fov / 2.
+*/
+
+typedef struct clientMatrix_s {
+	int		numClients;
+	int		clients[MAX_CLIENTS];		// client number in each slot
+	int		slots[MAX_CLIENTS];			// slot of each client number, -1 when not in the matrix
+
+	float	x[MAX_CLIENTS], y[MAX_CLIENTS], z[MAX_CLIENTS];
+	float	cosYaw[MAX_CLIENTS], sinYaw[MAX_CLIENTS];
+	float	cosPitch[MAX_CLIENTS], sinPitch[MAX_CLIENTS];
+
+	float	distSq[MAX_CLIENTS][MAX_CLIENTS];
+	float	yawDot[MAX_CLIENTS][MAX_CLIENTS];
+	float	pitchDot[MAX_CLIENTS][MAX_CLIENTS];
+
+	// profiling
+	int		framePairs, frameQueries;
+	int		lastPairs, lastQueries;
+	int		totalFrames;
+	double	totalPairs, totalQueries;
+} clientMatrix_t;
+
+static clientMatrix_t cm;
+
+static void G_ClientMatrixRow( int v ) {
+	const int n = cm.numClients;
+	const float vx = cm.x[v], vy = cm.y[v], vz = cm.z[v];
+	const float cy = cm.cosYaw[v], sy = cm.sinYaw[v];
+	const float cp = cm.cosPitch[v], sp = cm.sinPitch[v];
+	float *distRow = cm.distSq[v];
+	float *yawRow = cm.yawDot[v];
+	float *pitchRow = cm.pitchDot[v];
+	int t;
+
+	for ( t = 0; t < n; t++ ) {
+		const float dx = cm.x[t] - vx;
+		const float dy = cm.y[t] - vy;
+		const float dz = cm.z[t] - vz;
+		const float flatSq = dx*dx + dy*dy;
+		const float flat = sqrtf( flatSq );
+		const float len = sqrtf( flatSq + dz*dz );
+
+		// straight up or down counts as yaw 0 and a zero length as
+		// straight down, the same as vectoangles
+		distRow[t] = flatSq + dz*dz;
+		yawRow[t] = flat > 0.0f ? ( dx*cy + dy*sy ) / flat : cy;
+		pitchRow[t] = len > 0.0f ? ( flat*cp - dz*sp ) / len : sp;
+	}
+}
+
+/*
+================
+G_UpdateClientMatrix
+
+Called once a frame, after all the clients have moved
+================
+*/
+void G_UpdateClientMatrix( void ) {
+	int i, n;
+	gentity_t *ent;
+
+	cm.lastPairs = cm.framePairs;
+	cm.lastQueries = cm.frameQueries;
+	cm.totalPairs += cm.framePairs;
+	cm.totalQueries += cm.frameQueries;
+	cm.framePairs = cm.frameQueries = 0;
+	cm.totalFrames++;
+
+	n = 0;
+	for ( i = 0, ent = g_entities; i < MAX_CLIENTS; i++, ent++ ) {
+		float yaw, pitch;
+
+		cm.slots[i] = -1;
+		if ( !ent->inuse || !ent->client || ent->client->pers.connected != CON_CONNECTED ) {
+			continue;
+		}
+
+		yaw = DEG2RAD( ent->client->ps.viewangles[YAW] );
+		pitch = DEG2RAD( ent->client->ps.viewangles[PITCH] );
+
+		cm.slots[i] = n;
+		cm.clients[n] = i;
+		cm.x[n] = ent->client->ps.origin[0];
+		cm.y[n] = ent->client->ps.origin[1];
+		cm.z[n] = ent->client->ps.origin[2];
+		cm.cosYaw[n] = cosf( yaw );
+		cm.sinYaw[n] = sinf( yaw );
+		cm.cosPitch[n] = cosf( pitch );
+		cm.sinPitch[n] = sinf( pitch );
+		n++;
+	}
+	cm.numClients = n;
+
+	for ( i = 0; i < n; i++ ) {
+		G_ClientMatrixRow( i );
+	}
+	cm.framePairs = n * n;
+}
+
+/*
+================
+G_ClientInMatrix
+
+True if the client was connected when the matrix was last updated
+================
+*/
+qboolean G_ClientInMatrix( int clientNum ) {
+	return ( clientNum >= 0 && clientNum < MAX_CLIENTS && cm.slots[clientNum] != -1 ) ? qtrue : qfalse;
+}
+
+/*
+================
+G_ClientDistanceSquared
+
+Both clients must be in the matrix
+================
+*/
+float G_ClientDistanceSquared( int viewer, int target ) {
+	cm.frameQueries++;
+	return cm.distSq[cm.slots[viewer]][cm.slots[target]];
+}
+
+/*
+================
+G_ClientInFieldOfVision
+
+Same as InFieldOfVision with the viewer's angles and the direction from the
+viewer's origin to the target's. Both clients must be in the matrix
+================
+*/
+qboolean G_ClientInFieldOfVision( int viewer, int target, float fov ) {
+	const float minDot = cosf( DEG2RAD( fov * 0.5f ) );
+	const int v = cm.slots[viewer], t = cm.slots[target];
+
+	cm.frameQueries++;
+	return ( cm.yawDot[v][t] >= minDot && cm.pitchDot[v][t] >= minDot ) ? qtrue : qfalse;
+}
+
+void Svcmd_ClientMatrix_f( void ) {
+	trap->Print( "%i clients, %i pairs worked out and %i lookups made last frame\n", cm.numClients, cm.lastPairs, cm.lastQueries );
+	if ( cm.totalFrames ) {
+		trap->Print( "%.0f pairs and %.0f lookups over %i frames, %.1f lookups a frame\n",
+			cm.totalPairs, cm.totalQueries, cm.totalFrames, cm.totalQueries / cm.totalFrames );
+	}
+}
@@ -569,6 +569,8 @@ typedef struct renderInfo_s
 
 	//for tracking legitimate bolt indecies
 	void		*lastG2; //if it doesn't match ent->ghoul2, the bolts are considered invalid.
+	void		*g2BonesFor; //same for g2Bones, see G_G2Bones
+	int			g2Bones[G2BONE_NUM];
 	int			headBolt;
 	int			handRBolt;
 	int			handLBolt;
@@ -791,6 +793,9 @@ struct gclient_s {
 	int			lastGenCmd;
 	int			lastGenCmdTime;
 
+	// broadcastClients needs working out at the end of the frame
+	qboolean	broadcastsPending;
+
 	struct force {
 		int		regenDebounce;
 		int		drainDebounce;
@@ -1073,6 +1078,7 @@ void SaveRegisteredItems( void );
 //
 // g_utils.c
 //
+void	G_ClearConfigstringIndexes( void );
 int		G_ModelIndex( const char *name );
 int		G_SoundIndex( const char *name );
 int		G_SoundSetIndex(const char *name);
@@ -1137,6 +1143,7 @@ char	*vtos( const vec3_t v );
 void G_AddPredictableEvent( gentity_t *ent, int event, int eventParm );
 void G_AddEvent( gentity_t *ent, int event, int eventParm );
 void G_SetOrigin( gentity_t *ent, vec3_t origin );
+const int *G_G2Bones( gentity_t *ent );
 qboolean G_CheckInSolid (gentity_t *self, qboolean fix);
 void AddRemap(const char *oldShader, const char *newShader, float timeOffset);
 const char *BuildShaderStateConfig(void);
@@ -1356,6 +1363,7 @@ void G_CheckClientTimeouts	( gentity_t *ent );
 void ClientThink			( int clientNum, usercmd_t *ucmd );
 void ClientEndFrame			( gentity_t *ent );
 void G_RunClient			( gentity_t *ent );
+void G_UpdateClientBroadcasts	( gentity_t *self );
 
 //
 // g_team.c
@@ -1363,6 +1371,15 @@ void G_RunClient			( gentity_t *ent );
 qboolean OnSameTeam( gentity_t *ent1, gentity_t *ent2 );
 void Team_CheckDroppedItem( gentity_t *dropped );
 
+//
+// g_clientmatrix.c
+//
+void G_UpdateClientMatrix( void );
+qboolean G_ClientInMatrix( int clientNum );
+float G_ClientDistanceSquared( int viewer, int target );
+qboolean G_ClientInFieldOfVision( int viewer, int target, float fov );
+void Svcmd_ClientMatrix_f( void );
+
 //
 // g_mem.c
 //
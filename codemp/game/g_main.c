@@ -179,6 +179,9 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	trap->Cvar_Set("RMG", "0");
 	RMG.integer = 0;
 
+	//The server has a fresh set of configstrings, so drop the indexes of the last ones
+	G_ClearConfigstringIndexes();
+
 	//Clean up any client-server ghoul2 instance attachments that may still exist exe-side
 	trap->G2API_CleanEntAttachments();
 
@@ -189,7 +192,9 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	trap->SV_RegisterSharedMemory( gSharedBuffer.raw );
 
 	//Load external vehicle data
+	trap->LoadScopeEnter( "BG_VehicleLoadParms" );
 	BG_VehicleLoadParms();
+	trap->LoadScopeLeave();
 
 	trap->Print ("------- Game Initialization -------\n");
 	trap->Print ("gamename: %s\n", GAMEVERSION);
@@ -221,8 +226,10 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	if ( g_log.string[0] )
 	{
 		trap->FS_Open( g_log.string, &level.logFile, g_logSync.integer ? FS_APPEND_SYNC : FS_APPEND );
-		if ( level.logFile )
+		if ( level.logFile ) {
+			trap->LogBind( LOGCHAN_GAME, level.logFile );
 			trap->Print( "Logging to %s\n", g_log.string );
+		}
 		else
 			trap->Print( "WARNING: Couldn't open logfile: %s\n", g_log.string );
 	}
@@ -240,8 +247,10 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 		else if ( g_securityLog.integer == 2 )
 			trap->FS_Open( SECURITY_LOG, &level.security.log, FS_APPEND_SYNC );
 
-		if ( level.security.log )
+		if ( level.security.log ) {
+			trap->LogBind( LOGCHAN_SECURITY, level.security.log );
 			trap->Print( "Logging to "SECURITY_LOG"\n" );
+		}
 		else
 			trap->Print( "WARNING: Couldn't open logfile: "SECURITY_LOG"\n" );
 	}
@@ -283,9 +292,13 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 		&level.clients[0].ps, sizeof( level.clients[0] ) );
 
 	//Load sabers.cfg data
+	trap->LoadScopeEnter( "WP_SaberLoadParms" );
 	WP_SaberLoadParms();
+	trap->LoadScopeLeave();
 
+	trap->LoadScopeEnter( "NPC_InitGame" );
 	NPC_InitGame();
+	trap->LoadScopeLeave();
 
 	TIMER_Clear();
 	//
@@ -306,16 +319,22 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	ClearRegisteredItems();
 
 	//make sure saber data is loaded before this! (so we can precache the appropriate hilts)
+	trap->LoadScopeEnter( "InitSiegeMode" );
 	InitSiegeMode();
+	trap->LoadScopeLeave();
 
 	trap->Cvar_Register( &mapname, "mapname", "", CVAR_SERVERINFO | CVAR_ROM );
 	G_CacheMapname( &mapname );
 	trap->Cvar_Register( &ckSum, "sv_mapChecksum", "", CVAR_ROM );
 
+	trap->LoadScopeEnter( "Nav_Load" );
 	navCalculatePaths	= ( trap->Nav_Load( mapname.string, ckSum.integer ) == qfalse );
+	trap->LoadScopeLeave();
 
 	// parse the key/value pairs and spawn gentities
+	trap->LoadScopeEnter( "G_SpawnEntitiesFromString" );
 	G_SpawnEntitiesFromString(qfalse);
+	trap->LoadScopeLeave();
 
 	// general initialization
 	G_FindTeams();
@@ -351,6 +370,7 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 		G_SoundIndex( "sound/player/gurp2.wav" );
 	}
 
+	trap->LoadScopeEnter( "bot setup" );
 	if ( trap->Cvar_VariableIntegerValue( "bot_enable" ) ) {
 		BotAISetup( restart );
 		BotAILoadMap( restart );
@@ -358,6 +378,7 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	} else {
 		G_LoadArenas();
 	}
+	trap->LoadScopeLeave();
 
 	if ( level.gametype == GT_DUEL || level.gametype == GT_POWERDUEL )
 	{
@@ -1519,7 +1540,9 @@ void QDECL G_LogPrintf( const char *fmt, ... ) {
 	if ( !level.logFile )
 		return;
 
-	trap->FS_Write( string, strlen( string ), level.logFile );
+	// written by the engine's log thread, straight to the file if it can't take it
+	if ( !trap->LogPrint( LOGCHAN_GAME, LOGLEVEL_INFO, string ) )
+		trap->FS_Write( string, strlen( string ), level.logFile );
 }
 /*
 =================
@@ -1549,7 +1572,8 @@ void QDECL G_SecurityLogPrintf( const char *fmt, ... ) {
 	if ( !level.security.log )
 		return;
 
-	trap->FS_Write( string, strlen( string ), level.security.log );
+	if ( !trap->LogPrint( LOGCHAN_SECURITY, LOGLEVEL_WARNING, string ) )
+		trap->FS_Write( string, strlen( string ), level.security.log );
 }
 
 /*
@@ -3368,6 +3392,18 @@ void G_RunFrame( int levelTime ) {
 			ClientEndFrame( ent );
 		}
 	}
+
+	// everyone has moved, so work out who can see who once for all of them
+	G_UpdateClientMatrix();
+	ent = &g_entities[0];
+	for (i=0 ; i < level.maxclients ; i++, ent++ ) {
+		if ( ent->inuse && ent->client->broadcastsPending ) {
+			ent->client->broadcastsPending = qfalse;
+			if ( G_ClientInMatrix( i ) ) {
+				G_UpdateClientBroadcasts( ent );
+			}
+		}
+	}
 #ifdef _G_FRAME_PERFANAL
 	iTimer_ClientEndframe = trap->PrecisionTimer_End(timer_ClientEndframe);
 #endif
@@ -769,7 +769,19 @@ typedef enum gameImportLegacy_e {
 	G_KD_FREE,
 	G_KD_INSERTF,
 	G_KD_NEARESTF,
-	G_KD_RESFREE
+	G_KD_RESFREE,
+	G_FIND_CONFIGSTRING,
+	G_TIMESHIFT_TRACE,
+	G_LOG_BIND,
+	G_LOG_PRINT,
+	G_PD_STORE_BLOB,
+	G_PD_LOAD_BLOB,
+	G_PD_FILE_CHECKSUM,
+	G_LOAD_SCOPE_ENTER,
+	G_LOAD_SCOPE_LEAVE,
+	G_G2_GETBONENUM,
+	G_G2_ANGLEOVERRIDE_NUM,
+	G_G2_PLAYANIM_NUM
 	
 } gameImportLegacy_t;
 
@@ -1157,6 +1169,30 @@ typedef struct gameImport_s {
 	void		(*G2API_CleanEntAttachments)			( void );
 	qboolean	(*G2API_OverrideServer)					( void *serverInstance );
 	void		(*G2API_GetSurfaceName)					( void *ghoul2, int surfNumber, int modelIndex, char *fillBuf );
+
+	// configstrings
+	int			(*FindConfigstring)						( const char *name, int start, int max );
+
+	// lag compensation
+	void		(*TimeShiftTrace)						( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int traceFlags, int useLod, int time );
+
+	// background log writer
+	void		(*LogBind)								( int channel, fileHandle_t f );
+	qboolean	(*LogPrint)								( int channel, int level, const char *text );
+
+	// data kept by the engine across game module reloads
+	qboolean	(*PD_StoreBlob)							( const char *key, int version, int sourceChecksum, const void *data, int size );
+	int			(*PD_LoadBlob)							( const char *key, int version, int sourceChecksum, void *buffer, int bufferSize );
+	int			(*PD_FileChecksum)						( const char *path );
+
+	// level load profiling, nested under the engine's scope around the call into the module
+	void		(*LoadScopeEnter)						( const char *name );
+	void		(*LoadScopeLeave)						( void );
+
+	// bone setters by skeleton bone number, resolved once with G2API_GetBoneNum
+	int			(*G2API_GetBoneNum)						( void *ghoul2, int modelIndex, const char *boneName );
+	qboolean	(*G2API_SetBoneAnglesNum)				( void *ghoul2, int modelIndex, int boneNum, const vec3_t angles, const int flags, const int up, const int right, const int forward, qhandle_t *modelList, int blendTime , int currentTime );
+	qboolean	(*G2API_SetBoneAnimNum)					( void *ghoul2, const int modelIndex, int boneNum, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime );
 } gameImport_t;
 
 typedef struct gameExport_s {
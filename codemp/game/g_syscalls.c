@@ -112,6 +112,42 @@ void trap_SetConfigstring( int num, const char *string ) {
 void trap_GetConfigstring( int num, char *buffer, int bufferSize ) {
 	Q_syscall( G_GET_CONFIGSTRING, num, buffer, bufferSize );
 }
+int trap_FindConfigstring( const char *name, int start, int max ) {
+	return Q_syscall( G_FIND_CONFIGSTRING, name, start, max );
+}
+void trap_TimeShiftTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int traceFlags, int useLod, int time ) {
+	Q_syscall( G_TIMESHIFT_TRACE, results, start, mins, maxs, end, passEntityNum, contentmask, capsule, traceFlags, useLod, time );
+}
+void trap_LogBind( int channel, fileHandle_t f ) {
+	Q_syscall( G_LOG_BIND, channel, f );
+}
+qboolean trap_LogPrint( int channel, int level, const char *text ) {
+	return (qboolean)(Q_syscall( G_LOG_PRINT, channel, level, text ));
+}
+qboolean trap_PD_StoreBlob( const char *key, int version, int sourceChecksum, const void *data, int size ) {
+	return (qboolean)(Q_syscall( G_PD_STORE_BLOB, key, version, sourceChecksum, data, size ));
+}
+int trap_PD_LoadBlob( const char *key, int version, int sourceChecksum, void *buffer, int bufferSize ) {
+	return Q_syscall( G_PD_LOAD_BLOB, key, version, sourceChecksum, buffer, bufferSize );
+}
+int trap_PD_FileChecksum( const char *path ) {
+	return Q_syscall( G_PD_FILE_CHECKSUM, path );
+}
+void trap_LoadScopeEnter( const char *name ) {
+	Q_syscall( G_LOAD_SCOPE_ENTER, name );
+}
+void trap_LoadScopeLeave( void ) {
+	Q_syscall( G_LOAD_SCOPE_LEAVE );
+}
+int trap_G2API_GetBoneNum( void *ghoul2, int modelIndex, const char *boneName ) {
+	return Q_syscall( G_G2_GETBONENUM, ghoul2, modelIndex, boneName );
+}
+qboolean trap_G2API_SetBoneAnglesNum( void *ghoul2, int modelIndex, int boneNum, const vec3_t angles, const int flags, const int up, const int right, const int forward, qhandle_t *modelList, int blendTime, int currentTime ) {
+	return (qboolean)(Q_syscall( G_G2_ANGLEOVERRIDE_NUM, ghoul2, modelIndex, boneNum, angles, flags, up, right, forward, modelList, blendTime, currentTime ));
+}
+qboolean trap_G2API_SetBoneAnimNum( void *ghoul2, const int modelIndex, int boneNum, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime ) {
+	return (qboolean)(Q_syscall( G_G2_PLAYANIM_NUM, ghoul2, modelIndex, boneNum, startFrame, endFrame, flags, PASSFLOAT(animSpeed), currentTime, PASSFLOAT(setFrame), blendTime ));
+}
 void trap_GetUserinfo( int num, char *buffer, int bufferSize ) {
 	Q_syscall( G_GET_USERINFO, num, buffer, bufferSize );
 }
@@ -1354,4 +1390,17 @@ static void TranslateSyscalls( void ) {
 	trap->G2API_CleanEntAttachments			= trap_G2API_CleanEntAttachments;
 	trap->G2API_OverrideServer				= trap_G2API_OverrideServer;
 	trap->G2API_GetSurfaceName				= trap_G2API_GetSurfaceName;
+
+	trap->FindConfigstring					= trap_FindConfigstring;
+	trap->TimeShiftTrace					= trap_TimeShiftTrace;
+	trap->LogBind							= trap_LogBind;
+	trap->LogPrint							= trap_LogPrint;
+	trap->PD_StoreBlob						= trap_PD_StoreBlob;
+	trap->PD_LoadBlob						= trap_PD_LoadBlob;
+	trap->PD_FileChecksum					= trap_PD_FileChecksum;
+	trap->LoadScopeEnter					= trap_LoadScopeEnter;
+	trap->LoadScopeLeave					= trap_LoadScopeLeave;
+	trap->G2API_GetBoneNum					= trap_G2API_GetBoneNum;
+	trap->G2API_SetBoneAnglesNum			= trap_G2API_SetBoneAnglesNum;
+	trap->G2API_SetBoneAnimNum				= trap_G2API_SetBoneAnimNum;
 }
@@ -78,26 +78,139 @@ model / sound configstring indexes
 =========================================================================
 */
 
+// Every range G_FindConfigstringIndex manages is read from the server once, the first time
+// it's used on a map, and all its names are hashed here. Looking up something that is
+// already registered then never needs a syscall.
+
+#define CSINDEX_HASH_SIZE	4096	// power of 2, comfortably more than all the ranges put together
+#define CSINDEX_MAX_RANGES	8
+
+typedef struct csIndex_s {
+	const char	*name;
+	int			start;
+	int			index;
+} csIndex_t;
+
+typedef struct csIndexRange_s {
+	int			start;
+	int			next;		// first free slot
+	qboolean	uncached;	// ran out of name space, names not in the hash have to be asked for
+} csIndexRange_t;
+
+static csIndex_t		csIndexHash[CSINDEX_HASH_SIZE];
+static csIndexRange_t	csIndexRanges[CSINDEX_MAX_RANGES];
+static int				csIndexNumRanges;
+static char				csIndexNames[MAX_GAMESTATE_CHARS];
+static int				csIndexNamesUsed;
+
 /*
 ================
-G_FindConfigstringIndex
+G_ClearConfigstringIndexes
 
+The server clears the configstrings on a map change, so forget everything
 ================
 */
-static int G_FindConfigstringIndex( const char *name, int start, int max, qboolean create ) {
-	int		i;
-	char	s[MAX_STRING_CHARS];
+void G_ClearConfigstringIndexes( void ) {
+	memset( csIndexHash, 0, sizeof( csIndexHash ) );
+	csIndexNumRanges = 0;
+	csIndexNamesUsed = 0;
+}
 
-	if ( !VALIDSTRING( name ) ) {
-		return 0;
+static csIndex_t *G_ConfigstringIndexSlot( const char *name, int start ) {
+	unsigned int	hash = 2166136261u ^ (unsigned int)start;
+	const char		*s;
+
+	for ( s = name; *s; s++ ) {
+		hash = ( hash ^ (byte)*s ) * 16777619u;
 	}
+	hash &= CSINDEX_HASH_SIZE - 1;
 
+	while ( csIndexHash[hash].name && ( csIndexHash[hash].start != start || strcmp( csIndexHash[hash].name, name ) ) ) {
+		hash = ( hash + 1 ) & ( CSINDEX_HASH_SIZE - 1 );
+	}
+
+	return &csIndexHash[hash];
+}
+
+static void G_AddConfigstringIndex( csIndexRange_t *range, const char *name, int index ) {
+	csIndex_t	*slot;
+	int			len = strlen( name ) + 1;
+
+	if ( csIndexNamesUsed + len > (int)sizeof( csIndexNames ) ) {
+		range->uncached = qtrue;
+		return;
+	}
+
+	slot = G_ConfigstringIndexSlot( name, range->start );
+	if ( slot->name ) {
+		// registered twice, the first one wins like it always did
+		return;
+	}
+
+	memcpy( csIndexNames + csIndexNamesUsed, name, len );
+	slot->name = csIndexNames + csIndexNamesUsed;
+	slot->start = range->start;
+	slot->index = index;
+	csIndexNamesUsed += len;
+}
+
+static csIndexRange_t *G_ConfigstringIndexRange( int start, int max ) {
+	csIndexRange_t	*range;
+	char			s[MAX_STRING_CHARS];
+	int				i;
+
+	for ( i = 0; i < csIndexNumRanges; i++ ) {
+		if ( csIndexRanges[i].start == start ) {
+			return &csIndexRanges[i];
+		}
+	}
+
+	if ( csIndexNumRanges == CSINDEX_MAX_RANGES ) {
+		trap->Error( ERR_DROP, "G_ConfigstringIndexRange: too many ranges" );
+	}
+
+	range = &csIndexRanges[csIndexNumRanges++];
+	range->start = start;
+	range->uncached = qfalse;
+
+	// pick up whatever is registered already, configstrings survive a map_restart
 	for ( i=1 ; i<max ; i++ ) {
 		trap->GetConfigstring( start + i, s, sizeof( s ) );
 		if ( !s[0] ) {
 			break;
 		}
-		if ( !strcmp( s, name ) ) {
+		G_AddConfigstringIndex( range, s, i );
+	}
+	range->next = i;
+
+	return range;
+}
+
+/*
+================
+G_FindConfigstringIndex
+
+================
+*/
+static int G_FindConfigstringIndex( const char *name, int start, int max, qboolean create ) {
+	csIndexRange_t	*range;
+	csIndex_t		*slot;
+	int				i;
+
+	if ( !VALIDSTRING( name ) ) {
+		return 0;
+	}
+
+	range = G_ConfigstringIndexRange( start, max );
+
+	slot = G_ConfigstringIndexSlot( name, start );
+	if ( slot->name ) {
+		return slot->index;
+	}
+
+	if ( range->uncached ) {
+		i = trap->FindConfigstring( name, start, max );
+		if ( i ) {
 			return i;
 		}
 	}
@@ -106,11 +219,13 @@ static int G_FindConfigstringIndex( const char *name, int start, int max, qboole
 		return 0;
 	}
 
-	if ( i == max ) {
+	if ( range->next == max ) {
 		trap->Error( ERR_DROP, "G_FindConfigstringIndex: overflow" );
 	}
 
+	i = range->next++;
 	trap->SetConfigstring( start + i, name );
+	G_AddConfigstringIndex( range, name, i );
 
 	return i;
 }
@@ -1938,6 +2053,25 @@ void G_SetOrigin( gentity_t *ent, vec3_t origin ) {
 	VectorCopy( origin, ent->r.currentOrigin );
 }
 
+/*
+================
+G_G2Bones
+
+Skeleton bone numbers for the bones BG_G2PlayerAngles and friends set every
+frame, looked up again only when the client's ghoul2 instance changes
+================
+*/
+const int *G_G2Bones( gentity_t *ent ) {
+	renderInfo_t *ri = &ent->client->renderInfo;
+
+	if ( ri->g2BonesFor != ent->ghoul2 ) {
+		BG_G2ResolveBones( ent->ghoul2, ri->g2Bones );
+		ri->g2BonesFor = ent->ghoul2;
+	}
+
+	return ri->g2Bones;
+}
+
 qboolean G_CheckInSolid (gentity_t *self, qboolean fix)
 {
 	trace_t	trace;
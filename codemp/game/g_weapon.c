@@ -542,6 +542,25 @@ static void WP_FireBlaster( gentity_t *ent, qboolean altFire )
 
 int G_GetHitLocation(gentity_t *target, vec3_t ppoint);
 
+/*
+================
+G_ShotTrace
+
+A hitscan shot from a player. With g_unlagged the other players are where
+they were on the shooter's screen when they fired
+================
+*/
+static void G_ShotTrace( gentity_t *ent, trace_t *tr, const vec3_t start, const vec3_t end, int passEntityNum, int traceFlags, int useLod )
+{
+	if ( g_unlagged.integer && ent->s.number < MAX_CLIENTS && !(ent->r.svFlags & SVF_BOT) )
+	{
+		trap->TimeShiftTrace( tr, start, NULL, NULL, end, passEntityNum, MASK_SHOT, qfalse, traceFlags, useLod, ent->client->pers.cmd.serverTime );
+		return;
+	}
+
+	trap->Trace( tr, start, NULL, NULL, end, passEntityNum, MASK_SHOT, qfalse, traceFlags, useLod );
+}
+
 /*
 ======================================================================
 
@@ -579,11 +598,11 @@ static void WP_DisruptorMainFire( gentity_t *ent )
 	{//need to loop this in case we hit a Jedi who dodges the shot
 		if (d_projectileGhoul2Collision.integer)
 		{
-			trap->Trace( &tr, start, NULL, NULL, end, ignore, MASK_SHOT, qfalse, G2TRFLAG_DOGHOULTRACE|G2TRFLAG_GETSURFINDEX|G2TRFLAG_THICK|G2TRFLAG_HITCORPSES, g_g2TraceLod.integer );
+			G_ShotTrace( ent, &tr, start, end, ignore, G2TRFLAG_DOGHOULTRACE|G2TRFLAG_GETSURFINDEX|G2TRFLAG_THICK|G2TRFLAG_HITCORPSES, g_g2TraceLod.integer );
 		}
 		else
 		{
-			trap->Trace( &tr, start, NULL, NULL, end, ignore, MASK_SHOT, qfalse, 0, 0 );
+			G_ShotTrace( ent, &tr, start, end, ignore, 0, 0 );
 		}
 
 		traceEnt = &g_entities[tr.entityNum];
@@ -780,11 +799,11 @@ void WP_DisruptorAltFire( gentity_t *ent )
 
 		if (d_projectileGhoul2Collision.integer)
 		{
-			trap->Trace( &tr, start, NULL, NULL, end, skip, MASK_SHOT, qfalse, G2TRFLAG_DOGHOULTRACE|G2TRFLAG_GETSURFINDEX|G2TRFLAG_THICK|G2TRFLAG_HITCORPSES, g_g2TraceLod.integer );
+			G_ShotTrace( ent, &tr, start, end, skip, G2TRFLAG_DOGHOULTRACE|G2TRFLAG_GETSURFINDEX|G2TRFLAG_THICK|G2TRFLAG_HITCORPSES, g_g2TraceLod.integer );
 		}
 		else
 		{
-			trap->Trace( &tr, start, NULL, NULL, end, skip, MASK_SHOT, qfalse, 0, 0 );
+			G_ShotTrace( ent, &tr, start, end, skip, 0, 0 );
 		}
 
 		if ( tr.entityNum == ent->s.number )
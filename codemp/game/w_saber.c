@@ -947,7 +947,7 @@ static QINLINE void G_G2PlayerAngles( gentity_t *ent, matrix3_t legs, vec3_t leg
 			emplaced = &g_entities[ent->client->ps.emplacedIndex].s;
 		}
 
-		BG_G2PlayerAngles(ent->ghoul2, ent->client->renderInfo.motionBolt, &ent->s, level.time, lerpOrg, lerpAng, legs,
+		BG_G2PlayerAngles(ent->ghoul2, G_G2Bones(ent), ent->client->renderInfo.motionBolt, &ent->s, level.time, lerpOrg, lerpAng, legs,
 			legsAngles, &tYawing, &tPitching, &lYawing, &tYawAngle, &tPitchAngle, &lYawAngle, FRAMETIME, turAngles,
 			ent->modelScale, ciLegs, ciTorso, &ent->client->corrTime, lookAngles, ent->client->lastHeadAngles,
 			ent->client->lookTime, emplaced, NULL);
@@ -983,7 +983,7 @@ static QINLINE void G_G2PlayerAngles( gentity_t *ent, matrix3_t legs, vec3_t leg
 				boltOrg[1] = boltMatrix.matrix[1][3];
 				boltOrg[2] = boltMatrix.matrix[2][3];
 
-				BG_IK_MoveArm(ent->ghoul2, lHandBolt, level.time, &ent->s, ent->client->ps.torsoAnim/*BOTH_DEAD1*/, boltOrg, &ent->client->ikStatus,
+				BG_IK_MoveArm(ent->ghoul2, G_G2Bones(ent), lHandBolt, level.time, &ent->s, ent->client->ps.torsoAnim/*BOTH_DEAD1*/, boltOrg, &ent->client->ikStatus,
 					ent->client->ps.origin, ent->client->ps.viewangles, ent->modelScale, 500, qfalse);
 			}
 		}
@@ -1002,7 +1002,7 @@ static QINLINE void G_G2PlayerAngles( gentity_t *ent, matrix3_t legs, vec3_t leg
 
 			if (lHandBolt)
 			{
-				BG_IK_MoveArm(ent->ghoul2, lHandBolt, level.time, &ent->s,
+				BG_IK_MoveArm(ent->ghoul2, G_G2Bones(ent), lHandBolt, level.time, &ent->s,
 					ent->client->ps.torsoAnim/*BOTH_DEAD1*/, vec3_origin, &ent->client->ikStatus, ent->client->ps.origin, ent->client->ps.viewangles, ent->modelScale, 500, qtrue);
 			}
 		}
@@ -1018,7 +1018,7 @@ static QINLINE void G_G2PlayerAngles( gentity_t *ent, matrix3_t legs, vec3_t leg
 		VectorCopy(ent->client->ps.viewangles, lookAngles);
 		lookAngles[YAW] = lookAngles[ROLL] = 0;
 
-		BG_G2ATSTAngles( ent->ghoul2, level.time, lookAngles );
+		BG_G2ATSTAngles( ent->ghoul2, G_G2Bones(ent), level.time, lookAngles );
 	}
 	else if (ent->NPC)
 	{ //an NPC not using a humanoid skeleton, do special angle stuff.
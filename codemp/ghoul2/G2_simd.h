@@ -0,0 +1,147 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#pragma once
+
+// G2_simd.h -- bone concatenation and vertex skinning kernels. The scalar
+// versions are always built so r_g2SimdCheck and the g2simdbench tool can
+// compare the SSE2 versions against them.
+
+#include "qcommon/q_shared.h"
+#ifndef MDXABONEDEF
+#define MDXABONEDEF		// q_shared.h has the bone struct
+#endif
+#include "rd-common/mdx_format.h"
+
+#if idsse2
+#include <emmintrin.h>
+#endif
+
+// largest difference allowed between the two paths, relative to the size of the scalar result
+#define G2_SIMD_TOLERANCE	1e-4f
+
+// out = in2 * in, both 3x4 affine transforms. out must not alias either input.
+static inline void G2_Multiply3x4_Scalar( mdxaBone_t *out, const mdxaBone_t *in2, const mdxaBone_t *in )
+{
+	// first row of out
+	out->matrix[0][0] = (in2->matrix[0][0] * in->matrix[0][0]) + (in2->matrix[0][1] * in->matrix[1][0]) + (in2->matrix[0][2] * in->matrix[2][0]);
+	out->matrix[0][1] = (in2->matrix[0][0] * in->matrix[0][1]) + (in2->matrix[0][1] * in->matrix[1][1]) + (in2->matrix[0][2] * in->matrix[2][1]);
+	out->matrix[0][2] = (in2->matrix[0][0] * in->matrix[0][2]) + (in2->matrix[0][1] * in->matrix[1][2]) + (in2->matrix[0][2] * in->matrix[2][2]);
+	out->matrix[0][3] = (in2->matrix[0][0] * in->matrix[0][3]) + (in2->matrix[0][1] * in->matrix[1][3]) + (in2->matrix[0][2] * in->matrix[2][3]) + in2->matrix[0][3];
+	// second row of outf out
+	out->matrix[1][0] = (in2->matrix[1][0] * in->matrix[0][0]) + (in2->matrix[1][1] * in->matrix[1][0]) + (in2->matrix[1][2] * in->matrix[2][0]);
+	out->matrix[1][1] = (in2->matrix[1][0] * in->matrix[0][1]) + (in2->matrix[1][1] * in->matrix[1][1]) + (in2->matrix[1][2] * in->matrix[2][1]);
+	out->matrix[1][2] = (in2->matrix[1][0] * in->matrix[0][2]) + (in2->matrix[1][1] * in->matrix[1][2]) + (in2->matrix[1][2] * in->matrix[2][2]);
+	out->matrix[1][3] = (in2->matrix[1][0] * in->matrix[0][3]) + (in2->matrix[1][1] * in->matrix[1][3]) + (in2->matrix[1][2] * in->matrix[2][3]) + in2->matrix[1][3];
+	// third row of out  out
+	out->matrix[2][0] = (in2->matrix[2][0] * in->matrix[0][0]) + (in2->matrix[2][1] * in->matrix[1][0]) + (in2->matrix[2][2] * in->matrix[2][0]);
+	out->matrix[2][1] = (in2->matrix[2][0] * in->matrix[0][1]) + (in2->matrix[2][1] * in->matrix[1][1]) + (in2->matrix[2][2] * in->matrix[2][1]);
+	out->matrix[2][2] = (in2->matrix[2][0] * in->matrix[0][2]) + (in2->matrix[2][1] * in->matrix[1][2]) + (in2->matrix[2][2] * in->matrix[2][2]);
+	out->matrix[2][3] = (in2->matrix[2][0] * in->matrix[0][3]) + (in2->matrix[2][1] * in->matrix[1][3]) + (in2->matrix[2][2] * in->matrix[2][3]) + in2->matrix[2][3];
+}
+
+// skin one vertex by its weighted bones and scale it, writing out[0..2]
+static inline void G2_SkinVertex_Scalar( const mdxaBone_t *const *bones, const float *weights, int numWeights, const float *vert, const float *scale, float *out )
+{
+	vec3_t tempVert;
+
+	VectorClear( tempVert );
+
+	for ( int k = 0 ; k < numWeights ; k++ )
+	{
+		const mdxaBone_t &bone = *bones[k];
+
+		tempVert[0] += weights[k] * ( DotProduct( bone.matrix[0], vert ) + bone.matrix[0][3] );
+		tempVert[1] += weights[k] * ( DotProduct( bone.matrix[1], vert ) + bone.matrix[1][3] );
+		tempVert[2] += weights[k] * ( DotProduct( bone.matrix[2], vert ) + bone.matrix[2][3] );
+	}
+
+	out[0] = tempVert[0] * scale[0];
+	out[1] = tempVert[1] * scale[1];
+	out[2] = tempVert[2] * scale[2];
+}
+
+#if idsse2
+// as G2_Multiply3x4_Scalar, but out may alias either input
+static inline void G2_Multiply3x4_SSE2( mdxaBone_t *out, const mdxaBone_t *in2, const mdxaBone_t *in )
+{
+	// each row of out is a linear combination of the rows of in, plus the translation of in2
+	const __m128 inRow0 = _mm_loadu_ps(in->matrix[0]);
+	const __m128 inRow1 = _mm_loadu_ps(in->matrix[1]);
+	const __m128 inRow2 = _mm_loadu_ps(in->matrix[2]);
+	__m128 outRow[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		const float *r = in2->matrix[i];
+		outRow[i] = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[0]), inRow0), _mm_mul_ps(_mm_set1_ps(r[1]), inRow1)),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[2]), inRow2), _mm_set_ps(r[3], 0.0f, 0.0f, 0.0f)));
+	}
+
+	// only store once everything is read
+	_mm_storeu_ps(out->matrix[0], outRow[0]);
+	_mm_storeu_ps(out->matrix[1], outRow[1]);
+	_mm_storeu_ps(out->matrix[2], outRow[2]);
+}
+
+// as G2_SkinVertex_Scalar, but out[3] is clobbered
+static inline void G2_SkinVertex_SSE2( const mdxaBone_t *const *bones, const float *weights, int numWeights, const float *vert, const float *scale, float *out )
+{
+	// blend the bone matrices first, then do a single matrix * vertex
+	__m128 row0 = _mm_setzero_ps();
+	__m128 row1 = _mm_setzero_ps();
+	__m128 row2 = _mm_setzero_ps();
+	__m128 row3 = _mm_setzero_ps();
+
+	for ( int k = 0 ; k < numWeights ; k++ )
+	{
+		const __m128 fBoneWeight = _mm_set1_ps( weights[k] );
+
+		row0 = _mm_add_ps( row0, _mm_mul_ps( fBoneWeight, _mm_loadu_ps( bones[k]->matrix[0] ) ) );
+		row1 = _mm_add_ps( row1, _mm_mul_ps( fBoneWeight, _mm_loadu_ps( bones[k]->matrix[1] ) ) );
+		row2 = _mm_add_ps( row2, _mm_mul_ps( fBoneWeight, _mm_loadu_ps( bones[k]->matrix[2] ) ) );
+	}
+
+	// turn the rows into columns so the transform needs no horizontal adds
+	_MM_TRANSPOSE4_PS( row0, row1, row2, row3 );
+
+	__m128 pos = _mm_add_ps(
+		_mm_add_ps( _mm_mul_ps( row0, _mm_set1_ps( vert[0] ) ), _mm_mul_ps( row1, _mm_set1_ps( vert[1] ) ) ),
+		_mm_add_ps( _mm_mul_ps( row2, _mm_set1_ps( vert[2] ) ), row3 ) );
+	pos = _mm_mul_ps( pos, _mm_set_ps( 1.0f, scale[2], scale[1], scale[0] ) );
+
+	_mm_storeu_ps( out, pos );
+}
+#endif
+
+// largest difference between a and b, relative to the size of the reference values in a
+static inline float G2_SimdError( const float *a, const float *b, int count )
+{
+	float maxError = 0.0f, maxValue = 1.0f;
+
+	for ( int i = 0 ; i < count ; i++ )
+	{
+		maxError = Q_max( maxError, fabsf( a[i] - b[i] ) );
+		maxValue = Q_max( maxValue, fabsf( a[i] ) );
+	}
+
+	return maxError / maxValue;
+}
@@ -113,6 +113,7 @@ public:
 			{
 				Array()[i].mBoneCache=0;
 				Array()[i].mTransformedVertsArray=0;
+				Array()[i].mTransformedVertsGeneration=-1;
 				Array()[i].mSkelFrameNum=0;
 				Array()[i].mMeshFrameNum=0;
 			}
@@ -182,6 +183,24 @@ public:
 
 void Create_Matrix(const float *angle, mdxaBone_t *matrix);
 
+// vert space used by one surface transformed for collision: x y z s t per vert, then the bounds of the surface
+static inline int G2_TransformedSurfaceSize(const int numVerts)
+{
+	return (numVerts * 5 + 6) * sizeof(float);
+}
+
+// case insensitive hash of a skeleton bone name, see R_MDXABuildBoneHash
+static inline unsigned int G2_BoneNameHash(const char *boneName)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*boneName)
+	{
+		hash = (hash ^ (unsigned char)tolower((unsigned char)*boneName++)) * 16777619u;
+	}
+	return hash;
+}
+
 extern mdxaBone_t		worldMatrix;
 extern mdxaBone_t		worldMatrixInv;
 
@@ -199,8 +218,10 @@ int			G2_IsSurfaceRendered(CGhoul2Info *ghlInfo, const char *surfaceName, surfac
 
 // internal bone calls - G2_Bones.cpp
 qboolean	G2_Set_Bone_Angles(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName, const float *angles, const int flags, const Eorientations up, const Eorientations left, const Eorientations forward, qhandle_t *modelList, const int modelIndex, const int blendTime, const int currentTime);
+qboolean	G2_Set_Bone_Angles_Num(CGhoul2Info *ghlInfo, boneInfo_v &blist, const int boneNum, const float *angles, const int flags, const Eorientations up, const Eorientations left, const Eorientations forward, qhandle_t *modelList, const int modelIndex, const int blendTime, const int currentTime);
 qboolean	G2_Remove_Bone (CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName);
 qboolean	G2_Set_Bone_Anim(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime);
+qboolean	G2_Set_Bone_Anim_Num(CGhoul2Info *ghlInfo, boneInfo_v &blist, const int boneNum, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime);
 qboolean	G2_Get_Bone_Anim(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName, const int currentTime, float *currentFrame, int *startFrame, int *endFrame, int *flags, float *retAnimSpeed, qhandle_t *modelList, int modelIndex);
 qboolean	G2_Get_Bone_Anim_Range(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName, int *startFrame, int *endFrame);
 qboolean	G2_Pause_Bone_Anim(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName, const int currentTime );
@@ -212,6 +233,9 @@ void		G2_Animate_Bone_List(CGhoul2Info_v &ghoul2, const int currentTime, const i
 //rww - RAGDOLL_END
 void		G2_Init_Bone_List(boneInfo_v &blist, int numBones);
 int			G2_Find_Bone_In_List(boneInfo_v &blist, const int boneNum);
+int			G2_Add_Bone_Num(boneInfo_v &blist, const int boneNum);
+int			G2_Find_Skeleton_Bone(const struct model_s *mod_a, const char *boneName);
+void		G2_Bone_Lookup_Stats(int *lookups, int *probes, qboolean reset);
 void		G2_RemoveRedundantBoneOverrides(boneInfo_v &blist, int *activeBones);
 qboolean	G2_Set_Bone_Angles_Matrix(const char *fileName, boneInfo_v &blist, const char *boneName, const mdxaBone_t &matrix, const int flags, qhandle_t *modelList, const int modelIndex, const int blendTime, const int currentTime);
 int			G2_Get_Bone_Index(CGhoul2Info *ghoul2, const char *boneName);
@@ -237,6 +261,7 @@ void		G2_TransformModel(CGhoul2Info_v &ghoul2, const int frameNum, vec3_t scale,
 #else
 void		G2_TransformModel(CGhoul2Info_v &ghoul2, const int frameNum, vec3_t scale, IHeapAllocator *G2VertSpace, int useLod);
 #endif
+int			G2_TransformedVertsSize(CGhoul2Info_v &ghoul2);
 void		G2_GenerateWorldMatrix(const vec3_t angles, const vec3_t origin);
 void		TransformPoint (const vec3_t in, vec3_t out, mdxaBone_t *mat);
 void		Inverse_Matrix(mdxaBone_t *src, mdxaBone_t *dest);
@@ -277,6 +302,8 @@ qboolean	G2API_SetRootSurface(CGhoul2Info_v &ghoul2, const int modelIndex, const
 qboolean	G2API_RemoveSurface(CGhoul2Info *ghlInfo, const int index);
 int			G2API_AddSurface(CGhoul2Info *ghlInfo, int surfaceNumber, int polyNumber, float BarycentricI, float BarycentricJ, int lod );
 qboolean	G2API_SetBoneAnim(CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame = -1, const int blendTime = -1);
+qboolean	G2API_SetBoneAnimNum(CGhoul2Info_v &ghoul2, const int modelIndex, const int boneNum, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame = -1, const int blendTime = -1);
+int			G2API_GetBoneNum(CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName);
 qboolean	G2API_GetBoneAnim(CGhoul2Info_v& ghoul2, int modelIndex, const char *boneName, const int currentTime, float *currentFrame, int *startFrame, int *endFrame, int *flags, float *animSpeed, qhandle_t *modelList);
 qboolean	G2API_GetAnimRange(CGhoul2Info *ghlInfo, const char *boneName,	int *startFrame, int *endFrame);
 qboolean	G2API_PauseBoneAnim(CGhoul2Info *ghlInfo, const char *boneName, const int currentTime);
@@ -285,6 +312,7 @@ qboolean	G2API_StopBoneAnim(CGhoul2Info *ghlInfo, const char *boneName);
 
 
 qboolean G2API_SetBoneAngles(CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName, const vec3_t angles, const int flags, const Eorientations up, const Eorientations left, const Eorientations forward, qhandle_t *modelList, int blendTime, int currentTime );
+qboolean G2API_SetBoneAnglesNum(CGhoul2Info_v &ghoul2, const int modelIndex, const int boneNum, const vec3_t angles, const int flags, const Eorientations up, const Eorientations left, const Eorientations forward, qhandle_t *modelList, int blendTime, int currentTime );
 
 qboolean	G2API_StopBoneAngles(CGhoul2Info *ghlInfo, const char *boneName);
 qboolean	G2API_RemoveBone(CGhoul2Info_v& ghoul2, int modelIndex, const char *boneName);
@@ -365,6 +393,8 @@ extern qboolean gG2_GBMNoReconstruct;
 extern qboolean gG2_GBMUseSPMethod;
 // From tr_ghoul2.cpp
 void		G2_ConstructGhoulSkeleton( CGhoul2Info_v &ghoul2,const int frameNum,bool checkForNewOrigin,const vec3_t scale);
+void		G2_CheckSimd( const char *kernel, const float *scalar, const float *simd, int count );
+extern cvar_t	*r_g2SimdCheck;
 
 qboolean	G2API_SkinlessModel(CGhoul2Info_v& ghoul2, int modelIndex);
 
@@ -272,6 +272,7 @@ public:
 	int				mFlags;	// used for determining whether to do full collision detection against this object
 // to here
 	size_t			*mTransformedVertsArray;	// used to create an array of pointers to transformed verts per surface for collision detection
+	int				mTransformedVertsGeneration;	// vert space generation mTransformedVertsArray was allocated in
 	CBoneCache		*mBoneCache;
 	int				mSkin;
 
@@ -305,6 +306,7 @@ public:
 	mMeshFrameNum(-1),
 	mFlags(0),
 	mTransformedVertsArray(0),
+	mTransformedVertsGeneration(-1),
 	mBoneCache(0),
 	mSkin(0),
 	mValid(false),
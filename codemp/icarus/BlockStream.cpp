@@ -43,6 +43,7 @@ CBlockMember::CBlockMember( void )
 	m_id = -1;
 	m_size = -1;
 	m_data = NULL;
+	m_shared = false;
 }
 
 CBlockMember::~CBlockMember( void )
@@ -60,13 +61,29 @@ void CBlockMember::Free( void )
 {
 	if ( m_data != NULL )
 	{
-		ICARUS_Free ( m_data );
-		m_data = NULL;
+		ReleaseData();
 
 		m_id = m_size = -1;
 	}
 }
 
+/*
+-------------------------
+ReleaseData
+-------------------------
+*/
+
+void CBlockMember::ReleaseData( void )
+{
+	if ( m_data != NULL && !m_shared )
+	{
+		ICARUS_Free( m_data );
+	}
+
+	m_data = NULL;
+	m_shared = false;
+}
+
 /*
 -------------------------
 GetInfo
@@ -98,14 +115,23 @@ void CBlockMember::SetData( vector_t data )
 
 void CBlockMember::SetData( void *data, int size )
 {
-	if ( m_data )
-		ICARUS_Free( m_data );
+	ReleaseData();
 
 	m_data = ICARUS_Malloc( size );
 	memcpy( m_data, data, size );
 	m_size = size;
 }
 
+void CBlockMember::ShareData( int id, int size, void *data )
+{
+	ReleaseData();
+
+	m_id = id;
+	m_size = size;
+	m_data = data;
+	m_shared = true;
+}
+
 //	Member I/O functions
 
 /*
@@ -409,6 +435,9 @@ CBlockStream::CBlockStream( void )
 {
 	m_stream = NULL;
 	m_streamPos = 0;
+
+	m_program = NULL;
+	m_programBlock = 0;
 }
 
 CBlockStream::~CBlockStream( void )
@@ -509,6 +538,9 @@ int CBlockStream::Free( void )
 	m_stream = NULL;
 	m_streamPos = 0;
 
+	m_program = NULL;
+	m_programBlock = 0;
+
 	return true;
 }
 
@@ -552,6 +584,9 @@ int CBlockStream::Init( void )
 	m_stream = NULL;
 	m_streamPos = 0;
 
+	m_program = NULL;
+	m_programBlock = 0;
+
 	return true;
 }
 
@@ -593,6 +628,9 @@ BlockAvailable
 
 int CBlockStream::BlockAvailable( void )
 {
+	if ( m_program )
+		return ( m_programBlock < m_program->numBlocks );
+
 	if ( m_streamPos >= m_fileSize )
 		return false;
 
@@ -614,6 +652,25 @@ int CBlockStream::ReadBlock( CBlock *get )
 	if (!BlockAvailable())
 		return false;
 
+	// Compiled scripts hand out their own data, nothing to parse or copy
+	if ( m_program )
+	{
+		const ibcBlock_t	*block = (ibcBlock_t *) ((byte *) m_program + m_program->ofsBlocks) + m_programBlock++;
+		const ibcMember_t	*member = (ibcMember_t *) ((byte *) m_program + m_program->ofsMembers) + block->firstMember;
+
+		get->Create( block->id );
+		get->SetFlags( block->flags );
+
+		for ( int i = 0; i < block->numMembers; i++, member++ )
+		{
+			bMember = new CBlockMember;
+			bMember->ShareData( member->id, member->size, (byte *) m_program + m_program->ofsData + member->ofsData );
+			get->AddMember( bMember );
+		}
+
+		return true;
+	}
+
 	b_id		= LittleLong(GetInteger());
 	numMembers	= LittleLong(GetInteger());
 	flags		= (unsigned char) GetChar();
@@ -649,6 +706,12 @@ int CBlockStream::Open( char *buffer, long size )
 
 	Init();
 
+	if ( size >= (long) sizeof( ibcHeader_t ) && !strcmp( buffer, IBC_HEADER_ID ) )
+	{
+		m_program = (ibcHeader_t *) buffer;
+		return true;
+	}
+
 	m_fileSize = size;
 
 	m_stream = buffer;
@@ -677,3 +740,93 @@ int CBlockStream::Open( char *buffer, long size )
 
 	return true;
 }
+
+/*
+-------------------------
+Compile
+
+Reads every block of an IBI once and lays them out flat in a single
+allocation, which CBlockStream can then read any number of times without
+parsing, swapping or copying anything. Returns NULL if the IBI is invalid.
+-------------------------
+*/
+
+char *CBlockStream::Compile( char *buffer, long size, long *compiledSize )
+{
+	CBlockStream	stream;
+	CBlock			block;
+	ibcHeader_t		*header;
+	ibcBlock_t		*outBlock;
+	ibcMember_t		*outMember;
+	int				numBlocks = 0, numMembers = 0, dataSize = 0;
+
+	//Count everything first
+	if ( !stream.Open( buffer, size ) || stream.m_program )
+		return NULL;
+
+	while ( stream.BlockAvailable() )
+	{
+		if ( !stream.ReadBlock( &block ) )
+		{
+			block.Free();
+			return NULL;
+		}
+
+		for ( int i = 0; i < block.GetNumMembers(); i++ )
+		{
+			dataSize += ( block.GetMember( i )->GetSize() + 3 ) & ~3;
+		}
+
+		numBlocks++;
+		numMembers += block.GetNumMembers();
+		block.Free();
+	}
+
+	*compiledSize = sizeof( ibcHeader_t ) + numBlocks * sizeof( ibcBlock_t ) + numMembers * sizeof( ibcMember_t ) + dataSize;
+
+	header = (ibcHeader_t *) ICARUS_Malloc( *compiledSize );
+	memset( header, 0, *compiledSize );
+
+	strcpy( header->ident, IBC_HEADER_ID );
+	header->numBlocks	= numBlocks;
+	header->ofsBlocks	= sizeof( ibcHeader_t );
+	header->numMembers	= numMembers;
+	header->ofsMembers	= header->ofsBlocks + numBlocks * sizeof( ibcBlock_t );
+	header->ofsData		= header->ofsMembers + numMembers * sizeof( ibcMember_t );
+	header->ofsEnd		= *compiledSize;
+
+	outBlock = (ibcBlock_t *) ((byte *) header + header->ofsBlocks);
+	outMember = (ibcMember_t *) ((byte *) header + header->ofsMembers);
+	numMembers = dataSize = 0;
+
+	//Then fill it in
+	stream.Open( buffer, size );
+
+	while ( stream.BlockAvailable() )
+	{
+		stream.ReadBlock( &block );
+
+		outBlock->id			= block.GetBlockID();
+		outBlock->numMembers	= block.GetNumMembers();
+		outBlock->firstMember	= numMembers;
+		outBlock->flags			= block.GetFlags();
+
+		for ( int i = 0; i < block.GetNumMembers(); i++, outMember++ )
+		{
+			CBlockMember *bMember = block.GetMember( i );
+
+			outMember->id		= bMember->GetID();
+			outMember->size		= bMember->GetSize();
+			outMember->ofsData	= dataSize;
+
+			memcpy( (byte *) header + header->ofsData + dataSize, bMember->GetData(), bMember->GetSize() );
+			dataSize += ( bMember->GetSize() + 3 ) & ~3;
+		}
+
+		numMembers += outBlock->numMembers;
+		outBlock++;
+		block.Free();
+	}
+
+	return (char *) header;
+}
@@ -404,9 +404,16 @@ bool ICARUS_RegisterScript( const char *name, qboolean bCalledDuringInterrogate
 
 	pscript = new pscript_t;
 
-	pscript->buffer = (char *) ICARUS_Malloc(length);//gi.Malloc(length, TAG_ICARUS, qfalse);
-	memcpy (pscript->buffer, buffer, length);
-	pscript->length = length;
+	// compile it once here, so every entity running it just walks the same read-only blocks
+	pscript->buffer = CBlockStream::Compile( buffer, length, &pscript->length );
+
+	if ( pscript->buffer == NULL )
+	{
+		// not a valid IBI, keep it as is so running it fails the way it always has
+		pscript->buffer = (char *) ICARUS_Malloc(length);//gi.Malloc(length, TAG_ICARUS, qfalse);
+		memcpy (pscript->buffer, buffer, length);
+		pscript->length = length;
+	}
 
 	FS_FreeFile( buffer );
 
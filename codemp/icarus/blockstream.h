@@ -32,12 +32,41 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define	IBI_EXT			".IBI"	//(I)nterpreted (B)lock (I)nstructions
 #define IBI_HEADER_ID	"IBI"
 #define IBI_HEADER_ID_LENGTH 4 // Length of IBI_HEADER_ID + 1 for the null terminating byte.
+#define IBC_HEADER_ID	"IBC"	//(I)nterpreted (B)lock (C)ode, an IBI flattened by CBlockStream::Compile
 
 const	float	IBI_VERSION			= 1.57f;
 const	int		MAX_FILENAME_LENGTH = 1024;
 
 typedef	float	vector_t[3];
 
+// A compiled script is one read-only allocation, shared by every entity that runs it:
+// the header, then all the blocks, then all their members, then the members' data
+typedef struct ibcHeader_s
+{
+	char	ident[IBI_HEADER_ID_LENGTH];
+	int		numBlocks;
+	int		ofsBlocks;
+	int		numMembers;
+	int		ofsMembers;
+	int		ofsData;
+	int		ofsEnd;
+} ibcHeader_t;
+
+typedef struct ibcBlock_s
+{
+	int				id;
+	int				numMembers;
+	int				firstMember;
+	unsigned char	flags;
+} ibcBlock_t;
+
+typedef struct ibcMember_s
+{
+	int		id;
+	int		size;
+	int		ofsData;				//already byte swapped, and 4 byte aligned
+} ibcMember_t;
+
 enum
 {
 	POP_FRONT,
@@ -71,6 +100,7 @@ public:
 	void SetData( const char * );
 	void SetData( vector_t );
 	void SetData( void *data, int size );
+	void ShareData( int id, int size, void *data );	//Point at data owned by a compiled script, copied on the first write
 
 	int	GetID( void )		const	{	return m_id;	}	//Get ID member variables
 	void *GetData( void )	const	{	return m_data;	}	//Get data member variable
@@ -90,10 +120,7 @@ public:
 
 	template <class T> void WriteData(T &data)
 	{
-		if ( m_data )
-		{
-			ICARUS_Free( m_data );
-		}
+		ReleaseData();
 
 		m_data = ICARUS_Malloc( sizeof(T) );
 		*((T *) m_data) = data;
@@ -102,10 +129,7 @@ public:
 
 	template <class T> void WriteDataPointer(const T *data, int num)
 	{
-		if ( m_data )
-		{
-			ICARUS_Free( m_data );
-		}
+		ReleaseData();
 
 		m_data = ICARUS_Malloc( num*sizeof(T) );
 		memcpy( m_data, data, num*sizeof(T) );
@@ -114,9 +138,12 @@ public:
 
 protected:
 
+	void ReleaseData( void );
+
 	int		m_id;		//ID of the value contained in data
 	int		m_size;		//Size of the data member variable
 	void	*m_data;	//Data for this member
+	bool	m_shared;	//m_data belongs to a compiled script, not to us
 };
 
 //CBlock
@@ -191,6 +218,8 @@ public:
 
 	int Open( char *, long );	//Open a stream for reading / writing
 
+	static char *Compile( char *, long, long * );	//Flatten an IBI into a compiled script
+
 protected:
 
 	unsigned	GetUnsignedInteger( void );
@@ -206,4 +235,7 @@ protected:
 
 	char	*m_stream;							//Stream of data to be parsed
 	int		m_streamPos;
+
+	const ibcHeader_t	*m_program;				//Compiled script being read instead of m_stream, if any
+	int					m_programBlock;
 };
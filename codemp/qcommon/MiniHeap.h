@@ -31,6 +31,10 @@ public:
 
 	virtual void ResetHeap() = 0;
 	virtual char *MiniHeapAlloc ( int size ) = 0;
+	// make sure the next size bytes can be allocated, resetting the heap if they can't
+	virtual void MiniHeapReserve ( int size ) = 0;
+	// bumped on every reset, so callers can tell whether memory they got earlier is still theirs
+	virtual int MiniHeapGeneration() const = 0;
 };
 
 class CMiniHeap : public IHeapAllocator
@@ -39,23 +43,59 @@ private:
 	char	*mHeap;
 	char	*mCurrentHeap;
 	int		mSize;
+	int		mMaxSize;
+	int		mGeneration;
+	int		mDemand;		// most space wanted at once since the last NewFrame, including what didn't fit
+	int		mHighWater;		// most space ever used between two resets
+	int		mOverflows;		// times the heap had to be reset early because it was full
+
+	int Used() const
+	{
+		return (int)((size_t)mCurrentHeap - (size_t)mHeap);
+	}
+
+	void Resize(int size)
+	{
+		if (size > mMaxSize)
+		{
+			size = mMaxSize;
+		}
+		if (size <= mSize)
+		{
+			return;
+		}
+
+		char *newHeap = (char *)malloc(size);
+		if (!newHeap)
+		{
+			return;
+		}
+		if (mHeap)
+		{
+			free(mHeap);
+		}
+		mHeap = newHeap;
+		mSize = size;
+	}
+
 public:
 
 	// reset the heap back to the start
 	void ResetHeap()
 	{
 		mCurrentHeap = mHeap;
+		mGeneration++;
 	}
 
-	// initialise the heap
-	CMiniHeap (int size)
+	// initialise the heap. it may grow up to maxSize if a whole frame's worth of allocations doesn't fit
+	CMiniHeap (int size, int maxSize = 0)
 	{
 		mHeap = (char *)malloc(size);
-		mSize = size;
-		if (mHeap)
-		{
-			ResetHeap();
-		}
+		mSize = mHeap ? size : 0;
+		mMaxSize = maxSize > size ? maxSize : size;
+		mGeneration = 0;
+		mDemand = mHighWater = mOverflows = 0;
+		ResetHeap();
 	}
 
 	// free up the heap
@@ -74,11 +114,60 @@ public:
 		{
 			char *tempAddress =  mCurrentHeap;
 			mCurrentHeap += size;
+			if (Used() > mHighWater)
+			{
+				mHighWater = Used();
+			}
+			if (Used() > mDemand)
+			{
+				mDemand = Used();
+			}
 			return tempAddress;
 		}
 		return NULL;
 	}
 
+	void MiniHeapReserve(int size)
+	{
+		if (size < mSize - Used())
+		{
+			return;
+		}
+
+		// everything handed out so far is about to become invalid, so this is the moment to grow if we must
+		if (Used() + size > mDemand)
+		{
+			mDemand = Used() + size;
+		}
+		mOverflows++;
+		if (size >= mSize)
+		{
+			Resize(size + 1);
+		}
+		ResetHeap();
+	}
+
+	int MiniHeapGeneration() const
+	{
+		return mGeneration;
+	}
+
+	// called once per server frame. grows the heap if the last frame didn't fit, then starts over
+	void NewFrame()
+	{
+		if (mDemand >= mSize)
+		{
+			// round up so a slightly busier frame doesn't immediately need another resize
+			Resize((mDemand + 0xFFFF) & ~0xFFFF);
+		}
+		mDemand = 0;
+		ResetHeap();
+	}
+
+	int Size() const { return mSize; }
+	int MaxSize() const { return mMaxSize; }
+	int HighWater() const { return mHighWater; }
+	int Overflows() const { return mOverflows; }
 };
 
 // this is in the parent executable, so access ri->GetG2VertSpaceServer() from the rd backends!
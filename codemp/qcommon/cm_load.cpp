@@ -24,6 +24,10 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 // cmodel.c -- model loading
 #include "cm_local.h"
 #include "qcommon/qfiles.h"
+#include "cm_patch.h"
+
+#include <atomic>
+#include <thread>
 
 #ifdef BSPC
 
@@ -511,13 +515,221 @@ static void CMod_LoadVisibility( const lump_t *l, clipMap_t &cm ) {
 //==================================================================
 
 
+#ifndef BSPC
+/*
+=================
+Patch collision cache
+
+Generated patch collision is written to patchcache/<bsp checksum>.pcc under
+the home path, one record per patch surface in surface order, so a map that
+comes around again in the rotation copies its facets instead of generating them
+=================
+*/
+#define PATCHCACHE_IDENT	(('C'<<24)+('C'<<16)+('P'<<8)+'P')
+#define PATCHCACHE_VERSION	1
+
+typedef struct patchCacheHeader_s {
+	int32_t		ident;
+	int32_t		version;
+	int32_t		bspChecksum;
+	int32_t		numSurfaces;
+	int32_t		planeSize;			// sizeof( patchPlane_t )
+	int32_t		facetSize;			// sizeof( facet_t )
+} patchCacheHeader_t;
+
+typedef struct patchCacheRecord_s {
+	int32_t		surfaceNum;
+	int32_t		width, height;		// of the control points it was generated from
+	int32_t		numPlanes;
+	int32_t		numFacets;
+	vec3_t		bounds[2];
+	// followed by the planes and facets
+} patchCacheRecord_t;
+
+typedef struct patchCache_s {
+	byte		*data;
+	int			size;
+	int			ofs;				// next record
+} patchCache_t;
+
+static cvar_t *cm_patchCache;
+
+static const char *CM_PatchCacheName( int bspChecksum ) {
+	return va( "patchcache/%08x.pcc", bspChecksum );
+}
+
+static void CM_OpenPatchCache( patchCache_t *cache, int bspChecksum, int numSurfaces ) {
+	const patchCacheHeader_t *header;
+	fileHandle_t f;
+
+	Com_Memset( cache, 0, sizeof( *cache ) );
+
+	if ( !cm_patchCache ) {
+		cm_patchCache = Cvar_Get( "cm_patchCache", "1", CVAR_ARCHIVE_ND, "Keep generated patch collision on disk for maps loaded again" );
+	}
+	if ( !cm_patchCache->integer ) {
+		return;
+	}
+
+	cache->size = FS_SV_FOpenFileRead( CM_PatchCacheName( bspChecksum ), &f );
+	if ( !f ) {
+		return;
+	}
+	if ( cache->size > (int)sizeof( *header ) ) {
+		cache->data = (byte *)FS_SV_MapFile( f, cache->size );
+	}
+	FS_FCloseFile( f );
+
+	if ( !cache->data ) {
+		return;
+	}
+
+	header = (const patchCacheHeader_t *)cache->data;
+	if ( header->ident != PATCHCACHE_IDENT || header->version != PATCHCACHE_VERSION || header->bspChecksum != bspChecksum
+		|| header->numSurfaces != numSurfaces || header->planeSize != (int)sizeof( patchPlane_t ) || header->facetSize != (int)sizeof( facet_t ) ) {
+		Sys_UnmapFile( cache->data, cache->size );
+		cache->data = NULL;
+		return;
+	}
+
+	cache->ofs = sizeof( *header );
+}
+
+static void CM_ClosePatchCache( patchCache_t *cache ) {
+	if ( cache->data ) {
+		Sys_UnmapFile( cache->data, cache->size );
+		cache->data = NULL;
+	}
+}
+
+/*
+=================
+CM_ReadCachedPatch
+
+Copies the next record into the hunk if it is for this surface and holds together
+=================
+*/
+static patchCollide_t *CM_ReadCachedPatch( patchCache_t *cache, int surfaceNum, int width, int height ) {
+	const patchCacheRecord_t *rec;
+	const patchPlane_t *planes;
+	const facet_t *facets;
+	patchCollide_t *pc;
+	int i, j, size;
+
+	if ( !cache->data || cache->size - cache->ofs < (int)sizeof( *rec ) ) {
+		return NULL;
+	}
+
+	rec = (const patchCacheRecord_t *)(cache->data + cache->ofs);
+	if ( rec->surfaceNum != surfaceNum || rec->width != width || rec->height != height
+		|| rec->numPlanes < 0 || rec->numPlanes > MAX_PATCH_PLANES || rec->numFacets < 0 || rec->numFacets > MAX_FACETS ) {
+		return NULL;
+	}
+
+	size = sizeof( *rec ) + rec->numPlanes * sizeof( patchPlane_t ) + rec->numFacets * sizeof( facet_t );
+	if ( size > cache->size - cache->ofs ) {
+		return NULL;
+	}
+
+	planes = (const patchPlane_t *)(rec + 1);
+	facets = (const facet_t *)(planes + rec->numPlanes);
+
+	// the trace code indexes planes with these without checking
+	for ( i = 0; i < rec->numFacets; i++ ) {
+		if ( facets[i].surfacePlane < 0 || facets[i].surfacePlane >= rec->numPlanes
+			|| facets[i].numBorders < 0 || facets[i].numBorders > (int)ARRAY_LEN( facets[i].borderPlanes ) ) {
+			return NULL;
+		}
+		for ( j = 0; j < facets[i].numBorders; j++ ) {
+			if ( facets[i].borderPlanes[j] < 0 || facets[i].borderPlanes[j] >= rec->numPlanes ) {
+				return NULL;
+			}
+		}
+	}
+
+	pc = (patchCollide_t *)Hunk_Alloc( sizeof( *pc ), h_high );
+	VectorCopy( rec->bounds[0], pc->bounds[0] );
+	VectorCopy( rec->bounds[1], pc->bounds[1] );
+	pc->numPlanes = rec->numPlanes;
+	pc->numFacets = rec->numFacets;
+
+	// same allocations CM_PatchCollideFromGrid makes
+	if ( pc->numFacets ) {
+		pc->facets = (facet_t *)Hunk_Alloc( pc->numFacets * sizeof( *pc->facets ), h_high );
+		Com_Memcpy( pc->facets, facets, pc->numFacets * sizeof( *pc->facets ) );
+	}
+	pc->planes = (patchPlane_t *)Hunk_Alloc( pc->numPlanes * sizeof( *pc->planes ), h_high );
+	Com_Memcpy( pc->planes, planes, pc->numPlanes * sizeof( *pc->planes ) );
+
+	cache->ofs += size;
+	return pc;
+}
+
+static void CM_WritePatchCache( int bspChecksum, const clipMap_t &cm, const dsurface_t *surfaces ) {
+	patchCacheHeader_t header;
+	patchCacheRecord_t rec;
+	fileHandle_t f;
+	char name[MAX_QPATH], tmpName[MAX_QPATH];
+	int failed = 0;
+
+	// CM_OpenPatchCache maps the file, here or in another server sharing the
+	// home path, so never write it in place: write a file of our own and
+	// rename it over the old one
+	Q_strncpyz( name, CM_PatchCacheName( bspChecksum ), sizeof( name ) );
+	Com_sprintf( tmpName, sizeof( tmpName ), "%s.%d.tmp", name, Sys_PID() );
+
+	f = FS_SV_FOpenFileWrite( tmpName );
+	if ( !f ) {
+		return;
+	}
+
+	header.ident = PATCHCACHE_IDENT;
+	header.version = PATCHCACHE_VERSION;
+	header.bspChecksum = bspChecksum;
+	header.numSurfaces = cm.numSurfaces;
+	header.planeSize = sizeof( patchPlane_t );
+	header.facetSize = sizeof( facet_t );
+	failed |= FS_Write( &header, sizeof( header ), f ) != (int)sizeof( header );
+
+	for ( int i = 0; i < cm.numSurfaces; i++ ) {
+		const patchCollide_t *pc;
+
+		if ( !cm.surfaces[i] ) {
+			continue;
+		}
+		pc = cm.surfaces[i]->pc;
+
+		Com_Memset( &rec, 0, sizeof( rec ) );
+		rec.surfaceNum = i;
+		rec.width = LittleLong( surfaces[i].patchWidth );
+		rec.height = LittleLong( surfaces[i].patchHeight );
+		rec.numPlanes = pc->numPlanes;
+		rec.numFacets = pc->numFacets;
+		VectorCopy( pc->bounds[0], rec.bounds[0] );
+		VectorCopy( pc->bounds[1], rec.bounds[1] );
+
+		failed |= FS_Write( &rec, sizeof( rec ), f ) != (int)sizeof( rec );
+		failed |= FS_Write( pc->planes, pc->numPlanes * sizeof( *pc->planes ), f ) != (int)(pc->numPlanes * sizeof( *pc->planes ));
+		failed |= FS_Write( pc->facets, pc->numFacets * sizeof( *pc->facets ), f ) != (int)(pc->numFacets * sizeof( *pc->facets ));
+	}
+
+	FS_FCloseFile( f );
+
+	if ( failed ) {
+		FS_SV_Remove( tmpName );
+		return;
+	}
+	FS_SV_Rename( tmpName, name, qfalse );
+}
+#endif // !BSPC
+
 /*
 =================
 CMod_LoadPatches
 =================
 */
 #define	MAX_PATCH_VERTS		1024
-static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_t &cm ) {
+static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_t &cm, int bspChecksum ) {
 	drawVert_t	*dv, *dv_p;
 	dsurface_t	*in;
 	int			count;
@@ -527,6 +739,10 @@ static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_
 	vec3_t		points[MAX_PATCH_VERTS];
 	int			width, height;
 	int			shaderNum;
+#ifndef BSPC
+	patchCache_t	cache;
+	int			numCached = 0, numGenerated = 0;
+#endif
 
 	in = (dsurface_t *)(cmod_base + surfs->fileofs);
 	if (surfs->filelen % sizeof(*in))
@@ -538,6 +754,10 @@ static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_
 	if (verts->filelen % sizeof(*dv))
 		Com_Error (ERR_DROP, "MOD_LoadBmodel: funny lump size");
 
+#ifndef BSPC
+	CM_OpenPatchCache( &cache, bspChecksum, count );
+#endif
+
 	// scan through all the surfaces, but only load patches,
 	// not planar faces
 	for ( i = 0 ; i < count ; i++, in++ ) {
@@ -553,9 +773,24 @@ static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_
 		height = LittleLong( in->patchHeight );
 		c = width * height;
 		if ( c > MAX_PATCH_VERTS ) {
+#ifndef BSPC
+			CM_ClosePatchCache( &cache );
+#endif
 			Com_Error( ERR_DROP, "ParseMesh: MAX_PATCH_VERTS" );
 		}
 
+		shaderNum = LittleLong( in->shaderNum );
+		patch->contents = cm.shaders[shaderNum].contentFlags;
+		patch->surfaceFlags = cm.shaders[shaderNum].surfaceFlags;
+
+#ifndef BSPC
+		if ( (patch->pc = CM_ReadCachedPatch( &cache, i, width, height )) != NULL ) {
+			numCached++;
+			continue;
+		}
+		numGenerated++;
+#endif
+
 		dv_p = dv + LittleLong( in->firstVert );
 		for ( j = 0 ; j < c ; j++, dv_p++ ) {
 			points[j][0] = LittleFloat( dv_p->xyz[0] );
@@ -563,17 +798,265 @@ static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_
 			points[j][2] = LittleFloat( dv_p->xyz[2] );
 		}
 
-		shaderNum = LittleLong( in->shaderNum );
-		patch->contents = cm.shaders[shaderNum].contentFlags;
-		patch->surfaceFlags = cm.shaders[shaderNum].surfaceFlags;
-
 		// create the internal facet structure
 		patch->pc = CM_GeneratePatchCollide( width, height, points );
 	}
+
+#ifndef BSPC
+	CM_ClosePatchCache( &cache );
+
+	if ( numGenerated ) {
+		if ( cm_patchCache->integer ) {
+			CM_WritePatchCache( bspChecksum, cm, (dsurface_t *)(cmod_base + surfs->fileofs) );
+		}
+		Com_DPrintf( "Patch collision: %d from cache, %d generated\n", numCached, numGenerated );
+	} else if ( numCached ) {
+		Com_DPrintf( "Patch collision: %d from cache\n", numCached );
+	}
+#endif
 }
 
 //==================================================================
 
+#ifndef BSPC
+/*
+==================
+Map file cache
+
+The last few BSP files loaded stay in memory, along with the one the server
+expects to load next, which a worker thread reads and checksums during the
+match. A map change that finds its BSP here skips reading and inflating it.
+==================
+*/
+#define MAX_CACHED_MAPS		8
+
+typedef struct cachedMap_s {
+	char		name[MAX_QPATH];
+	int			pakChecksum;		// pack the file was read from
+	int			length;
+	byte		*data;				// malloc'd, the preload thread can't use the zone
+	int			checksum;			// as CM_LoadMap reports it
+	int			lastUsed;
+} cachedMap_t;
+
+static cachedMap_t	cmMapCache[MAX_CACHED_MAPS];
+static int			cmMapCacheTime;
+static cvar_t		*cm_mapCacheSize;
+
+static std::thread			*cmPreloadThread;
+static std::atomic<bool>	cmPreloadFinished;
+static cachedMap_t			cmPreload;
+static fileHandle_t			cmPreloadHandle;
+static qboolean				cmPreloadFailed;
+
+static int CM_MapCacheSize( void ) {
+	if ( !cm_mapCacheSize ) {
+		cm_mapCacheSize = Cvar_Get( "cm_mapCacheSize", "2", CVAR_ARCHIVE_ND, "Number of map files kept in memory for the next map change, 0 disables preloading" );
+	}
+
+	return Com_Clampi( 0, MAX_CACHED_MAPS, cm_mapCacheSize->integer );
+}
+
+static void CM_FreeCachedMapEntry( cachedMap_t *entry ) {
+	free( entry->data );
+	Com_Memset( entry, 0, sizeof( *entry ) );
+}
+
+static cachedMap_t *CM_FindCachedMap( const char *name, int pakChecksum, int length ) {
+	if ( !pakChecksum ) {
+		return NULL;
+	}
+
+	for ( int i = 0; i < MAX_CACHED_MAPS; i++ ) {
+		cachedMap_t *entry = &cmMapCache[i];
+
+		if ( entry->data && entry->pakChecksum == pakChecksum && entry->length == length && !Q_stricmp( entry->name, name ) ) {
+			entry->lastUsed = ++cmMapCacheTime;
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+// takes over the data of a filled in entry
+static void CM_StoreCachedMap( cachedMap_t *map ) {
+	cachedMap_t *slot = NULL;
+	int size = CM_MapCacheSize();
+	int i;
+
+	// the cache may have been made smaller
+	for ( i = size; i < MAX_CACHED_MAPS; i++ ) {
+		if ( cmMapCache[i].data ) {
+			CM_FreeCachedMapEntry( &cmMapCache[i] );
+		}
+	}
+
+	// replace the same map, else take a free slot, else the least recently used
+	for ( i = 0; i < size && !slot; i++ ) {
+		if ( cmMapCache[i].data && !Q_stricmp( cmMapCache[i].name, map->name ) ) {
+			slot = &cmMapCache[i];
+		}
+	}
+	for ( i = 0; i < size && !slot; i++ ) {
+		if ( !cmMapCache[i].data ) {
+			slot = &cmMapCache[i];
+		}
+	}
+	if ( !slot ) {
+		for ( i = 0; i < size; i++ ) {
+			if ( !slot || cmMapCache[i].lastUsed < slot->lastUsed ) {
+				slot = &cmMapCache[i];
+			}
+		}
+	}
+
+	if ( !slot ) {
+		free( map->data );
+		return;
+	}
+
+	if ( slot->data ) {
+		CM_FreeCachedMapEntry( slot );
+	}
+	*slot = *map;
+	slot->lastUsed = ++cmMapCacheTime;
+}
+
+/*
+==================
+CM_FreeMapCache
+
+Frees every map file kept in memory, returns qtrue if there were any
+==================
+*/
+static qboolean CM_FreeMapCache( void ) {
+	qboolean freed = qfalse;
+
+	for ( int i = 0; i < MAX_CACHED_MAPS; i++ ) {
+		if ( cmMapCache[i].data ) {
+			CM_FreeCachedMapEntry( &cmMapCache[i] );
+			freed = qtrue;
+		}
+	}
+
+	return freed;
+}
+
+static void CM_PreloadThread( void ) {
+	// FS_Read on a unique handle only touches that handle
+	if ( FS_Read( cmPreload.data, cmPreload.length, cmPreloadHandle ) == cmPreload.length ) {
+		cmPreload.checksum = LittleLong( Com_BlockChecksum( cmPreload.data, cmPreload.length ) );
+	} else {
+		cmPreloadFailed = qtrue;
+	}
+
+	cmPreloadFinished = true;
+}
+
+/*
+==================
+CM_PreloadMap
+
+Starts reading a map file the next map change is likely to need,
+returns qfalse if another one is still being read
+==================
+*/
+qboolean CM_PreloadMap( const char *name ) {
+	fileHandle_t h;
+	int length, pakChecksum;
+
+	if ( cmPreloadThread ) {
+		return qfalse;
+	}
+	if ( !CM_MapCacheSize() ) {
+		return qtrue;
+	}
+
+	length = FS_FOpenFileRead( name, &h, qtrue );
+	if ( !h ) {
+		return qtrue;
+	}
+
+	// loose files could change before the map change without anything noticing
+	pakChecksum = FS_FileHandlePakChecksum( h );
+	if ( !pakChecksum || length <= 0 || CM_FindCachedMap( name, pakChecksum, length ) ) {
+		FS_FCloseFile( h );
+		return qtrue;
+	}
+
+	Com_Memset( &cmPreload, 0, sizeof( cmPreload ) );
+	cmPreload.data = (byte *)malloc( length );
+	if ( !cmPreload.data ) {
+		FS_FCloseFile( h );
+		return qtrue;
+	}
+	Q_strncpyz( cmPreload.name, name, sizeof( cmPreload.name ) );
+	cmPreload.pakChecksum = pakChecksum;
+	cmPreload.length = length;
+
+	Com_DPrintf( "Preloading %s\n", name );
+
+	cmPreloadHandle = h;
+	cmPreloadFailed = qfalse;
+	cmPreloadFinished = false;
+	cmPreloadThread = new std::thread( CM_PreloadThread );
+	return qtrue;
+}
+
+/*
+==================
+CM_FinishPreload
+
+Moves a finished preload into the cache, waiting for it if asked to.
+Must be waited for before the file system restarts.
+==================
+*/
+void CM_FinishPreload( qboolean wait ) {
+	if ( !cmPreloadThread || ( !wait && !cmPreloadFinished ) ) {
+		return;
+	}
+
+	cmPreloadThread->join();
+	delete cmPreloadThread;
+	cmPreloadThread = NULL;
+
+	FS_FCloseFile( cmPreloadHandle );
+	cmPreloadHandle = 0;
+
+	if ( cmPreloadFailed ) {
+		Com_DPrintf( "Couldn't preload %s\n", cmPreload.name );
+		free( cmPreload.data );
+		return;
+	}
+
+	CM_StoreCachedMap( &cmPreload );
+}
+
+// keeps a copy of a map file that was read the usual way
+static void CM_CacheMapFile( const char *name, int pakChecksum, const void *data, int length, int checksum ) {
+	cachedMap_t map;
+
+	if ( !pakChecksum || !CM_MapCacheSize() ) {
+		return;
+	}
+
+	Com_Memset( &map, 0, sizeof( map ) );
+	map.data = (byte *)malloc( length );
+	if ( !map.data ) {
+		return;
+	}
+	Com_Memcpy( map.data, data, length );
+	Q_strncpyz( map.name, name, sizeof( map.name ) );
+	map.pakChecksum = pakChecksum;
+	map.length = length;
+	map.checksum = checksum;
+
+	CM_StoreCachedMap( &map );
+}
+#endif // !BSPC
+
+
 /*
 ==================
 CM_LoadMap
@@ -609,6 +1092,13 @@ qboolean CM_DeleteCachedMap(qboolean bGuaranteedOkToDelete)
 		// force map loader to ignore cached internal BSP structures for next level CM_LoadMap() call...
 		//
 		cmg.name[0] = '\0';
+
+#ifndef BSPC
+		// the map files kept for the next map change can be read again
+		if ( CM_FreeMapCache() ) {
+			bActuallyFreedSomething = qtrue;
+		}
+#endif
 	}
 
 	return bActuallyFreedSomething;
@@ -685,11 +1175,21 @@ static void CM_LoadMap_Actual( const char *name, qboolean clientload, int *check
 	//
 	buf = NULL;
 	fileHandle_t h;
+	cachedMap_t *cached = NULL;
+	int pakChecksum = 0;
 	const int iBSPLen = FS_FOpenFileRead( name, &h, qfalse );
 	if (h)
 	{
+		pakChecksum = FS_FileHandlePakChecksum( h );
+		cached = CM_FindCachedMap( name, pakChecksum, iBSPLen );
+
 		newBuff = Z_Malloc( iBSPLen, TAG_BSP_DISKIMAGE );
-		FS_Read( newBuff, iBSPLen, h);
+		if ( cached ) {
+			Com_Memcpy( newBuff, cached->data, iBSPLen );
+			Com_DPrintf( "Loading %s from the map cache\n", name );
+		} else {
+			FS_Read( newBuff, iBSPLen, h);
+		}
 		FS_FCloseFile( h );
 
 		buf = (int*) newBuff;	// so the rest of the code works as normal
@@ -710,7 +1210,16 @@ static void CM_LoadMap_Actual( const char *name, qboolean clientload, int *check
 		Com_Error (ERR_DROP, "Couldn't load %s", name);
 	}
 
+#ifndef BSPC
+	if ( cached ) {
+		last_checksum = cached->checksum;
+	} else {
+		last_checksum = LittleLong (Com_BlockChecksum (buf, iBSPLen));
+		CM_CacheMapFile( name, pakChecksum, buf, iBSPLen, last_checksum );
+	}
+#else
 	last_checksum = LittleLong (Com_BlockChecksum (buf, iBSPLen));
+#endif
 	if ( checksum )
 		*checksum = last_checksum;
 
@@ -741,7 +1250,7 @@ static void CM_LoadMap_Actual( const char *name, qboolean clientload, int *check
 	CMod_LoadNodes (&header.lumps[LUMP_NODES], cm);
 	CMod_LoadEntityString (&header.lumps[LUMP_ENTITIES], cm, name);
 	CMod_LoadVisibility( &header.lumps[LUMP_VISIBILITY], cm );
-	CMod_LoadPatches( &header.lumps[LUMP_SURFACES], &header.lumps[LUMP_DRAWVERTS], cm );
+	CMod_LoadPatches( &header.lumps[LUMP_SURFACES], &header.lumps[LUMP_DRAWVERTS], cm, last_checksum );
 
 	TotalSubModels += cm.numSubModels;
 
@@ -27,6 +27,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qfiles.h"
 
 void		CM_LoadMap( const char *name, qboolean clientload, int *checksum);
+qboolean	CM_PreloadMap( const char *name );
+void		CM_FinishPreload( qboolean wait );
 
 void		CM_ClearMap( void );
 clipHandle_t CM_InlineModel( int index );		// 0 = world, 1 + are bmodels
@@ -128,25 +128,16 @@ void Com_EndRedirect (void)
 
 /*
 =============
-Com_Printf
+Com_PrintLevel
 
-Both client and server can use this, and it will output
-to the appropriate place.
-
-A raw string should NEVER be passed as fmt, because of "%f" type crashers.
+Output an already formatted message, level is only used by the log file
 =============
 */
 std::recursive_mutex printfLock;
-void QDECL Com_Printf( const char *fmt, ... ) {
+static void Com_PrintLevel( int level, const char *msg ) {
 	std::lock_guard<std::recursive_mutex> l( printfLock );
 
 	static qboolean opening_qconsole = qfalse;
-	va_list		argptr;
-	char		msg[MAXPRINTMSG];
-
-	va_start (argptr,fmt);
-	Q_vsnprintf (msg, sizeof(msg), fmt, argptr);
-	va_end (argptr);
 
 	if ( rd_buffer ) {
 		if ((strlen (msg) + strlen(rd_buffer)) > (size_t)(rd_buffersize - 1)) {
@@ -183,6 +174,7 @@ void QDECL Com_Printf( const char *fmt, ... ) {
 			logfile = FS_FOpenFileWrite( "qconsole.log" );
 
 			if ( logfile ) {
+				Com_LogBind( LOGCHAN_CONSOLE, logfile );
 				Com_Printf( "logfile opened on %s\n", asctime( newtime ) );
 				if ( com_logfile->integer > 1 ) {
 					// force it to not buffer so we get valid
@@ -196,7 +188,7 @@ void QDECL Com_Printf( const char *fmt, ... ) {
 			}
 		}
 		opening_qconsole = qfalse;
-		if ( logfile && FS_Initialized()) {
+		if ( logfile && FS_Initialized() && !Com_LogPrint( LOGCHAN_CONSOLE, level, msg ) ) {
 			FS_Write(msg, strlen(msg), logfile);
 		}
 	}
@@ -211,6 +203,37 @@ void QDECL Com_Printf( const char *fmt, ... ) {
 #endif
 }
 
+/*
+=============
+Com_Printf
+
+Both client and server can use this, and it will output
+to the appropriate place.
+
+A raw string should NEVER be passed as fmt, because of "%f" type crashers.
+=============
+*/
+void QDECL Com_Printf( const char *fmt, ... ) {
+	va_list		argptr;
+	char		msg[MAXPRINTMSG];
+	const char	*s;
+	int			level = LOGLEVEL_INFO;
+
+	va_start (argptr,fmt);
+	Q_vsnprintf (msg, sizeof(msg), fmt, argptr);
+	va_end (argptr);
+
+	// tag warnings and errors for com_logLevel
+	for ( s = msg; Q_IsColorString( s ); s += 2 )
+		;
+	if ( !Q_stricmpn( s, "WARNING", 7 ) )
+		level = LOGLEVEL_WARNING;
+	else if ( !Q_stricmpn( s, "ERROR", 5 ) )
+		level = LOGLEVEL_ERROR;
+
+	Com_PrintLevel( level, msg );
+}
+
 /*
 ================
 Com_DPrintf
@@ -230,7 +253,7 @@ void QDECL Com_DPrintf( const char *fmt, ...) {
 	Q_vsnprintf (msg, sizeof(msg), fmt, argptr);
 	va_end (argptr);
 
-	Com_Printf ("%s", msg);
+	Com_PrintLevel( LOGLEVEL_DEBUG, msg );
 }
 
 // Outputs to the VC / Windows Debug window (only in debug compile)
@@ -1238,6 +1261,7 @@ void Com_Init( char *commandLine ) {
 		// init commands and vars
 		//
 		com_logfile = Cvar_Get ("logfile", "0", CVAR_TEMP );
+		Com_LogInit();
 
 		com_timescale = Cvar_Get ("timescale", "1", CVAR_CHEAT | CVAR_SYSTEMINFO );
 		com_fixedtime = Cvar_Get ("fixedtime", "0", CVAR_CHEAT);
@@ -1705,6 +1729,7 @@ void Com_Shutdown (void)
 		logfile = 0;
 		com_logfile->integer = 0;//don't open up the log file again!!
 	}
+	Com_LogShutdown();
 
 	if ( com_journalFile ) {
 		FS_FCloseFile( com_journalFile );
@@ -30,10 +30,16 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <list>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "qcommon/qcommon.h"
@@ -223,8 +229,53 @@ typedef struct pack_s {
 	int				hashSize;					// hash table size (power of 2)
 	fileInPack_t*	*hashTable;					// hash table
 	fileInPack_t*	buildBuffer;				// buffer with the filenames etc.
+	fileInPack_t*	*sortedFiles;				// buildBuffer sorted by name, for directory listings
+	int				numSortedFiles;
+	int				*headerLongs;				// checksum feed followed by the file crcs
+	int				numHeaderLongs;
+	int				fileSize;					// size and mtime when the index was built
+	time_t			mtime;
+	int				cdirChecksum;				// FS_CentralDirChecksum, 0 if it can't go in the index
+	struct pack_s	*nextParked;				// next pack kept across FS_Restart
 } pack_t;
 
+// index of pk3 directories kept in the home path, so startup doesn't have to parse every zip
+#define PK3INDEX_FILE		"pk3index.dat"
+#define PK3INDEX_IDENT		(('X'<<24)+('I'<<16)+('K'<<8)+'P')
+#define PK3INDEX_VERSION	1
+
+typedef struct pk3IndexHeader_s {
+	int32_t			ident;
+	int32_t			version;
+	int32_t			recordHeaderSize;			// sizeof( pk3IndexPak_t )
+	int32_t			numPaks;
+} pk3IndexHeader_t;
+
+typedef struct pk3IndexFile_s {
+	uint32_t		pos;						// file info position in zip
+	uint32_t		len;						// uncompress file size
+	uint32_t		hash;						// FS_HashFileName for the pack's hash size
+	uint32_t		nameOfs;					// into the names after the files
+} pk3IndexFile_t;
+
+typedef struct pk3IndexPak_s {
+	int32_t			recordSize;					// to the next record, a multiple of 8
+	int32_t			fileSize;
+	int64_t			mtime;
+	int32_t			cdirChecksum;
+	int32_t			numFiles;
+	int32_t			numHeaderLongs;				// file crcs, without the checksum feed
+	int32_t			namesSize;
+	char			pakFilename[MAX_OSPATH];
+	// followed by the crcs, the files and their names
+} pk3IndexPak_t;
+
+#define PK3INDEX_CRCS( rec )	((const int32_t *)((rec) + 1))
+#define PK3INDEX_FILES( rec )	((const pk3IndexFile_t *)(PK3INDEX_CRCS( rec ) + (rec)->numHeaderLongs))
+#define PK3INDEX_NAMES( rec )	((const char *)(PK3INDEX_FILES( rec ) + (rec)->numFiles))
+#define PK3INDEX_RECORDSIZE( numHeaderLongs, numFiles, namesSize ) \
+	((int)(sizeof( pk3IndexPak_t ) + (numHeaderLongs) * sizeof( int32_t ) + (numFiles) * sizeof( pk3IndexFile_t ) + (namesSize) + 7) & ~7)
+
 typedef struct directory_s {
 	char		path[MAX_OSPATH];		// c:\jediacademy\gamedata
 	char		fullpath[MAX_OSPATH];	// c:\jediacademy\gamedata\base
@@ -254,13 +305,25 @@ static cvar_t		*fs_copyfiles;
 cvar_t		*fs_gamedirvar;
 static cvar_t		*fs_dirbeforepak; //rww - when building search path, keep directories at top and insert pk3's under them
 static searchpath_t	*fs_searchpaths;
-static int			fs_readCount;			// total bytes read
+static std::atomic<int>	fs_readCount;	// total bytes read, the map preload reads on a worker thread
 static int			fs_loadCount;			// total files read
 static int			fs_packFiles = 0;		// total number of files in packs
 
 static int			fs_fakeChkSum;
 static int			fs_checksumFeed;
 
+// packs from the previous search path, reused by FS_Restart if they haven't changed on disk
+static pack_t		*fs_parkedPaks;
+static int			fs_paksReused;			// packs taken from fs_parkedPaks by the last startup
+static int			fs_paksLoaded;			// packs indexed from scratch by the last startup
+
+static cvar_t		*fs_indexCache;
+static byte			*fs_pakIndex;			// PK3INDEX_FILE, mapped while FS_Startup adds the packs
+static int			fs_pakIndexSize;
+static int			fs_pakIndexCursor;		// offset after the last record used
+static int			fs_paksFromIndex;		// packs FS_LoadZipFile built from the index
+static int			fs_paksParsed;			// packs FS_LoadZipFile had to parse
+
 typedef union qfile_gus {
 	FILE*		o;
 	unzFile		z;
@@ -284,6 +347,7 @@ typedef struct fileHandleData_s {
 	int			fileSize;
 	int			zipFilePos;
 	int			zipFileLen;
+	int			zipChecksum;
 	qboolean	zipFile;
 	char		name[MAX_ZPATH];
 } fileHandleData_t;
@@ -340,6 +404,7 @@ static void FS_ResetFileHandleData( fileHandleData_t *f ) {
 	f->fileSize = 0;
 	f->zipFilePos = 0;
 	f->zipFileLen = 0;
+	f->zipChecksum = 0;
 	f->zipFile = qfalse;
 	f->name[0] = '\0';
 }
@@ -935,6 +1000,19 @@ int FS_SV_FOpenFileRead( const char *filename, fileHandle_t *fp ) {
 	return 0;
 }
 
+/*
+===========
+FS_SV_MapFile
+
+maps a file opened with FS_SV_FOpenFileRead, the handle can be closed afterwards
+===========
+*/
+void *FS_SV_MapFile( fileHandle_t f, int size ) {
+	FS_AssertInitialised();
+
+	return Sys_MapFile( FS_FileForHandle( f ), size );
+}
+
 /*
 ===========
 FS_SV_Rename
@@ -969,6 +1047,23 @@ void FS_SV_Rename( const char *from, const char *to, qboolean safe ) {
 	}
 }
 
+/*
+===========
+FS_SV_Remove
+
+===========
+*/
+void FS_SV_Remove( const char *filename ) {
+	char			*ospath;
+
+	FS_AssertInitialised();
+
+	ospath = FS_BuildOSPath( fs_homepath->string, filename, "" );
+	ospath[strlen(ospath)-1] = '\0';
+
+	FS_Remove( ospath );
+}
+
 /*
 ===========
 FS_Rename
@@ -1040,6 +1135,9 @@ void FS_FCloseFile( fileHandle_t f ) {
 		return;
 	}
 
+	// a log channel may still have lines queued for it
+	Com_LogUnbindFile( f );
+
 	// we didn't find it as a pak, so close it as a unique file
 	if (fsh[f].handleFiles.file.o) {
 		if ( fsh[f].handleAsync ) {
@@ -1535,6 +1633,7 @@ long FS_FOpenFileRead( const char *filename, fileHandle_t *file, qboolean unique
 #endif
 						fsh[*file].zipFilePos = pakFile->pos;
 						fsh[*file].zipFileLen = pakFile->len;
+						fsh[*file].zipChecksum = pak->checksum;
 
 						if ( fs_debug->integer ) {
 							Com_Printf( "FS_FOpenFileRead: %s (found in '%s')\n",
@@ -1716,6 +1815,40 @@ qboolean FS_FindPureDLL(const char *name)
 	return qfalse;
 }
 
+/*
+=================
+FS_FileHandlePakChecksum
+
+Returns the checksum of the pack an open file is read from, 0 if it isn't in one
+=================
+*/
+int FS_FileHandlePakChecksum( fileHandle_t f ) {
+	FS_AssertInitialised();
+
+	if ( !f || !fsh[f].zipFile ) {
+		return 0;
+	}
+
+	return fsh[f].zipChecksum;
+}
+
+/*
+=================
+FS_FileHandleTime
+
+Returns the mtime of an open file, -1 if it is in a pack or can't be told
+=================
+*/
+time_t FS_FileHandleTime( fileHandle_t f ) {
+	FS_AssertInitialised();
+
+	if ( !f || fsh[f].zipFile ) {
+		return -1;
+	}
+
+	return Sys_FileTimeForFile( FS_FileForHandle( f ) );
+}
+
 /*
 =================
 FS_Read
@@ -1999,6 +2132,150 @@ int	FS_FileIsInPAK(const char *filename, int *pChecksum ) {
 	return -1;
 }
 
+/*
+=================================================================================
+
+DECOMPRESSED FILE CACHE
+
+Small files read out of packs are kept after inflating them, keyed by the
+checksum of the pack they came from, so the game module reloading the same
+configs on every map change doesn't go back through unzip
+
+=================================================================================
+*/
+
+#define MAX_CACHED_FILE_SIZE	(256 * 1024)
+
+typedef struct cachedFile_s {
+	std::string			key;
+	int					pakChecksum;
+	std::vector<byte>	data;
+} cachedFile_t;
+
+// most recently used at the front
+static std::list<cachedFile_t> fs_fileCache;
+static std::unordered_map<std::string, std::list<cachedFile_t>::iterator> fs_fileCacheIndex;
+static size_t fs_fileCacheBytes;
+static int fs_fileCacheHits, fs_fileCacheMisses, fs_fileCacheEvictions;
+
+static cvar_t *fs_fileCacheSize;
+
+static bool FS_FileCacheable( fileHandle_t h, long len ) {
+	return fsh[h].zipFile && fs_fileCacheSize && fs_fileCacheSize->integer > 0
+		&& len <= MAX_CACHED_FILE_SIZE && len <= fs_fileCacheSize->integer * 1024 * 1024;
+}
+
+static std::string FS_FileCacheKey( fileHandle_t h ) {
+	char key[MAX_ZPATH + 16];
+
+	Com_sprintf( key, sizeof( key ), "%08x:%s", fsh[h].zipChecksum, fsh[h].name );
+	Q_strlwr( key );
+	return key;
+}
+
+static void FS_EvictCachedFile( void ) {
+	cachedFile_t &file = fs_fileCache.back();
+
+	fs_fileCacheBytes -= file.data.size();
+	fs_fileCacheIndex.erase( file.key );
+	fs_fileCache.pop_back();
+	fs_fileCacheEvictions++;
+}
+
+/*
+=================
+FS_ReadCachedFile
+
+Fills buf from the cache if this pack file was read before
+=================
+*/
+static qboolean FS_ReadCachedFile( fileHandle_t h, byte *buf, long len ) {
+	if ( !FS_FileCacheable( h, len ) ) {
+		return qfalse;
+	}
+
+	auto it = fs_fileCacheIndex.find( FS_FileCacheKey( h ) );
+	if ( it == fs_fileCacheIndex.end() || (long)it->second->data.size() != len ) {
+		fs_fileCacheMisses++;
+		return qfalse;
+	}
+
+	fs_fileCache.splice( fs_fileCache.begin(), fs_fileCache, it->second );
+	Com_Memcpy( buf, it->second->data.data(), len );
+	fs_fileCacheHits++;
+	return qtrue;
+}
+
+/*
+=================
+FS_CacheFile
+=================
+*/
+static void FS_CacheFile( fileHandle_t h, const byte *buf, long len ) {
+	if ( !FS_FileCacheable( h, len ) ) {
+		return;
+	}
+
+	std::string key = FS_FileCacheKey( h );
+	if ( fs_fileCacheIndex.count( key ) ) {
+		return;
+	}
+
+	fs_fileCache.push_front( cachedFile_t() );
+	cachedFile_t &file = fs_fileCache.front();
+	file.key = key;
+	file.pakChecksum = fsh[h].zipChecksum;
+	file.data.assign( buf, buf + len );
+	fs_fileCacheIndex[key] = fs_fileCache.begin();
+	fs_fileCacheBytes += len;
+
+	while ( fs_fileCacheBytes > (size_t)fs_fileCacheSize->integer * 1024 * 1024 ) {
+		FS_EvictCachedFile();
+	}
+}
+
+/*
+=================
+FS_PruneFileCache
+
+Drops files from packs that aren't in the search path anymore,
+or everything if there is no search path
+=================
+*/
+static void FS_PruneFileCache( void ) {
+	std::unordered_set<int> loaded;
+	searchpath_t *search;
+
+	for ( search = fs_searchpaths; search; search = search->next ) {
+		if ( search->pack ) {
+			loaded.insert( search->pack->checksum );
+		}
+	}
+
+	for ( auto it = fs_fileCache.begin(); it != fs_fileCache.end(); ) {
+		if ( loaded.count( it->pakChecksum ) ) {
+			++it;
+			continue;
+		}
+		fs_fileCacheBytes -= it->data.size();
+		fs_fileCacheIndex.erase( it->key );
+		it = fs_fileCache.erase( it );
+	}
+}
+
+/*
+=================
+FS_CacheStats_f
+=================
+*/
+static void FS_CacheStats_f( void ) {
+	int lookups = fs_fileCacheHits + fs_fileCacheMisses;
+
+	Com_Printf( "%d files cached, %d of %d KB\n", (int)fs_fileCache.size(), (int)(fs_fileCacheBytes / 1024), fs_fileCacheSize->integer * 1024 );
+	Com_Printf( "%d lookups, %d hits (%.1f%%), %d misses, %d evicted\n", lookups, fs_fileCacheHits,
+		lookups ? 100.0f * fs_fileCacheHits / lookups : 0.0f, fs_fileCacheMisses, fs_fileCacheEvictions );
+}
+
 /*
 ============
 FS_ReadFile
@@ -2099,7 +2376,9 @@ long FS_ReadFile( const char *qpath, void **buffer ) {
 
 //	Z_Label(buf, qpath);
 
-	FS_Read (buf, len, h);
+	if ( !FS_ReadCachedFile( h, buf, len ) && FS_Read (buf, len, h) == len ) {
+		FS_CacheFile( h, buf, len );
+	}
 
 	// guarantee that it will have a trailing 0 for string operations
 	buf[len] = 0;
@@ -2164,6 +2443,162 @@ ZIP FILE LOADING
 ==========================================================================
 */
 
+/*
+=================
+FS_CentralDirChecksum
+
+Checksums everything from the first central directory entry to the
+end of the zip, which covers the names, offsets and crcs of every file
+=================
+*/
+#define MAX_CENTRAL_DIR_SIZE	(64 * 1024 * 1024)
+
+static int FS_CentralDirChecksum( const char *zipfile, unsigned long cdirOffset, int fileSize )
+{
+	FILE	*f;
+	byte	*buf;
+	int		len, checksum;
+
+	len = fileSize - (int)cdirOffset;
+	if ( fileSize < 0 || len <= 0 || len > MAX_CENTRAL_DIR_SIZE ) {
+		return 0;
+	}
+
+	f = fopen( zipfile, "rb" );
+	if ( !f ) {
+		return 0;
+	}
+
+	buf = (byte *)Z_Malloc( len, TAG_TEMP_WORKSPACE, qfalse );
+	if ( fseek( f, (long)cdirOffset, SEEK_SET ) || fread( buf, 1, len, f ) != (size_t)len ) {
+		checksum = 0;
+	} else {
+		checksum = Com_BlockChecksum( buf, len );
+	}
+
+	Z_Free( buf );
+	fclose( f );
+	return checksum;
+}
+
+/*
+=================
+FS_FindPakIndex
+
+Finds the index record for a zip, if the zip hasn't changed since it was written
+=================
+*/
+static const pk3IndexPak_t *FS_FindPakIndex( const char *zipfile, int fileSize, time_t mtime, int cdirChecksum, int numFiles )
+{
+	const pk3IndexPak_t	*rec;
+	int					ofs, pass, end;
+
+	if ( !fs_pakIndex ) {
+		return NULL;
+	}
+
+	// records are in load order, so the one after the last match is usually it
+	for ( pass = 0; pass < 2; pass++ ) {
+		ofs = pass ? (int)sizeof( pk3IndexHeader_t ) : fs_pakIndexCursor;
+		end = pass ? fs_pakIndexCursor : fs_pakIndexSize;
+
+		while ( ofs < end ) {
+			rec = (const pk3IndexPak_t *)(fs_pakIndex + ofs);
+			if ( end - ofs < (int)sizeof( *rec ) || rec->recordSize < (int)sizeof( *rec ) || rec->recordSize > end - ofs ) {
+				break;
+			}
+			ofs += rec->recordSize;
+
+			if ( !Sys_PathCmp( rec->pakFilename, zipfile ) ) {
+				continue;
+			}
+			if ( rec->fileSize != fileSize || rec->mtime != (int64_t)mtime || !cdirChecksum || rec->cdirChecksum != cdirChecksum || rec->numFiles != numFiles ) {
+				return NULL;
+			}
+
+			// make sure it can't point outside itself
+			const pk3IndexFile_t *files = PK3INDEX_FILES( rec );
+			const char *names = PK3INDEX_NAMES( rec );
+			if ( rec->numHeaderLongs < 0 || rec->numHeaderLongs > numFiles || rec->namesSize <= 0
+				|| PK3INDEX_RECORDSIZE( rec->numHeaderLongs, numFiles, rec->namesSize ) > rec->recordSize
+				|| names[rec->namesSize - 1] ) {
+				return NULL;
+			}
+			for ( int i = 0; i < numFiles; i++ ) {
+				if ( files[i].nameOfs >= (uint32_t)rec->namesSize ) {
+					return NULL;
+				}
+			}
+
+			fs_pakIndexCursor = ofs;
+			return rec;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+=================
+FS_SortPakFiles
+
+Sorts the names in a pack so everything under a directory is one range
+=================
+*/
+static int FS_CompareFileInPack( const void *a, const void *b ) {
+	return strcmp( (*(const fileInPack_t **)a)->name, (*(const fileInPack_t **)b)->name );
+}
+
+static void FS_SortPakFiles( pack_t *pack )
+{
+	pack->sortedFiles = (fileInPack_t **)Z_Malloc( pack->numfiles * sizeof( *pack->sortedFiles ), TAG_FILESYS, qfalse );
+	pack->numSortedFiles = 0;
+
+	for ( int i = 0; i < pack->numfiles; i++ ) {
+		// a damaged directory leaves the rest unnamed
+		if ( pack->buildBuffer[i].name ) {
+			pack->sortedFiles[pack->numSortedFiles++] = &pack->buildBuffer[i];
+		}
+	}
+
+	qsort( pack->sortedFiles, pack->numSortedFiles, sizeof( *pack->sortedFiles ), FS_CompareFileInPack );
+}
+
+/*
+=================
+FS_PakPrefixRange
+
+Finds the sortedFiles starting with a lower case prefix
+=================
+*/
+static void FS_PakPrefixRange( const pack_t *pack, const char *prefix, int prefixLen, int *first, int *last )
+{
+	int lo, hi, mid;
+
+	lo = 0;
+	hi = pack->numSortedFiles;
+	while ( lo < hi ) {
+		mid = (lo + hi) / 2;
+		if ( strncmp( pack->sortedFiles[mid]->name, prefix, prefixLen ) < 0 ) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	*first = lo;
+
+	hi = pack->numSortedFiles;
+	while ( lo < hi ) {
+		mid = (lo + hi) / 2;
+		if ( strncmp( pack->sortedFiles[mid]->name, prefix, prefixLen ) <= 0 ) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	*last = lo;
+}
+
 /*
 =================
 FS_LoadZipFile
@@ -2187,6 +2622,9 @@ static pack_t *FS_LoadZipFile( const char *zipfile, const char *basename )
 	int				fs_numHeaderLongs;
 	int				*fs_headerLongs;
 	char			*namePtr;
+	int				fileSize, cdirChecksum;
+	time_t			mtime;
+	const pk3IndexPak_t	*index;
 
 	fs_numHeaderLongs = 0;
 
@@ -2196,16 +2634,27 @@ static pack_t *FS_LoadZipFile( const char *zipfile, const char *basename )
 	if (err != UNZ_OK)
 		return NULL;
 
-	len = 0;
+	// the central directory starts at the first entry
 	unzGoToFirstFile(uf);
-	for (i = 0; i < gi.number_entry; i++)
-	{
-		err = unzGetCurrentFileInfo(uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0);
-		if (err != UNZ_OK) {
-			break;
+	if ( !Sys_FileStat( zipfile, &fileSize, &mtime ) ) {
+		fileSize = -1;
+	}
+	cdirChecksum = FS_CentralDirChecksum( zipfile, unzGetOffset(uf), fileSize );
+	index = FS_FindPakIndex( zipfile, fileSize, mtime, cdirChecksum, gi.number_entry );
+
+	len = 0;
+	if ( index ) {
+		len = index->namesSize;
+	} else {
+		for (i = 0; i < gi.number_entry; i++)
+		{
+			err = unzGetCurrentFileInfo(uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0);
+			if (err != UNZ_OK) {
+				break;
+			}
+			len += strlen(filename_inzip) + 1;
+			unzGoToNextFile(uf);
 		}
-		len += strlen(filename_inzip) + 1;
-		unzGoToNextFile(uf);
 	}
 
 	buildBuffer = (struct fileInPack_s *)Z_Malloc( (gi.number_entry * sizeof( fileInPack_t )) + len, TAG_FILESYS, qtrue );
@@ -2238,28 +2687,55 @@ static pack_t *FS_LoadZipFile( const char *zipfile, const char *basename )
 
 	pack->handle = uf;
 	pack->numfiles = gi.number_entry;
-	unzGoToFirstFile(uf);
 
-	for (i = 0; i < gi.number_entry; i++)
-	{
-		err = unzGetCurrentFileInfo(uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0);
-		if (err != UNZ_OK) {
-			break;
+	if ( index ) {
+		// everything the loop below would read is in the index
+		const pk3IndexFile_t *files = PK3INDEX_FILES( index );
+
+		Com_Memcpy( namePtr, PK3INDEX_NAMES( index ), index->namesSize );
+		Com_Memcpy( &fs_headerLongs[ fs_numHeaderLongs ], PK3INDEX_CRCS( index ), index->numHeaderLongs * sizeof(*fs_headerLongs) );
+		fs_numHeaderLongs += index->numHeaderLongs;
+
+		for (i = 0; i < gi.number_entry; i++)
+		{
+			hash = files[i].hash & (pack->hashSize - 1);
+			buildBuffer[i].name = namePtr + files[i].nameOfs;
+			buildBuffer[i].pos = files[i].pos;
+			buildBuffer[i].len = files[i].len;
+			buildBuffer[i].next = pack->hashTable[hash];
+			pack->hashTable[hash] = &buildBuffer[i];
 		}
-		if (file_info.uncompressed_size > 0) {
-			fs_headerLongs[fs_numHeaderLongs++] = LittleLong(file_info.crc);
+		fs_paksFromIndex++;
+	} else {
+		unzGoToFirstFile(uf);
+
+		for (i = 0; i < gi.number_entry; i++)
+		{
+			err = unzGetCurrentFileInfo(uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0);
+			if (err != UNZ_OK) {
+				break;
+			}
+			if (file_info.uncompressed_size > 0) {
+				fs_headerLongs[fs_numHeaderLongs++] = LittleLong(file_info.crc);
+			}
+			Q_strlwr( filename_inzip );
+			hash = FS_HashFileName(filename_inzip, pack->hashSize);
+			buildBuffer[i].name = namePtr;
+			strcpy( buildBuffer[i].name, filename_inzip );
+			namePtr += strlen(filename_inzip) + 1;
+			// store the file position in the zip
+			buildBuffer[i].pos = unzGetOffset(uf);
+			buildBuffer[i].len = file_info.uncompressed_size;
+			buildBuffer[i].next = pack->hashTable[hash];
+			pack->hashTable[hash] = &buildBuffer[i];
+			unzGoToNextFile(uf);
+		}
+
+		// a damaged directory can't go in the index
+		if ( i < gi.number_entry ) {
+			cdirChecksum = 0;
 		}
-		Q_strlwr( filename_inzip );
-		hash = FS_HashFileName(filename_inzip, pack->hashSize);
-		buildBuffer[i].name = namePtr;
-		strcpy( buildBuffer[i].name, filename_inzip );
-		namePtr += strlen(filename_inzip) + 1;
-		// store the file position in the zip
-		buildBuffer[i].pos = unzGetOffset(uf);
-		buildBuffer[i].len = file_info.uncompressed_size;
-		buildBuffer[i].next = pack->hashTable[hash];
-		pack->hashTable[hash] = &buildBuffer[i];
-		unzGoToNextFile(uf);
+		fs_paksParsed++;
 	}
 
 	pack->checksum = Com_BlockChecksum( &fs_headerLongs[ 1 ], sizeof(*fs_headerLongs) * ( fs_numHeaderLongs - 1 ) );
@@ -2267,9 +2743,54 @@ static pack_t *FS_LoadZipFile( const char *zipfile, const char *basename )
 	pack->checksum = LittleLong( pack->checksum );
 	pack->pure_checksum = LittleLong( pack->pure_checksum );
 
-	Z_Free(fs_headerLongs);
+	// keep the crcs so the pure checksum can be redone for another feed
+	pack->headerLongs = fs_headerLongs;
+	pack->numHeaderLongs = fs_numHeaderLongs;
+	pack->fileSize = fileSize;
+	pack->mtime = mtime;
+	pack->cdirChecksum = cdirChecksum;
 
 	pack->buildBuffer = buildBuffer;
+	FS_SortPakFiles( pack );
+	return pack;
+}
+
+/*
+=================
+FS_ReuseZipFile
+
+Takes a pack indexed before the last FS_Restart if the file is
+unchanged, so only the feed dependent pure checksum is redone
+=================
+*/
+static pack_t *FS_ReuseZipFile( const char *zipfile )
+{
+	pack_t	*pack, **prev;
+	int		fileSize;
+	time_t	mtime;
+
+	if ( !fs_parkedPaks || !Sys_FileStat( zipfile, &fileSize, &mtime ) ) {
+		return NULL;
+	}
+
+	for ( prev = &fs_parkedPaks; (pack = *prev) != NULL; prev = &pack->nextParked ) {
+		if ( Sys_PathCmp( pack->pakFilename, zipfile ) ) {
+			break;
+		}
+	}
+
+	if ( !pack || pack->fileSize != fileSize || pack->mtime != mtime ) {
+		return NULL;
+	}
+
+	*prev = pack->nextParked;
+	pack->nextParked = NULL;
+	pack->referenced = 0;
+
+	pack->headerLongs[0] = LittleLong( fs_checksumFeed );
+	pack->pure_checksum = Com_BlockChecksum( pack->headerLongs, sizeof(*pack->headerLongs) * pack->numHeaderLongs );
+	pack->pure_checksum = LittleLong( pack->pure_checksum );
+
 	return pack;
 }
 
@@ -2284,10 +2805,243 @@ Frees a pak structure and releases all associated resources
 void FS_FreePak(pack_t *thepak)
 {
 	unzClose(thepak->handle);
+	Z_Free(thepak->headerLongs);
+	Z_Free(thepak->sortedFiles);
 	Z_Free(thepak->buildBuffer);
 	Z_Free(thepak);
 }
 
+/*
+=================
+FS_FreeParkedPaks
+
+Frees the packs FS_Restart didn't pick up again
+=================
+*/
+static void FS_FreeParkedPaks( void )
+{
+	pack_t *pack;
+
+	while ( (pack = fs_parkedPaks) != NULL ) {
+		fs_parkedPaks = pack->nextParked;
+		FS_FreePak( pack );
+	}
+}
+
+/*
+=================
+FS_OpenPakIndex
+
+Maps the pk3 index for FS_LoadZipFile while the search path is built
+=================
+*/
+static void FS_OpenPakIndex( void )
+{
+	const pk3IndexHeader_t	*header;
+	FILE					*f;
+	int						size;
+
+	fs_pakIndex = NULL;
+	fs_pakIndexSize = 0;
+	fs_pakIndexCursor = sizeof( pk3IndexHeader_t );
+
+	if ( !fs_indexCache->integer ) {
+		return;
+	}
+
+	f = fopen( FS_BuildOSPath( fs_homepath->string, BASEGAME, PK3INDEX_FILE ), "rb" );
+	if ( !f ) {
+		return;
+	}
+
+	fseek( f, 0, SEEK_END );
+	size = (int)ftell( f );
+	if ( size > (int)sizeof( *header ) ) {
+		fs_pakIndex = (byte *)Sys_MapFile( f, size );
+		fs_pakIndexSize = size;
+	}
+	fclose( f );
+
+	if ( !fs_pakIndex ) {
+		return;
+	}
+
+	header = (const pk3IndexHeader_t *)fs_pakIndex;
+	if ( header->ident != PK3INDEX_IDENT || header->version != PK3INDEX_VERSION || header->recordHeaderSize != (int)sizeof( pk3IndexPak_t ) ) {
+		Com_DPrintf( "Ignoring outdated %s\n", PK3INDEX_FILE );
+		Sys_UnmapFile( fs_pakIndex, fs_pakIndexSize );
+		fs_pakIndex = NULL;
+	}
+}
+
+/*
+=================
+FS_ClosePakIndex
+=================
+*/
+static void FS_ClosePakIndex( void )
+{
+	if ( fs_pakIndex ) {
+		Sys_UnmapFile( fs_pakIndex, fs_pakIndexSize );
+		fs_pakIndex = NULL;
+	}
+}
+
+/*
+=================
+FS_UnusedPakIndex
+
+Records in the mapped index for packs that aren't in the search path, such as
+those of another fs_game, that still match the zip on disk
+=================
+*/
+static void FS_UnusedPakIndex( const std::vector<pack_t *> &paks, std::vector<const pk3IndexPak_t *> &unused )
+{
+	const pk3IndexPak_t	*rec;
+	int					ofs, fileSize;
+	time_t				mtime;
+
+	if ( !fs_pakIndex ) {
+		return;
+	}
+
+	for ( ofs = sizeof( pk3IndexHeader_t ); ofs < fs_pakIndexSize; ofs += rec->recordSize ) {
+		rec = (const pk3IndexPak_t *)(fs_pakIndex + ofs);
+		if ( fs_pakIndexSize - ofs < (int)sizeof( *rec ) || rec->recordSize < (int)sizeof( *rec ) || rec->recordSize > fs_pakIndexSize - ofs ) {
+			break;
+		}
+
+		if ( rec->numFiles < 0 || rec->numHeaderLongs < 0 || rec->numHeaderLongs > rec->numFiles || rec->namesSize <= 0
+			|| PK3INDEX_RECORDSIZE( rec->numHeaderLongs, rec->numFiles, rec->namesSize ) > rec->recordSize
+			|| !memchr( rec->pakFilename, 0, sizeof( rec->pakFilename ) ) ) {
+			continue;
+		}
+
+		// the loaded packs have just been rewritten, and only the first record for a zip is ever used
+		bool seen = false;
+		for ( pack_t *pak : paks ) {
+			seen = seen || Sys_PathCmp( pak->pakFilename, rec->pakFilename );
+		}
+		for ( const pk3IndexPak_t *other : unused ) {
+			seen = seen || Sys_PathCmp( other->pakFilename, rec->pakFilename );
+		}
+		if ( seen ) {
+			continue;
+		}
+
+		// the next FS_FindPakIndex would throw it away anyway
+		if ( !Sys_FileStat( rec->pakFilename, &fileSize, &mtime ) || rec->fileSize != fileSize || rec->mtime != (int64_t)mtime ) {
+			continue;
+		}
+
+		unused.push_back( rec );
+	}
+}
+
+/*
+=================
+FS_WritePakIndex
+
+Replaces the pk3 index with the directories of every pack in the search path,
+keeping the records of other packs that are still good
+=================
+*/
+static void FS_WritePakIndex( void )
+{
+	std::vector<pack_t *>	paks;
+	std::vector<const pk3IndexPak_t *>	unused;
+	std::vector<byte>		record;
+	searchpath_t			*search;
+	pk3IndexHeader_t		header;
+	char					path[MAX_OSPATH], tmpPath[MAX_OSPATH];
+	FILE					*f;
+
+	for ( search = fs_searchpaths; search; search = search->next ) {
+		if ( search->pack && search->pack->cdirChecksum ) {
+			paks.push_back( search->pack );
+		}
+	}
+	FS_UnusedPakIndex( paks, unused );
+
+	// another instance sharing the home path may be writing at the same time
+	Q_strncpyz( path, FS_BuildOSPath( fs_homepath->string, BASEGAME, PK3INDEX_FILE ), sizeof( path ) );
+	Com_sprintf( tmpPath, sizeof( tmpPath ), "%s.%d.tmp", path, Sys_PID() );
+
+	FS_CreatePath( tmpPath );
+	f = fopen( tmpPath, "wb" );
+	if ( !f ) {
+		Com_DPrintf( "Couldn't write %s\n", tmpPath );
+		return;
+	}
+
+	header.ident = PK3INDEX_IDENT;
+	header.version = PK3INDEX_VERSION;
+	header.recordHeaderSize = sizeof( pk3IndexPak_t );
+	header.numPaks = (int)(paks.size() + unused.size());
+	fwrite( &header, sizeof( header ), 1, f );
+
+	// the search path is in reverse load order
+	for ( auto it = paks.rbegin(); it != paks.rend(); ++it ) {
+		pack_t *pak = *it;
+		const char *names = (const char *)(pak->buildBuffer + pak->numfiles);
+		int namesSize = 0;
+
+		for ( int i = 0; i < pak->numfiles; i++ ) {
+			namesSize = Q_max( namesSize, (int)(pak->buildBuffer[i].name - names + strlen( pak->buildBuffer[i].name ) + 1) );
+		}
+
+		record.assign( PK3INDEX_RECORDSIZE( pak->numHeaderLongs - 1, pak->numfiles, namesSize ), 0 );
+
+		pk3IndexPak_t *rec = (pk3IndexPak_t *)record.data();
+		rec->recordSize = (int)record.size();
+		rec->fileSize = pak->fileSize;
+		rec->mtime = (int64_t)pak->mtime;
+		rec->cdirChecksum = pak->cdirChecksum;
+		rec->numFiles = pak->numfiles;
+		rec->numHeaderLongs = pak->numHeaderLongs - 1;
+		rec->namesSize = namesSize;
+		Q_strncpyz( rec->pakFilename, pak->pakFilename, sizeof( rec->pakFilename ) );
+
+		Com_Memcpy( (int32_t *)PK3INDEX_CRCS( rec ), &pak->headerLongs[1], rec->numHeaderLongs * sizeof( int32_t ) );
+
+		pk3IndexFile_t *files = (pk3IndexFile_t *)PK3INDEX_FILES( rec );
+		for ( int i = 0; i < pak->numfiles; i++ ) {
+			files[i].pos = (uint32_t)pak->buildBuffer[i].pos;
+			files[i].len = (uint32_t)pak->buildBuffer[i].len;
+			files[i].hash = (uint32_t)FS_HashFileName( pak->buildBuffer[i].name, pak->hashSize );
+			files[i].nameOfs = (uint32_t)(pak->buildBuffer[i].name - names);
+		}
+
+		Com_Memcpy( (char *)PK3INDEX_NAMES( rec ), names, namesSize );
+
+		fwrite( record.data(), record.size(), 1, f );
+	}
+
+	// after ours, so FS_FindPakIndex's cursor still runs straight through the loaded ones
+	for ( const pk3IndexPak_t *rec : unused ) {
+		fwrite( rec, rec->recordSize, 1, f );
+	}
+
+	if ( fclose( f ) ) {
+		FS_Remove( tmpPath );
+		return;
+	}
+
+	// windows can't replace the old index while it's mapped
+	FS_ClosePakIndex();
+
+	if ( rename( tmpPath, path ) ) {
+		// windows won't rename over an existing file
+		FS_Remove( path );
+		if ( rename( tmpPath, path ) ) {
+			FS_Remove( tmpPath );
+			return;
+		}
+	}
+
+	Com_DPrintf( "Wrote %d paks to %s\n", header.numPaks, path );
+}
+
 /*
 =================
 FS_GetZipChecksum
@@ -2392,6 +3146,8 @@ char **FS_ListFilteredFiles( const char *path, const char *extension, char *filt
 	pack_t			*pak;
 	fileInPack_t	*buildBuffer;
 	char			zpath[MAX_ZPATH];
+	char			lowerPath[MAX_ZPATH];
+	std::vector<int>	matches;
 
 	if ( !fs_searchpaths ) {
 		Com_Error( ERR_FATAL, "Filesystem call made without initialization\n" );
@@ -2413,6 +3169,10 @@ char **FS_ListFilteredFiles( const char *path, const char *extension, char *filt
 	nfiles = 0;
 	FS_ReturnPath(path, zpath, &pathDepth);
 
+	// pack names are lower case
+	Q_strncpyz( lowerPath, path, sizeof( lowerPath ) );
+	Q_strlwr( lowerPath );
+
 	//
 	// search through the path, one element at a time, adding to list
 	//
@@ -2429,21 +3189,35 @@ char **FS_ListFilteredFiles( const char *path, const char *extension, char *filt
 			// look through all the pak file elements
 			pak = search->pack;
 			buildBuffer = pak->buildBuffer;
-			for (i = 0; i < pak->numfiles; i++) {
-				char	*name;
-				int		zpathLen, depth;
+			if (filter) {
+				for (i = 0; i < pak->numfiles; i++) {
+					char	*name;
 
-				// check for directory match
-				name = buildBuffer[i].name;
-				//
-				if (filter) {
+					name = buildBuffer[i].name;
 					// case insensitive
 					if (!Com_FilterPath( filter, name, qfalse ))
 						continue;
 					// unique the match
 					nfiles = FS_AddFileToList( name, list, nfiles );
 				}
-				else {
+			}
+			else {
+				int first, last;
+
+				// only names starting with the path can match, keep them in pak order
+				FS_PakPrefixRange( pak, lowerPath, Q_min( pathLength, (int)strlen( lowerPath ) ), &first, &last );
+				matches.clear();
+				for (i = first; i < last; i++) {
+					matches.push_back( (int)(pak->sortedFiles[i] - buildBuffer) );
+				}
+				std::sort( matches.begin(), matches.end() );
+
+				for (int match : matches) {
+					char	*name;
+					int		zpathLen, depth;
+
+					// check for directory match
+					name = buildBuffer[match].name;
 
 					zpathLen = FS_ReturnPath(name, zpath, &depth);
 
@@ -3132,8 +3906,13 @@ static void FS_AddGameDirectory( const char *path, const char *dir ) {
 
 	for ( i = 0 ; i < numfiles ; i++ ) {
 		pakfile = FS_BuildOSPath( path, dir, sorted[i] );
-		if ( ( pak = FS_LoadZipFile( pakfile, sorted[i] ) ) == 0 )
+		if ( ( pak = FS_ReuseZipFile( pakfile ) ) != NULL ) {
+			fs_paksReused++;
+		} else if ( ( pak = FS_LoadZipFile( pakfile, sorted[i] ) ) != NULL ) {
+			fs_paksLoaded++;
+		} else {
 			continue;
+		}
 		Q_strncpyz(pak->pakPathname, curpath, sizeof(pak->pakPathname));
 		// store the game name for downloading
 		Q_strncpyz(pak->pakGamename, dir, sizeof(pak->pakGamename));
@@ -3361,12 +4140,20 @@ void FS_Shutdown( qboolean closemfp ) {
 		}
 	}
 
-	// free everything
+	// the log writer mustn't touch a file until we're back up
+	Com_LogPark( qtrue );
+
+	// free everything, except the packs a restart can pick up again
 	for ( p = fs_searchpaths ; p ; p = next ) {
 		next = p->next;
 
 		if ( p->pack ) {
-			FS_FreePak( p->pack );
+			if ( closemfp ) {
+				FS_FreePak( p->pack );
+			} else {
+				p->pack->nextParked = fs_parkedPaks;
+				fs_parkedPaks = p->pack;
+			}
 		}
 		if ( p->dir ) {
 			Z_Free( p->dir );
@@ -3377,11 +4164,17 @@ void FS_Shutdown( qboolean closemfp ) {
 	// any FS_ calls will now be an error until reinitialized
 	fs_searchpaths = NULL;
 
+	if ( closemfp ) {
+		FS_FreeParkedPaks();
+		FS_PruneFileCache();
+	}
+
 	Cmd_RemoveCommand( "path" );
 	Cmd_RemoveCommand( "dir" );
 	Cmd_RemoveCommand( "fdir" );
 	Cmd_RemoveCommand( "touchFile" );
 	Cmd_RemoveCommand( "which" );
+	Cmd_RemoveCommand( "fs_cachestats" );
 
 #ifdef FS_MISSING
 	if (closemfp) {
@@ -3475,6 +4268,10 @@ void FS_Startup( const char *gameName ) {
 	Com_Printf( "----- FS_Startup -----\n" );
 
 	fs_packFiles = 0;
+	fs_paksReused = 0;
+	fs_paksLoaded = 0;
+	fs_paksFromIndex = 0;
+	fs_paksParsed = 0;
 
 	fs_debug = Cvar_Get( "fs_debug", "0", 0 );
 	fs_copyfiles = Cvar_Get( "fs_copyfiles", "0", CVAR_INIT );
@@ -3489,6 +4286,10 @@ void FS_Startup( const char *gameName ) {
 	fs_gamedirvar = Cvar_Get ("fs_game", "", CVAR_INIT|CVAR_SYSTEMINFO, "Mod directory" );
 
 	fs_dirbeforepak = Cvar_Get("fs_dirbeforepak", "0", CVAR_INIT|CVAR_PROTECTED, "Prioritize directories before paks if not pure" );
+	fs_indexCache = Cvar_Get("fs_indexCache", "1", CVAR_INIT|CVAR_PROTECTED, "Keep an index of pk3 contents in the home path for faster startup" );
+	fs_fileCacheSize = Cvar_Get("fs_fileCacheSize", "8", 0, "Megabytes of decompressed pk3 files kept in memory, 0 to disable" );
+
+	FS_OpenPakIndex();
 
 	// add search path elements in reverse priority order (lowest priority first)
 	if (fs_cdpath->string[0]) {
@@ -3539,12 +4340,23 @@ void FS_Startup( const char *gameName ) {
 		}
 	}
 
+	// anything that had to be parsed goes in the index for next time
+	Com_DPrintf( "%d paks from %s, %d parsed\n", fs_paksFromIndex, PK3INDEX_FILE, fs_paksParsed );
+	if ( fs_indexCache->integer && fs_paksParsed ) {
+		FS_WritePakIndex();
+	}
+	FS_ClosePakIndex();
+
+	// the log writer can write out what was queued while we were down
+	Com_LogPark( qfalse );
+
 	// add our commands
 	Cmd_AddCommand ("path", FS_Path_f, "Lists search paths" );
 	Cmd_AddCommand ("dir", FS_Dir_f, "Lists a folder" );
 	Cmd_AddCommand ("fdir", FS_NewDir_f, "Lists a folder with filters" );
 	Cmd_AddCommand ("touchFile", FS_TouchFile_f, "Touches a file" );
 	Cmd_AddCommand ("which", FS_Which_f, "Determines which search path a file was loaded from" );
+	Cmd_AddCommand ("fs_cachestats", FS_CacheStats_f, "Prints decompressed file cache statistics" );
 
 	// https://zerowing.idsoftware.com/bugzilla/show_bug.cgi?id=506
 	// reorder the pure pk3 files according to server order
@@ -3942,8 +4754,9 @@ FS_Restart
 ================
 */
 void FS_Restart( int checksumFeed ) {
+	int start = Sys_Milliseconds();
 
-	// free anything we currently have loaded
+	// free anything we currently have loaded, keeping the pack indexes around
 	FS_Shutdown(qfalse);
 
 	// set the checksum feed
@@ -3955,6 +4768,12 @@ void FS_Restart( int checksumFeed ) {
 	// try to start up normally
 	FS_Startup( BASEGAME );
 
+	// whatever wasn't reused is gone or changed on disk
+	FS_FreeParkedPaks();
+	FS_PruneFileCache();
+
+	Com_Printf( "FS_Restart: %d paks reused, %d indexed in %d msec\n", fs_paksReused, fs_paksLoaded, Sys_Milliseconds() - start );
+
 	// if we can't find default.cfg, assume that the paths are
 	// busted and error out now, rather than getting an unreadable
 	// graphics screen when the font fails to load
@@ -0,0 +1,208 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// loadprofile.cpp -- nested timing scopes for a level load, printed as a tree
+// when the load finishes and appended to loadprofile.log, one line per scope
+
+#include "qcommon/qcommon.h"
+
+#include <chrono>
+
+#define MAX_LOAD_SCOPES		512
+#define MAX_LOAD_DEPTH		32
+#define LOAD_PROFILE_FILE	"loadprofile.log"
+
+typedef struct loadScope_s {
+	char		name[64];
+	int			parent;			// -1 for the root
+	int			depth;
+	int			calls;			// scopes with the same name and parent are merged
+	long long	usec;
+	long long	startUsec;		// of the open call
+} loadScope_t;
+
+static cvar_t		*com_loadProfile;
+
+static loadScope_t	loadScopes[MAX_LOAD_SCOPES];
+static int			numLoadScopes;
+static int			loadStack[MAX_LOAD_DEPTH];
+static int			loadDepth;
+static int			loadOverflow;	// scopes entered past the limits, their leaves are ignored
+static char			loadLabel[MAX_QPATH];
+static qboolean		loadActive;
+
+static long long LoadProfile_Usec( void ) {
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static int LoadProfile_FindScope( int parent, const char *name ) {
+	for ( int i = parent + 1; i < numLoadScopes; i++ ) {
+		if ( loadScopes[i].parent == parent && !Q_stricmp( loadScopes[i].name, name ) ) {
+			return i;
+		}
+	}
+
+	if ( numLoadScopes == MAX_LOAD_SCOPES ) {
+		return -1;
+	}
+
+	loadScope_t *scope = &loadScopes[numLoadScopes];
+	Q_strncpyz( scope->name, name, sizeof( scope->name ) );
+	scope->parent = parent;
+	scope->depth = parent < 0 ? 0 : loadScopes[parent].depth + 1;
+	scope->calls = 0;
+	scope->usec = 0;
+	return numLoadScopes++;
+}
+
+qboolean Com_LoadProfileActive( void ) {
+	return loadActive;
+}
+
+void Com_LoadProfileBegin( const char *root, const char *label ) {
+	if ( !com_loadProfile ) {
+		com_loadProfile = Cvar_Get( "com_loadProfile", "1", CVAR_ARCHIVE_ND, "Time each level load and append the breakdown to " LOAD_PROFILE_FILE );
+	}
+
+	// a load still waiting on clients is finished off, anything left from
+	// one that errored out is thrown away
+	if ( loadActive && loadDepth == 1 ) {
+		Com_LoadProfileEnd();
+	}
+
+	numLoadScopes = 0;
+	loadDepth = 0;
+	loadOverflow = 0;
+	loadActive = qfalse;
+
+	if ( !com_loadProfile->integer ) {
+		return;
+	}
+
+	Q_strncpyz( loadLabel, label, sizeof( loadLabel ) );
+	loadActive = qtrue;
+	Com_LoadScopeEnter( root );
+}
+
+void Com_LoadScopeEnter( const char *name ) {
+	int index;
+
+	if ( !loadActive ) {
+		return;
+	}
+
+	if ( loadOverflow || loadDepth == MAX_LOAD_DEPTH || (index = LoadProfile_FindScope( loadDepth ? loadStack[loadDepth-1] : -1, name )) < 0 ) {
+		loadOverflow++;
+		return;
+	}
+
+	loadScopes[index].calls++;
+	loadScopes[index].startUsec = LoadProfile_Usec();
+	loadStack[loadDepth++] = index;
+}
+
+void Com_LoadScopeLeave( void ) {
+	if ( !loadActive ) {
+		return;
+	}
+
+	if ( loadOverflow ) {
+		loadOverflow--;
+		return;
+	}
+
+	// the root is only closed by Com_LoadProfileEnd
+	if ( loadDepth > 1 ) {
+		loadScope_t *scope = &loadScopes[loadStack[--loadDepth]];
+		scope->usec += LoadProfile_Usec() - scope->startUsec;
+	}
+}
+
+int Com_LoadProfileElapsed( void ) {
+	if ( !loadActive || !loadDepth ) {
+		return 0;
+	}
+
+	return (int)(( LoadProfile_Usec() - loadScopes[loadStack[0]].startUsec ) / 1000);
+}
+
+static void LoadProfile_PrintScope( int index, fileHandle_t f, time_t now, const char *parentPath ) {
+	const loadScope_t *scope = &loadScopes[index];
+	char path[MAX_STRING_CHARS];
+
+	Com_Printf( "%*s%-*s %9.2f msec", scope->depth * 2, "", 40 - scope->depth * 2, scope->name, scope->usec / 1000.0 );
+	if ( scope->calls > 1 ) {
+		Com_Printf( " (%d calls)", scope->calls );
+	}
+	Com_Printf( "\n" );
+
+	if ( parentPath ) {
+		Com_sprintf( path, sizeof( path ), "%s/%s", parentPath, scope->name );
+	} else {
+		Q_strncpyz( path, scope->name, sizeof( path ) );
+	}
+
+	if ( f ) {
+		FS_Printf( f, "%lld\t%s\t%s\t%d\t%.3f\n", (long long)now, loadLabel, path, scope->calls, scope->usec / 1000.0 );
+	}
+
+	for ( int i = index + 1; i < numLoadScopes; i++ ) {
+		if ( loadScopes[i].parent == index ) {
+			LoadProfile_PrintScope( i, f, now, path );
+		}
+	}
+}
+
+/*
+Closes every open scope, prints the tree and appends it to the log as
+"<unix time> <label> <scope path> <calls> <msec>", tab separated
+*/
+void Com_LoadProfileEnd( void ) {
+	fileHandle_t f = 0;
+	long long now;
+
+	if ( !loadActive ) {
+		return;
+	}
+
+	loadOverflow = 0;
+	now = LoadProfile_Usec();
+	while ( loadDepth ) {
+		loadScope_t *scope = &loadScopes[loadStack[--loadDepth]];
+		scope->usec += now - scope->startUsec;
+	}
+	loadActive = qfalse;
+
+	if ( !numLoadScopes ) {
+		return;
+	}
+
+	FS_FOpenFileByMode( LOAD_PROFILE_FILE, &f, FS_APPEND );
+
+	Com_Printf( "------ Load profile: %s ------\n", loadLabel );
+	LoadProfile_PrintScope( 0, f, time( NULL ), NULL );
+	if ( numLoadScopes == MAX_LOAD_SCOPES ) {
+		Com_Printf( "(more than %d scopes, the rest weren't timed)\n", MAX_LOAD_SCOPES );
+	}
+
+	if ( f ) {
+		FS_FCloseFile( f );
+	}
+}
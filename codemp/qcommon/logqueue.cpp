@@ -0,0 +1,463 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// logqueue.cpp -- log lines are queued by any thread and written to their
+// files by a background thread, so a flood of prints never waits on the disk
+
+#include "qcommon/qcommon.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define LOG_QUEUE_SIZE		8192	// must be a power of two
+#define LOG_QUEUE_MASK		(LOG_QUEUE_SIZE-1)
+#define LOG_WAKE_MSEC		100		// producers don't take a lock to wake the writer, so poll too
+
+typedef struct logEntry_s {
+	std::atomic<unsigned>	sequence;
+	int						channel;
+	int						level;
+	long long				timeMsec;	// wall clock, for JSON output
+	char					*text;
+	int						len;
+} logEntry_t;
+
+// bounded multi-producer queue, each slot's sequence tells producers and the
+// writer whose turn it is without any locking
+static logEntry_t				logQueue[LOG_QUEUE_SIZE];
+static std::atomic<unsigned>	logEnqueuePos;
+static std::atomic<unsigned>	logDequeuePos;
+
+static std::atomic<fileHandle_t>	logFiles[LOGCHAN_MAX];
+static std::atomic<int>				logDropped[LOGCHAN_MAX];	// not yet reported in the file
+static std::atomic<int>				logDroppedTotal[LOGCHAN_MAX];
+static std::atomic<int>				logWritten[LOGCHAN_MAX];
+
+static std::thread				*logThread;
+static std::atomic<bool>		logRunning;
+static std::atomic<bool>		logQuit;
+static std::atomic<bool>		logPending;
+static bool						logParked;	// the filesystem is down, under logWriteLock
+static std::mutex				logWakeLock;
+static std::condition_variable	logWake;
+
+// held by whoever is writing entries out, so a file is never closed mid-write
+static std::mutex				logWriteLock;
+
+static cvar_t	*com_logLevel[LOGCHAN_MAX];
+static cvar_t	*com_logFormat;
+
+static const char *logChannelNames[LOGCHAN_MAX] = { "console", "game", "security" };
+static const char *logLevelNames[] = { "error", "warning", "info", "debug" };
+
+/*
+==================
+Com_LogEnqueue
+==================
+*/
+static qboolean Com_LogEnqueue( int channel, int level, const char *text, int len ) {
+	logEntry_t	*entry;
+	unsigned	pos;
+	int			diff;
+
+	pos = logEnqueuePos.load( std::memory_order_relaxed );
+	for ( ;; ) {
+		entry = &logQueue[pos & LOG_QUEUE_MASK];
+		diff = (int)( entry->sequence.load( std::memory_order_acquire ) - pos );
+		if ( diff == 0 ) {
+			if ( logEnqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+				break;
+		} else if ( diff < 0 ) {
+			return qfalse; // full
+		} else {
+			pos = logEnqueuePos.load( std::memory_order_relaxed );
+		}
+	}
+
+	entry->channel = channel;
+	entry->level = level;
+	entry->timeMsec = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch() ).count();
+	entry->text = (char *)malloc( len );
+	entry->len = entry->text ? len : 0;
+	if ( entry->text )
+		memcpy( entry->text, text, len );
+
+	entry->sequence.store( pos + 1, std::memory_order_release );
+	return qtrue;
+}
+
+/*
+==================
+Com_LogDequeue
+
+The caller frees out->text
+==================
+*/
+static qboolean Com_LogDequeue( logEntry_t *out ) {
+	logEntry_t	*entry;
+	unsigned	pos;
+	int			diff;
+
+	pos = logDequeuePos.load( std::memory_order_relaxed );
+	for ( ;; ) {
+		entry = &logQueue[pos & LOG_QUEUE_MASK];
+		diff = (int)( entry->sequence.load( std::memory_order_acquire ) - ( pos + 1 ) );
+		if ( diff == 0 ) {
+			if ( logDequeuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+				break;
+		} else if ( diff < 0 ) {
+			return qfalse; // empty
+		} else {
+			pos = logDequeuePos.load( std::memory_order_relaxed );
+		}
+	}
+
+	out->channel = entry->channel;
+	out->level = entry->level;
+	out->timeMsec = entry->timeMsec;
+	out->text = entry->text;
+	out->len = entry->len;
+
+	entry->sequence.store( pos + LOG_QUEUE_SIZE, std::memory_order_release );
+	return qtrue;
+}
+
+/*
+==================
+Com_LogWriteJSON
+
+One object per line, color codes stripped
+==================
+*/
+static void Com_LogWriteJSON( fileHandle_t f, int channel, int level, long long timeMsec, const char *text, int len ) {
+	static char	line[MAXPRINTMSG * 6 + 256];
+	char		stamp[32];
+	time_t		seconds = (time_t)( timeMsec / 1000 );
+	struct tm	t;
+	int			n, i;
+
+	// gmtime's buffer is shared with the main thread
+#ifdef _WIN32
+	gmtime_s( &t, &seconds );
+#else
+	gmtime_r( &seconds, &t );
+#endif
+	strftime( stamp, sizeof( stamp ), "%Y-%m-%dT%H:%M:%S", &t );
+
+	n = Com_sprintf( line, sizeof( line ), "{\"time\":\"%s.%03dZ\",\"channel\":\"%s\",\"level\":\"%s\",\"msg\":\"",
+		stamp, (int)( timeMsec % 1000 ), logChannelNames[channel], logLevelNames[level] );
+
+	// the record ends the line, so drop the message's own newline
+	if ( len && text[len - 1] == '\n' )
+		len--;
+
+	for ( i = 0; i < len && n < (int)sizeof( line ) - 16; i++ ) {
+		unsigned char c = (unsigned char)text[i];
+
+		if ( Q_IsColorString( text + i ) ) {
+			i++;
+			continue;
+		}
+
+		switch ( c ) {
+		case '"':	line[n++] = '\\'; line[n++] = '"'; break;
+		case '\\':	line[n++] = '\\'; line[n++] = '\\'; break;
+		case '\n':	line[n++] = '\\'; line[n++] = 'n'; break;
+		case '\r':	line[n++] = '\\'; line[n++] = 'r'; break;
+		case '\t':	line[n++] = '\\'; line[n++] = 't'; break;
+		default:
+			if ( c < 0x20 )
+				n += Com_sprintf( line + n, sizeof( line ) - n, "\\u%04x", c );
+			else
+				line[n++] = c;
+			break;
+		}
+	}
+
+	line[n++] = '"';
+	line[n++] = '}';
+	line[n++] = '\n';
+
+	FS_Write( line, n, f );
+}
+
+/*
+==================
+Com_LogWrite
+==================
+*/
+static void Com_LogWrite( int channel, int level, long long timeMsec, const char *text, int len ) {
+	fileHandle_t f = logFiles[channel].load();
+
+	if ( !f || !text )
+		return; // channel was closed while this was queued
+
+	if ( com_logFormat && com_logFormat->integer )
+		Com_LogWriteJSON( f, channel, level, timeMsec, text, len );
+	else
+		FS_Write( text, len, f );
+
+	logWritten[channel]++;
+}
+
+/*
+==================
+Com_LogDrain
+
+Write out everything queued, logWriteLock must be held.  Lines stay queued
+while the writer is parked.
+==================
+*/
+static void Com_LogDrain( void ) {
+	logEntry_t	entry;
+	char		msg[128];
+	int			i, dropped;
+
+	if ( logParked )
+		return;
+
+	while ( Com_LogDequeue( &entry ) ) {
+		Com_LogWrite( entry.channel, entry.level, entry.timeMsec, entry.text, entry.len );
+		free( entry.text );
+	}
+
+	// let whoever reads the file know lines are missing
+	for ( i = 0; i < LOGCHAN_MAX; i++ ) {
+		if ( ( dropped = logDropped[i].exchange( 0 ) ) > 0 ) {
+			Com_sprintf( msg, sizeof( msg ), "WARNING: %d log lines dropped, the log writer fell behind\n", dropped );
+			Com_LogWrite( i, LOGLEVEL_WARNING, std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::system_clock::now().time_since_epoch() ).count(), msg, strlen( msg ) );
+		}
+	}
+}
+
+/*
+==================
+Com_LogThread
+==================
+*/
+static void Com_LogThread( void ) {
+	while ( !logQuit ) {
+		{
+			std::unique_lock<std::mutex> l( logWakeLock );
+			logWake.wait_for( l, std::chrono::milliseconds( LOG_WAKE_MSEC ), [] { return logPending || logQuit; } );
+			logPending = false;
+		}
+
+		std::lock_guard<std::mutex> l( logWriteLock );
+		Com_LogDrain();
+	}
+}
+
+/*
+==================
+Com_LogPrint
+
+Queue text for the file bound to channel.  Returns qfalse if the caller
+should write it itself because nothing is bound or the writer isn't running.
+==================
+*/
+qboolean Com_LogPrint( int channel, int level, const char *text ) {
+	int len;
+
+	if ( channel < 0 || channel >= LOGCHAN_MAX || !logRunning || !logFiles[channel].load() )
+		return qfalse;
+
+	if ( com_logLevel[channel] && level > com_logLevel[channel]->integer )
+		return qtrue;
+
+	len = strlen( text );
+	if ( !len )
+		return qtrue;
+
+	// never block the caller, count what doesn't fit
+	if ( !Com_LogEnqueue( channel, level, text, len ) ) {
+		logDropped[channel]++;
+		logDroppedTotal[channel]++;
+		return qtrue;
+	}
+
+	logPending = true;
+	logWake.notify_one();
+	return qtrue;
+}
+
+/*
+==================
+Com_LogFlush
+
+Block until everything queued is in the files
+==================
+*/
+void Com_LogFlush( void ) {
+	std::lock_guard<std::mutex> l( logWriteLock );
+	Com_LogDrain();
+}
+
+/*
+==================
+Com_LogPark
+
+FS_Shutdown parks the writer before it clears the search paths, when any
+FS_Write would be a fatal error, and FS_Startup lets it go again
+==================
+*/
+void Com_LogPark( qboolean park ) {
+	std::lock_guard<std::mutex> l( logWriteLock );
+
+	if ( park ) {
+		Com_LogDrain();	// last chance to write before the files go away
+		logParked = true;
+	} else {
+		logParked = false;
+		Com_LogDrain();	// whatever piled up meanwhile
+	}
+}
+
+/*
+==================
+Com_LogCrashFlush
+
+Write out the tail of the queue from a crashing thread.  The writer may be
+the thread that crashed, so don't wait on it for long.
+==================
+*/
+void Com_LogCrashFlush( void ) {
+	int i;
+
+	if ( !logRunning )
+		return;
+
+	for ( i = 0; i < 50; i++ ) {
+		if ( logWriteLock.try_lock() ) {
+			Com_LogDrain();
+			logWriteLock.unlock();
+			return;
+		}
+		Sys_Sleep( 1 );
+	}
+
+	Com_LogDrain();
+}
+
+/*
+==================
+Com_LogBind
+
+Route a channel's lines to f, or stop with f == 0.  Anything queued for
+the old file is written out first, under the same lock as the swap so the
+writer can't pick up a line in between.
+==================
+*/
+void Com_LogBind( int channel, fileHandle_t f ) {
+	if ( channel < 0 || channel >= LOGCHAN_MAX )
+		return;
+
+	std::lock_guard<std::mutex> l( logWriteLock );
+	Com_LogDrain();
+	logFiles[channel] = f;
+}
+
+/*
+==================
+Com_LogUnbindFile
+
+Called when any file is closed, in case a channel still writes to it
+==================
+*/
+void Com_LogUnbindFile( fileHandle_t f ) {
+	int i;
+
+	if ( !f )
+		return;
+
+	for ( i = 0; i < LOGCHAN_MAX; i++ ) {
+		if ( logFiles[i].load() == f ) {
+			Com_LogBind( i, 0 );
+		}
+	}
+}
+
+/*
+==================
+Com_LogStats_f
+==================
+*/
+static void Com_LogStats_f( void ) {
+	int i;
+
+	Com_Printf( "log writer %s, %u queued of %d\n", logRunning ? "running" : "stopped",
+		logEnqueuePos.load() - logDequeuePos.load(), LOG_QUEUE_SIZE );
+	for ( i = 0; i < LOGCHAN_MAX; i++ ) {
+		Com_Printf( "%-8s %s %8d written %6d dropped\n", logChannelNames[i], logFiles[i].load() ? "open  " : "closed",
+			logWritten[i].load(), logDroppedTotal[i].load() );
+	}
+}
+
+/*
+==================
+Com_LogInit
+==================
+*/
+void Com_LogInit( void ) {
+	unsigned i;
+
+	com_logLevel[LOGCHAN_CONSOLE] = Cvar_Get( "com_logLevel", "3", CVAR_ARCHIVE_ND, "Most verbose lines written to qconsole.log: 0 errors, 1 warnings, 2 info, 3 developer" );
+	com_logLevel[LOGCHAN_GAME] = Cvar_Get( "com_gameLogLevel", "3", CVAR_ARCHIVE_ND, "Most verbose lines written to g_log: 0 errors, 1 warnings, 2 info, 3 developer" );
+	com_logLevel[LOGCHAN_SECURITY] = Cvar_Get( "com_securityLogLevel", "3", CVAR_ARCHIVE_ND, "Most verbose lines written to the security log: 0 errors, 1 warnings, 2 info, 3 developer" );
+	com_logFormat = Cvar_Get( "com_logFormat", "0", CVAR_ARCHIVE_ND, "Log file format: 0 plain text, 1 JSON lines" );
+	Cmd_AddCommand( "logstats", Com_LogStats_f, "Show the log writer queue and drop counters" );
+
+	if ( logRunning )
+		return;
+
+	for ( i = 0; i < LOG_QUEUE_SIZE; i++ ) {
+		logQueue[i].sequence.store( i, std::memory_order_relaxed );
+	}
+	logEnqueuePos = 0;
+	logDequeuePos = 0;
+
+	logQuit = false;
+	logThread = new std::thread( Com_LogThread );
+	logRunning = true;
+}
+
+/*
+==================
+Com_LogShutdown
+==================
+*/
+void Com_LogShutdown( void ) {
+	if ( !logRunning )
+		return;
+
+	logRunning = false;
+	logQuit = true;
+	logWake.notify_one();
+	logThread->join();
+	delete logThread;
+	logThread = NULL;
+
+	Com_LogFlush();
+}
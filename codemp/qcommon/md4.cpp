@@ -41,7 +41,7 @@ typedef struct mdfour_s {
    It assumes that an int is at least 32 bits long
 */
 
-static  mdfour_ctx *m;
+static thread_local mdfour_ctx *m;
 
 #define F(X,Y,Z) (((X)&(Y)) | ((~(X))&(Z)))
 #define G(X,Y,Z) (((X)&(Y)) | ((X)&(Z)) | ((Y)&(Z)))
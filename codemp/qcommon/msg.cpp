@@ -208,7 +208,10 @@ void MSG_WriteBits( msg_t *msg, int value, int bits ) {
 #ifdef _NEWHUFFTABLE_
 				fwrite(&value, 1, 1, fp);
 #endif // _NEWHUFFTABLE_
-				Huff_offsetTransmit (&msgHuff.compressor, (value&0xff), msg->data, &msg->bit);
+				if ( msg->huffCounts ) {
+					msg->huffCounts[value&0xff]++;
+				}
+				Huff_offsetTransmit (msg->huff ? &msg->huff->compressor : &msgHuff.compressor, (value&0xff), msg->data, &msg->bit);
 				value = (value>>8);
 			}
 		}
@@ -260,7 +263,7 @@ int MSG_ReadBits( msg_t *msg, int bits ) {
 		}
 		if (bits) {
 			for(i=0;i<bits;i+=8) {
-				Huff_offsetReceive (msgHuff.decompressor.tree, &get, msg->data, &msg->bit);
+				Huff_offsetReceive (msg->huff ? msg->huff->decompressor.tree : msgHuff.decompressor.tree, &get, msg->data, &msg->bit);
 #ifdef _NEWHUFFTABLE_
 				fwrite(&get, 1, 1, fp);
 #endif // _NEWHUFFTABLE_
@@ -3083,6 +3086,27 @@ void MSG_initHuffman() {
 
 #endif //._USINGNEWHUFFTABLE_
 
+/*
+=================
+MSG_BuildHuffman
+
+Builds a table the same way on both ends from a set of symbol weights, as
+sent with svc_mapdict. Every weight must be at least 1 so every symbol can
+be sent.
+=================
+*/
+void MSG_BuildHuffman( huffman_t *huff, const byte *weights ) {
+	int i, j;
+
+	Huff_Init( huff );
+	for ( i = 0 ; i < 256 ; i++ ) {
+		for ( j = 0 ; j < weights[i] ; j++ ) {
+			Huff_addRef( &huff->compressor, (byte)i );
+			Huff_addRef( &huff->decompressor, (byte)i );
+		}
+	}
+}
+
 void MSG_shutdownHuffman()
 {
 #ifdef _NEWHUFFTABLE_
@@ -20,6 +20,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "qcommon/qcommon.h"
 
+#include <map>
+#include <string>
+
 typedef struct persisentData_t
 {
 	const void *data;
@@ -92,3 +95,138 @@ const void *PD_Load ( const char *name, size_t *size )
 
 	return data;
 }
+
+/*
+Keyed blobs
+
+Unlike the stores above, which hand a pointer over once, blobs are copied in
+and stay until the process exits or the key is stored again. Each one carries
+the version of its layout and a checksum of the files it was built from, and
+is only given back when both still match, so a module can keep tables it
+parsed from text across map changes and reparse them when the source changes.
+*/
+#define MAX_PERSISTENT_BLOB_MEMORY (64 * 1024 * 1024)
+
+typedef struct persistentBlob_t
+{
+	int version;
+	int sourceChecksum;
+	int size;
+	void *data;
+} persistentBlob_t;
+
+static std::map<std::string, persistentBlob_t> persistentBlobs;
+static int persistentBlobMemory;
+
+static std::string BlobKey ( const char *key )
+{
+	char lower[MAX_QPATH];
+
+	Q_strncpyz (lower, key, sizeof (lower));
+	Q_strlwr (lower);
+
+	return lower;
+}
+
+qboolean PD_StoreBlob ( const char *key, int version, int sourceChecksum, const void *data, int size )
+{
+	if ( !VALIDSTRING (key) || size < 0 || (size && data == NULL) )
+	{
+		return qfalse;
+	}
+
+	persistentBlob_t &blob = persistentBlobs[BlobKey (key)];
+
+	persistentBlobMemory -= blob.size;
+	Z_Free (blob.data);
+	blob.data = NULL;
+	blob.size = 0;
+
+	if ( persistentBlobMemory + size > MAX_PERSISTENT_BLOB_MEMORY )
+	{
+		Com_Printf (S_COLOR_YELLOW "WARNING: No room to keep persistent data \"%s\" (%d bytes).\n", key, size);
+		persistentBlobs.erase (BlobKey (key));
+		return qfalse;
+	}
+
+	blob.version = version;
+	blob.sourceChecksum = sourceChecksum;
+	blob.size = size;
+	blob.data = Z_Malloc (size, TAG_GENERAL, qfalse);
+	memcpy (blob.data, data, size);
+	persistentBlobMemory += size;
+
+	return qtrue;
+}
+
+int PD_LoadBlob ( const char *key, int version, int sourceChecksum, void *buffer, int bufferSize )
+{
+	if ( !VALIDSTRING (key) )
+	{
+		return -1;
+	}
+
+	auto it = persistentBlobs.find (BlobKey (key));
+	if ( it == persistentBlobs.end () )
+	{
+		return -1;
+	}
+
+	persistentBlob_t &blob = it->second;
+	if ( blob.version != version || blob.sourceChecksum != sourceChecksum )
+	{
+		Com_DPrintf ("Persistent data \"%s\" is out of date\n", key);
+
+		persistentBlobMemory -= blob.size;
+		Z_Free (blob.data);
+		persistentBlobs.erase (it);
+		return -1;
+	}
+
+	// the size is returned either way so the caller can tell it didn't fit
+	if ( buffer != NULL && blob.size <= bufferSize )
+	{
+		memcpy (buffer, blob.data, blob.size);
+		Com_DPrintf ("Persistent data \"%s\" reused (%d bytes)\n", key, blob.size);
+	}
+
+	return blob.size;
+}
+
+/*
+Checksum of a file as it would be read now. Files in packs take the checksum
+of their pack, which changes with any file in it, without being read. Loose
+files are read whole, as an mtime can't tell a same-size rewrite within the
+same second or on a filesystem that doesn't keep one. Returns 0, meaning
+don't cache, if the file doesn't exist or can't be read.
+*/
+int PD_FileChecksum ( const char *path )
+{
+	fileHandle_t f;
+	int len = FS_FOpenFileRead (path, &f, qfalse);
+
+	if ( !f )
+	{
+		return 0;
+	}
+
+	int checksum = FS_FileHandlePakChecksum (f);
+	if ( checksum == 0 && len > 0 )
+	{
+		void *buffer = Z_Malloc (len, TAG_TEMP_WORKSPACE, qfalse);
+
+		if ( FS_Read (buffer, len, f) == len )
+		{
+			checksum = (int)Com_BlockChecksum (buffer, len);
+		}
+		Z_Free (buffer);
+	}
+	FS_FCloseFile (f);
+
+	if ( checksum == 0 )
+	{
+		return 0;
+	}
+
+	return checksum ^ len;
+}
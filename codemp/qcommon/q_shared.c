@@ -791,6 +791,104 @@ char *Info_ValueForKey( const char *s, const char *key ) {
 	return "";
 }
 
+static unsigned int Info_HashKey( const char *key ) {
+	unsigned int hash = 0;
+
+	while ( *key ) {
+		hash = hash * 31 + tolower( (unsigned char)*key++ );
+	}
+
+	return hash;
+}
+
+/*
+===============
+Info_BuildIndex
+
+Splits the string into key/value pairs the same way Info_ValueForKey reads
+it. Strings too long for the index, or with more pairs than it holds, leave
+it empty and return qfalse, use Info_ValueForKey on those.
+===============
+*/
+qboolean Info_BuildIndex( infoIndex_t *index, const char *s ) {
+	char	*o;
+
+	index->numPairs = 0;
+	index->buffer[0] = '\0';
+
+	if ( !s ) {
+		return qtrue;
+	}
+
+	if ( strlen( s ) >= sizeof( index->buffer ) ) {
+		return qfalse;
+	}
+
+	Q_strncpyz( index->buffer, s, sizeof( index->buffer ) );
+
+	o = index->buffer;
+	if ( *o == '\\' )
+		o++;
+	while ( *o && index->numPairs < MAX_INFO_PAIRS )
+	{
+		infoPair_t *pair = &index->pairs[index->numPairs];
+
+		pair->key = (unsigned short)(o - index->buffer);
+		while ( *o != '\\' )
+		{
+			if ( !*o )
+				return qtrue;	// a key without a value isn't a pair
+			o++;
+		}
+		*o++ = '\0';
+
+		pair->value = (unsigned short)(o - index->buffer);
+		while ( *o != '\\' && *o )
+			o++;
+		if ( *o )
+			*o++ = '\0';
+
+		pair->hash = Info_HashKey( index->buffer + pair->key );
+		index->numPairs++;
+	}
+
+	// never answer "" for a key past the end of the table
+	if ( *o ) {
+		index->numPairs = 0;
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+===============
+Info_IndexValue
+
+Returns the value for key, or an empty string. The first of duplicate keys
+wins, as with Info_ValueForKey.
+===============
+*/
+const char *Info_IndexValue( const infoIndex_t *index, const char *key ) {
+	unsigned int	hash;
+	int				i;
+
+	if ( !key ) {
+		return "";
+	}
+
+	hash = Info_HashKey( key );
+	for ( i = 0; i < index->numPairs; i++ ) {
+		const infoPair_t *pair = &index->pairs[i];
+
+		if ( pair->hash == hash && !Q_stricmp( index->buffer + pair->key, key ) ) {
+			return index->buffer + pair->value;
+		}
+	}
+
+	return "";
+}
+
 /*
 ===================
 Info_NextPair
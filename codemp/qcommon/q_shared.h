@@ -143,6 +143,13 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 	#define idppc	0
 #endif
 
+// SSE2 intrinsics are always available on x86_64, and on x86 when the compiler targets them
+#if (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(C_ONLY)
+	#define idsse2	1
+#else
+	#define idsse2	0
+#endif
+
 #include "qcommon/q_platform.h"
 
 typedef union fileBuffer_u {
@@ -650,6 +657,21 @@ typedef enum {
 	FS_SEEK_SET
 } fsOrigin_t;
 
+// channels and levels for the background log writer
+typedef enum {
+	LOGCHAN_CONSOLE,	// qconsole.log
+	LOGCHAN_GAME,		// g_log
+	LOGCHAN_SECURITY,	// g_securityLog
+	LOGCHAN_MAX
+} logChannel_t;
+
+typedef enum {
+	LOGLEVEL_ERROR,
+	LOGLEVEL_WARNING,
+	LOGLEVEL_INFO,
+	LOGLEVEL_DEBUG
+} logLevel_t;
+
 //=============================================
 
 // 64-bit integers for global rankings interface
@@ -685,6 +707,26 @@ void Info_SetValueForKey_Big( char *s, const char *key, const char *value );
 qboolean Info_Validate( const char *s );
 qboolean Info_NextPair( const char **s, char *key, char *value );
 
+// an info string split into its pairs once, so repeated lookups neither rescan
+// nor copy it. values point into the index's own copy and stay valid until it
+// is rebuilt. the shortest pair, an empty key and value, takes two bytes, so
+// any string that fits has room for all its pairs
+#define MAX_INFO_PAIRS		(MAX_INFO_STRING/2)
+
+typedef struct infoPair_s {
+	unsigned short	key, value;		// offsets into buffer
+	unsigned int	hash;			// of the lowercased key
+} infoPair_t;
+
+typedef struct infoIndex_s {
+	int			numPairs;
+	infoPair_t	pairs[MAX_INFO_PAIRS];
+	char		buffer[MAX_INFO_STRING];
+} infoIndex_t;
+
+qboolean Info_BuildIndex( infoIndex_t *index, const char *s );
+const char *Info_IndexValue( const infoIndex_t *index, const char *key );
+
 // this is only here so the functions in q_shared.c and bg_*.c can link
 #if defined( _GAME ) || defined( _CGAME ) || defined( UI_BUILD )
 	NORETURN_PTR void (*Com_Error)( int level, const char *error, ... );
@@ -43,6 +43,8 @@ typedef struct msg_s {
 	int		cursize;
 	int		readcount;
 	int		bit;				// for bitwise reads and writes
+	struct huffman_s *huff;		// table for the bitstream, NULL for the standard one
+	int		*huffCounts;		// if set, MSG_WriteBits tallies each symbol it sends here
 } msg_t;
 
 void MSG_Init (msg_t *buf, byte *data, int length);
@@ -240,7 +242,9 @@ enum svc_ops_e {
 	svc_snapshot,
 	svc_setgame,
 	svc_mapchange,
-	svc_EOF
+	svc_EOF,
+	svc_mapdict					// [256 bytes] symbol weights, the rest of the message uses the table built
+								// from them by MSG_BuildHuffman. only sent to clients that ask with "gsdict"
 };
 
 
@@ -613,7 +617,10 @@ fileHandle_t	FS_FOpenFileWrite( const char *qpath, qboolean safe=qtrue );
 int		FS_filelength( fileHandle_t f );
 fileHandle_t FS_SV_FOpenFileWrite( const char *filename );
 int		FS_SV_FOpenFileRead( const char *filename, fileHandle_t *fp );
+void	*FS_SV_MapFile( fileHandle_t f, int size );
+// maps a file opened with FS_SV_FOpenFileRead, release with Sys_UnmapFile
 void	FS_SV_Rename( const char *from, const char *to, qboolean safe );
+void	FS_SV_Remove( const char *filename );
 long		FS_FOpenFileRead( const char *qpath, fileHandle_t *file, qboolean uniqueFILE );
 // if uniqueFILE is true, then a new FILE will be fopened even if the file
 // is found in an already open pak file.  If uniqueFILE is false, you must call
@@ -621,6 +628,11 @@ long		FS_FOpenFileRead( const char *qpath, fileHandle_t *file, qboolean uniqueFI
 // It is generally safe to always set uniqueFILE to true, because the majority of
 // file IO goes through FS_ReadFile, which Does The Right Thing already.
 
+int		FS_FileHandlePakChecksum( fileHandle_t f );
+// checksum of the pack an open file comes from, 0 for files outside packs
+time_t	FS_FileHandleTime( fileHandle_t f );
+// mtime of an open file outside packs, -1 for files in them
+
 int		FS_FileIsInPAK(const char *filename, int *pChecksum );
 // returns 1 if a file is in the PAK file, otherwise -1
 
@@ -754,6 +766,25 @@ void 		QDECL Com_Printf( const char *fmt, ... );
 void 		QDECL Com_DPrintf( const char *fmt, ... );
 void		QDECL Com_OPrintf( const char *fmt, ...); // Outputs to the VC / Windows Debug window (only in debug compile)
 void 		NORETURN QDECL Com_Error( int code, const char *fmt, ... );
+
+// background log writer, see logqueue.cpp
+void		Com_LogInit( void );
+void		Com_LogShutdown( void );
+void		Com_LogBind( int channel, fileHandle_t f );
+void		Com_LogUnbindFile( fileHandle_t f );
+qboolean	Com_LogPrint( int channel, int level, const char *text );
+void		Com_LogFlush( void );
+void		Com_LogPark( qboolean park );
+void		Com_LogCrashFlush( void );
+
+// level load timing, see loadprofile.cpp
+void		Com_LoadProfileBegin( const char *root, const char *label );
+void		Com_LoadProfileEnd( void );
+qboolean	Com_LoadProfileActive( void );
+int			Com_LoadProfileElapsed( void );	// msec since Com_LoadProfileBegin
+void		Com_LoadScopeEnter( const char *name );
+void		Com_LoadScopeLeave( void );
+
 void 		NORETURN Com_Quit_f( void );
 int			Com_EventLoop( void );
 int			Com_Milliseconds( void );	// will be journaled properly
@@ -1042,6 +1073,7 @@ typedef struct huffman_s {
 void	Huff_Compress(msg_t *buf, int offset);
 void	Huff_Decompress(msg_t *buf, int offset);
 void	Huff_Init(huffman_t *huff);
+void	MSG_BuildHuffman( huffman_t *huff, const byte *weights );
 void	Huff_addRef(huff_t* huff, byte ch);
 int		Huff_Receive (node_t *node, int *ch, byte *fin);
 void	Huff_transmit (huff_t *huff, int ch, byte *fout);
@@ -1065,6 +1097,9 @@ inline int Round(float value)
 // Persistent data store API
 bool PD_Store ( const char *name, const void *data, size_t size );
 const void *PD_Load ( const char *name, size_t *size );
+qboolean PD_StoreBlob ( const char *key, int version, int sourceChecksum, const void *data, int size );
+int PD_LoadBlob ( const char *key, int version, int sourceChecksum, void *buffer, int bufferSize );	// -1 if missing or out of date
+int PD_FileChecksum ( const char *path );
 
 uint32_t ConvertUTF8ToUTF32( char *utf8CurrentChar, char **utf8NextChar );
 
@@ -157,6 +157,7 @@ typedef struct refexport_s {
 	void				(*G2API_AbsurdSmoothing)				( CGhoul2Info_v &ghoul2, qboolean status );
 	void				(*G2API_BoltMatrixReconstruction)		( qboolean reconstruct );
 	void				(*G2API_BoltMatrixSPMethod)				( qboolean spMethod );
+	void				(*G2API_BoneLookupStats)				( int *lookups, int *probes, qboolean reset );
 	void				(*G2API_CleanEntAttachments)			( void );
 	void				(*G2API_CleanGhoul2Models)				( CGhoul2Info_v **ghoul2Ptr );
 	void				(*G2API_ClearAttachedInstance)			( int entityNum );
@@ -174,6 +175,7 @@ typedef struct refexport_s {
 	qboolean			(*G2API_GetBoltMatrix)					( CGhoul2Info_v &ghoul2, const int modelIndex, const int boltIndex, mdxaBone_t *matrix, const vec3_t angles, const vec3_t position, const int frameNum, qhandle_t *modelList, vec3_t scale );
 	qboolean			(*G2API_GetBoneAnim)					( CGhoul2Info_v& ghoul2, int modelIndex, const char *boneName, const int currentTime, float *currentFrame, int *startFrame, int *endFrame, int *flags, float *animSpeed, qhandle_t *modelList );
 	int					(*G2API_GetBoneIndex)					( CGhoul2Info *ghlInfo, const char *boneName );
+	int					(*G2API_GetBoneNum)						( CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName );
 	int					(*G2API_GetGhoul2ModelFlags)			( CGhoul2Info *ghlInfo );
 	char *				(*G2API_GetGLAName)						( CGhoul2Info_v &ghoul2, int modelIndex );
 	const char *		(*G2API_GetModelName)					( CGhoul2Info_v& ghoul2, int modelIndex );
@@ -216,8 +218,10 @@ typedef struct refexport_s {
 	qboolean			(*G2API_SetBoneAnglesIndex)				( CGhoul2Info *ghlInfo, const int index, const vec3_t angles, const int flags, const Eorientations yaw, const Eorientations pitch, const Eorientations roll, qhandle_t *modelList, int blendTime, int currentTime );
 	qboolean			(*G2API_SetBoneAnglesMatrix)			( CGhoul2Info *ghlInfo, const char *boneName, const mdxaBone_t &matrix, const int flags, qhandle_t *modelList, int blendTime, int currentTime );
 	qboolean			(*G2API_SetBoneAnglesMatrixIndex)		( CGhoul2Info *ghlInfo, const int index, const mdxaBone_t &matrix, const int flags, qhandle_t *modelList, int blendTime, int currentTime );
+	qboolean			(*G2API_SetBoneAnglesNum)				( CGhoul2Info_v &ghoul2, const int modelIndex, const int boneNum, const vec3_t angles, const int flags, const Eorientations up, const Eorientations left, const Eorientations forward, qhandle_t *modelList, int blendTime, int currentTime );
 	qboolean			(*G2API_SetBoneAnim)					( CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame /*= -1*/, const int blendTime /*= -1*/ );
 	qboolean			(*G2API_SetBoneAnimIndex)				( CGhoul2Info *ghlInfo, const int index, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime );
+	qboolean			(*G2API_SetBoneAnimNum)					( CGhoul2Info_v &ghoul2, const int modelIndex, const int boneNum, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime );
 	qboolean			(*G2API_SetBoneIKState)					( CGhoul2Info_v &ghoul2, int time, const char *boneName, int ikState, sharedSetBoneIKStateParams_t *params );
 	qboolean			(*G2API_SetGhoul2ModelFlags)			( CGhoul2Info *ghlInfo, const int flags );
 	void				(*G2API_SetGhoul2ModelIndexes)			( CGhoul2Info_v &ghoul2, qhandle_t *modelList, qhandle_t *skinList );
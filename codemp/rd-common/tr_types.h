@@ -328,6 +328,9 @@ Ghoul2 Insert End
 */
 	int			 numLods;
 	qboolean	bspInstance;
+	int			g2TransformSize;	// vert space needed to transform the most detailed lod of a ghoul2 mesh for collision
+	int			*g2BoneHash;		// only if type == MOD_MDXA, open addressed bone name -> skeleton index table
+	int			g2BoneHashMask;
 } model_t;
 
 #define	MAX_RENDER_STRINGS			8
@@ -276,6 +276,7 @@ qboolean G2API_OverrideServerWithClientData(CGhoul2Info_v& ghoul2, int modelInde
 	serverInstance->mModelindex = clientInstance->mModelindex;
 	serverInstance->mSurfaceRoot = clientInstance->mSurfaceRoot;
 	serverInstance->mTransformedVertsArray = clientInstance->mTransformedVertsArray;
+	serverInstance->mTransformedVertsGeneration = clientInstance->mTransformedVertsGeneration;
 
 	if (!serverInstance->mBoneCache)
 	{ //if this is the case.. I guess we can use the client one instead
@@ -943,22 +944,11 @@ qboolean G2API_DoesBoneExist(CGhoul2Info_v& ghoul2, int modelIndex, const char *
 
 	if (G2_SetupModelPointers(ghlInfo))
 	{ //model is valid
-		mdxaHeader_t *mdxa = ghlInfo->currentModel->mdxa;
-		if (mdxa)
-		{ //get the skeleton data and iterate through the bones
-			int i;
-			mdxaSkel_t *skel;
-			mdxaSkelOffsets_t *offsets;
-
-			offsets = (mdxaSkelOffsets_t *)((byte *)mdxa + sizeof(mdxaHeader_t));
-
- 			for (i = 0; i < mdxa->numBones; i++)
- 			{
- 				skel = (mdxaSkel_t *)((byte *)mdxa + sizeof(mdxaHeader_t) + offsets->offsets[i]);
- 				if (!Q_stricmp(skel->name, boneName))
-				{ //got it
-					return qtrue;
-				}
+		if (ghlInfo->currentModel->mdxa)
+		{ //look the bone up in the skeleton data
+			if (G2_Find_Skeleton_Bone(ghlInfo->currentModel, boneName) != -1)
+			{ //got it
+				return qtrue;
 			}
 		}
 	}
@@ -1042,11 +1032,9 @@ qboolean G2API_SetBoneAnimIndex(CGhoul2Info *ghlInfo, const int index, const int
 
 #define _PLEASE_SHUT_THE_HELL_UP
 
-qboolean G2API_SetBoneAnim(CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName, const int AstartFrame, const int AendFrame, const int flags, const float animSpeed, const int currentTime, const float AsetFrame, const int blendTime)
+// pull out of range frame numbers from the game back to something sane
+static void G2_ClampAnimFrames(int &startFrame, int &endFrame, float &setFrame)
 {
-	int endFrame=AendFrame;
-	int startFrame=AstartFrame;
-	float setFrame=AsetFrame;
 #ifndef _PLEASE_SHUT_THE_HELL_UP
 	assert(endFrame>0);
 	assert(startFrame>=0);
@@ -1079,6 +1067,15 @@ qboolean G2API_SetBoneAnim(CGhoul2Info_v &ghoul2, const int modelIndex, const ch
 	{
 		setFrame=0.0f;
 	}
+}
+
+qboolean G2API_SetBoneAnim(CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName, const int AstartFrame, const int AendFrame, const int flags, const float animSpeed, const int currentTime, const float AsetFrame, const int blendTime)
+{
+	int endFrame=AendFrame;
+	int startFrame=AstartFrame;
+	float setFrame=AsetFrame;
+
+	G2_ClampAnimFrames(startFrame, endFrame, setFrame);
 	if (ghoul2.size()>modelIndex)
 	{
 		CGhoul2Info *ghlInfo = &ghoul2[modelIndex];
@@ -1116,6 +1113,37 @@ qboolean G2API_SetBoneAnim(CGhoul2Info_v &ghoul2, const int modelIndex, const ch
 	return qfalse;
 }
 
+// as G2API_SetBoneAnim, with the bone given by G2API_GetBoneNum
+qboolean G2API_SetBoneAnimNum(CGhoul2Info_v &ghoul2, const int modelIndex, const int boneNum, const int AstartFrame, const int AendFrame, const int flags, const float animSpeed, const int currentTime, const float AsetFrame, const int blendTime)
+{
+	int endFrame=AendFrame;
+	int startFrame=AstartFrame;
+	float setFrame=AsetFrame;
+
+	G2_ClampAnimFrames(startFrame, endFrame, setFrame);
+	if (ghoul2.size()>modelIndex)
+	{
+		CGhoul2Info *ghlInfo = &ghoul2[modelIndex];
+
+		if (G2_SetupModelPointers(ghlInfo))
+		{
+			if (ghlInfo->mFlags & GHOUL2_RAG_STARTED)
+			{
+				return qfalse;
+			}
+			if (boneNum < 0 || boneNum >= ghlInfo->aHeader->numBones)
+			{
+				return qfalse;
+			}
+
+			// ensure we flush the cache
+			ghlInfo->mSkelFrameNum = 0;
+ 			return G2_Set_Bone_Anim_Num(ghlInfo, ghlInfo->mBlist, boneNum, startFrame, endFrame, flags, animSpeed, currentTime, setFrame, blendTime);
+		}
+	}
+	return qfalse;
+}
+
 qboolean G2API_GetBoneAnim(CGhoul2Info_v& ghoul2, int modelIndex, const char *boneName, const int currentTime, float *currentFrame,
 						   int *startFrame, int *endFrame, int *flags, float *animSpeed, int *modelList)
 {
@@ -1318,6 +1346,51 @@ qboolean G2API_SetBoneAngles(CGhoul2Info_v &ghoul2, const int modelIndex, const
 	return qfalse;
 }
 
+// index of the named bone in the model's skeleton, or -1. it stays valid for
+// as long as the model keeps the same gla, so callers that set the same bones
+// every frame can look them up once and use the *Num setters afterwards
+int G2API_GetBoneNum(CGhoul2Info_v &ghoul2, const int modelIndex, const char *boneName)
+{
+	if (ghoul2.size()>modelIndex)
+	{
+		CGhoul2Info *ghlInfo = &ghoul2[modelIndex];
+
+		if (G2_SetupModelPointers(ghlInfo))
+		{
+			return G2_Find_Skeleton_Bone(ghlInfo->animModel, boneName);
+		}
+	}
+	return -1;
+}
+
+// as G2API_SetBoneAngles, with the bone given by G2API_GetBoneNum
+qboolean G2API_SetBoneAnglesNum(CGhoul2Info_v &ghoul2, const int modelIndex, const int boneNum, const vec3_t angles, const int flags,
+							 const Eorientations up, const Eorientations left, const Eorientations forward,
+							 qhandle_t *modelList, int blendTime, int currentTime )
+{
+	if (ghoul2.size()>modelIndex)
+	{
+		CGhoul2Info *ghlInfo = &ghoul2[modelIndex];
+
+		if (G2_SetupModelPointers(ghlInfo))
+		{
+			if (ghlInfo->mFlags & GHOUL2_RAG_STARTED)
+			{
+				return qfalse;
+			}
+			if (boneNum < 0 || boneNum >= ghlInfo->aHeader->numBones)
+			{
+				return qfalse;
+			}
+
+			// ensure we flush the cache
+			ghlInfo->mSkelFrameNum = 0;
+			return G2_Set_Bone_Angles_Num(ghlInfo, ghlInfo->mBlist, boneNum, angles, flags, up, left, forward, modelList, ghlInfo->mModelindex, blendTime, currentTime);
+		}
+	}
+	return qfalse;
+}
+
 qboolean G2API_SetBoneAnglesMatrixIndex(CGhoul2Info *ghlInfo, const int index, const mdxaBone_t &matrix,
 								   const int flags, qhandle_t *modelList, int blendTime, int currentTime)
 {
@@ -1994,44 +2067,19 @@ void G2API_CollisionDetectCache(CollisionRecord_t *collRecMap, CGhoul2Info_v &gh
 										  int frameNumber, int entNum, vec3_t rayStart, vec3_t rayEnd, vec3_t scale, IHeapAllocator *G2VertSpace, int traceFlags, int useLod, float fRadius)
 { //this will store off the transformed verts for the next trace - this is slower, but for models that do not animate
 	//frequently it is much much faster. -rww
-#if 0 // UNUSED
-	int *test = ghoul2[0].mTransformedVertsArray;
-#endif
 	if (G2_SetupModelPointers(ghoul2))
 	{
 		vec3_t	transRayStart, transRayEnd;
 
 		int tframeNum=G2API_GetTime(frameNumber);
-		// make sure we have transformed the whole skeletons for each model
-		if (G2_NeedRetransform(&ghoul2[0], tframeNum) || !ghoul2[0].mTransformedVertsArray)
+		// make sure we have transformed the whole skeletons for each model. the transformed verts live in the
+		// vert space until it is next reset, so they have to be rebuilt if that has happened since.
+		if (G2_NeedRetransform(&ghoul2[0], tframeNum) || !ghoul2[0].mTransformedVertsArray ||
+			ghoul2[0].mTransformedVertsGeneration != G2VertSpace->MiniHeapGeneration())
 		{ //optimization, only create new transform space if we need to, otherwise
 			//store it off!
-			int i = 0;
-			while (i < ghoul2.size())
-			{
-				CGhoul2Info &g2 = ghoul2[i];
-
-				/*
-				if ((g2.mFlags & GHOUL2_ZONETRANSALLOC) && g2.mTransformedVertsArray)
-				{ //clear it out, yo.
-					Z_Free(g2.mTransformedVertsArray);
-					g2.mTransformedVertsArray = 0;
-				}
-				*/
-				if (!g2.mTransformedVertsArray || !(g2.mFlags & GHOUL2_ZONETRANSALLOC))
-				{ //reworked so we only alloc once!
-					//if we have a pointer, but not a ghoul2_zonetransalloc flag, then that means
-					//it is a miniheap pointer. Just stomp over it.
-					int iSize = g2.currentModel->mdxm->numSurfaces * 4;
-					g2.mTransformedVertsArray = (size_t *)Z_Malloc(iSize, TAG_GHOUL2, qtrue);
-				}
-
-				g2.mFlags |= GHOUL2_ZONETRANSALLOC;
-
-				i++;
-			}
 			G2_ConstructGhoulSkeleton(ghoul2, frameNumber, true, scale);
-			G2VertSpace->ResetHeap();
+			G2VertSpace->MiniHeapReserve(G2_TransformedVertsSize(ghoul2));
 
 			// now having done that, time to build the model
 #ifdef _G2_GORE
@@ -2039,22 +2087,6 @@ void G2API_CollisionDetectCache(CollisionRecord_t *collRecMap, CGhoul2Info_v &gh
 #else
 			G2_TransformModel(ghoul2, frameNumber, scale, G2VertSpace, useLod);
 #endif
-
-			//don't need to do this anymore now that I am using a flag for zone alloc.
-			/*
-			i = 0;
-			while (i < ghoul2.size())
-			{
-				CGhoul2Info &g2 = ghoul2[i];
-				int iSize = g2.currentModel->mdxm->numSurfaces * 4;
-
-				int *zoneMem = (int *)Z_Malloc(iSize, TAG_GHOUL2, qtrue);
-				memcpy(zoneMem, g2.mTransformedVertsArray, iSize);
-				g2.mTransformedVertsArray = zoneMem;
-				g2.mFlags |= GHOUL2_ZONETRANSALLOC;
-				i++;
-			}
-			*/
 		}
 
 		// pre generate the world matrix - used to transform the incoming ray
@@ -2103,7 +2135,8 @@ void G2API_CollisionDetect(CollisionRecord_t *collRecMap, CGhoul2Info_v &ghoul2,
 		// pre generate the world matrix - used to transform the incoming ray
 		G2_GenerateWorldMatrix(angles, position);
 
-		G2VertSpace->ResetHeap();
+		// other models transformed this frame stay valid unless the vert space runs out
+		G2VertSpace->MiniHeapReserve(G2_TransformedVertsSize(ghoul2));
 
 		// now having done that, time to build the model
 #ifdef _G2_GORE
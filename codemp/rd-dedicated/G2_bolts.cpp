@@ -126,8 +126,6 @@ int G2_Add_Bolt(CGhoul2Info *ghlInfo, boltInfo_v &bltlist, surfaceInfo_v &slist,
 	model_t		*mod_m = (model_t *)ghlInfo->currentModel;
 	model_t		*mod_a = (model_t *)ghlInfo->animModel;
 	int					x, surfNum = -1;
-	mdxaSkel_t			*skel;
-	mdxaSkelOffsets_t	*offsets;
 	boltInfo_t			tempBolt;
 	int					flags;
 
@@ -174,21 +172,11 @@ int G2_Add_Bolt(CGhoul2Info *ghlInfo, boltInfo_v &bltlist, surfaceInfo_v &slist,
 
 	// no, check to see if it's a bone then
 
-   	offsets = (mdxaSkelOffsets_t *)((byte *)mod_a->mdxa + sizeof(mdxaHeader_t));
-
- 	// walk the entire list of bones in the gla file for this model and see if any match the name of the bone we want to find
- 	for (x=0; x< mod_a->mdxa->numBones; x++)
- 	{
- 		skel = (mdxaSkel_t *)((byte *)mod_a->mdxa + sizeof(mdxaHeader_t) + offsets->offsets[x]);
- 		// if name is the same, we found it
- 		if (!Q_stricmp(skel->name, boneName))
-		{
-			break;
-		}
-	}
+	// find the bone in the gla file for this model that matches the name of the bone we want to find
+	x = G2_Find_Skeleton_Bone(mod_a, boneName);
 
 	// check to see we did actually make a match with a bone in the model
-	if (x == mod_a->mdxa->numBones)
+	if (x == -1)
 	{
 		// didn't find it? Error
 		//assert(0&&x == mod_a->mdxa->numBones);
@@ -43,31 +43,34 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 //=====================================================================================================================
 // Bone List handling routines - so entities can override bone info on a bone by bone level, and also interrogate this info
 
-// Given a bone name, see if that bone is already in our bone list - note the model_t pointer that gets passed in here MUST point at the
-// gla file, not the glm file type.
-int G2_Find_Bone(const model_t *mod, boneInfo_v &blist, const char *boneName)
+// bone name lookups done through G2_Find_Skeleton_Bone, and how many hash slots they had to look at
+static int g_G2BoneNameLookups = 0;
+static int g_G2BoneNameProbes = 0;
+
+// Given a bone name, find its index in the skeleton of the gla, using the table R_MDXABuildBoneHash made at load time
+int G2_Find_Skeleton_Bone(const model_t *mod_a, const char *boneName)
 {
 	mdxaSkel_t			*skel;
 	mdxaSkelOffsets_t	*offsets;
-   	offsets = (mdxaSkelOffsets_t *)((byte *)mod->mdxa + sizeof(mdxaHeader_t));
-	skel = (mdxaSkel_t *)((byte *)mod->mdxa + sizeof(mdxaHeader_t) + offsets->offsets[0]);
 
-	// look through entire list
-	for(size_t i=0; i<blist.size(); i++)
+	if (!mod_a->g2BoneHash)
 	{
-		// if this bone entry has no info in it, bounce over it
-		if (blist[i].boneNumber == -1)
-		{
-			continue;
-		}
+		return -1;
+	}
 
-		// figure out what skeletal info structure this bone entry is looking at
-		skel = (mdxaSkel_t *)((byte *)mod->mdxa + sizeof(mdxaHeader_t) + offsets->offsets[blist[i].boneNumber]);
+	g_G2BoneNameLookups++;
+
+   	offsets = (mdxaSkelOffsets_t *)((byte *)mod_a->mdxa + sizeof(mdxaHeader_t));
+
+	for (int h = G2_BoneNameHash(boneName) & mod_a->g2BoneHashMask; mod_a->g2BoneHash[h] != -1; h = (h + 1) & mod_a->g2BoneHashMask)
+	{
+		g_G2BoneNameProbes++;
 
+		skel = (mdxaSkel_t *)((byte *)mod_a->mdxa + sizeof(mdxaHeader_t) + offsets->offsets[mod_a->g2BoneHash[h]]);
 		// if name is the same, we found it
 		if (!Q_stricmp(skel->name, boneName))
 		{
-			return i;
+			return mod_a->g2BoneHash[h];
 		}
 	}
 
@@ -75,33 +78,43 @@ int G2_Find_Bone(const model_t *mod, boneInfo_v &blist, const char *boneName)
 	return -1;
 }
 
-// we need to add a bone to the list - find a free one and see if we can find a corresponding bone in the gla file
-int G2_Add_Bone (const model_t *mod, boneInfo_v &blist, const char *boneName)
+void G2_Bone_Lookup_Stats(int *lookups, int *probes, qboolean reset)
 {
-	int x;
-	mdxaSkel_t			*skel;
-	mdxaSkelOffsets_t	*offsets;
-	boneInfo_t			tempBone;
+	*lookups = g_G2BoneNameLookups;
+	*probes = g_G2BoneNameProbes;
 
-	//rww - RAGDOLL_BEGIN
-	memset(&tempBone, 0, sizeof(tempBone));
-	//rww - RAGDOLL_END
+	if (reset)
+	{
+		g_G2BoneNameLookups = 0;
+		g_G2BoneNameProbes = 0;
+	}
+}
 
-   	offsets = (mdxaSkelOffsets_t *)((byte *)mod->mdxa + sizeof(mdxaHeader_t));
+// Given a bone name, see if that bone is already in our bone list - note the model_t pointer that gets passed in here MUST point at the
+// gla file, not the glm file type.
+int G2_Find_Bone(const model_t *mod, boneInfo_v &blist, const char *boneName)
+{
+	int boneNum = G2_Find_Skeleton_Bone(mod, boneName);
 
- 	// walk the entire list of bones in the gla file for this model and see if any match the name of the bone we want to find
- 	for (x=0; x< mod->mdxa->numBones; x++)
- 	{
- 		skel = (mdxaSkel_t *)((byte *)mod->mdxa + sizeof(mdxaHeader_t) + offsets->offsets[x]);
- 		// if name is the same, we found it
- 		if (!Q_stricmp(skel->name, boneName))
-		{
-			break;
-		}
+	if (boneNum == -1)
+	{
+		return -1;
 	}
 
+	// look through entire list
+	return G2_Find_Bone_In_List(blist, boneNum);
+}
+
+// we need to add a bone to the list - find a free one and see if we can find a corresponding bone in the gla file
+int G2_Add_Bone (const model_t *mod, boneInfo_v &blist, const char *boneName)
+{
+	int x;
+
+ 	// find the bone in the gla file for this model that matches the name of the bone we want to find
+	x = G2_Find_Skeleton_Bone(mod, boneName);
+
 	// check to see we did actually make a match with a bone in the model
-	if (x == mod->mdxa->numBones)
+	if (x == -1)
 	{
 		// didn't find it? Error
 		//assert(0);
@@ -115,15 +128,29 @@ int G2_Add_Bone (const model_t *mod, boneInfo_v &blist, const char *boneName)
 		return -1;
 	}
 
+#ifdef _RAG_PRINT_TEST
+	Com_Printf("New bone added for %s\n", boneName);
+#endif
+	return G2_Add_Bone_Num(blist, x);
+}
+
+// add a bone to the list given its index in the gla skeleton, or return its slot if it's already there
+int G2_Add_Bone_Num (boneInfo_v &blist, const int x)
+{
+	boneInfo_t			tempBone;
+
+	//rww - RAGDOLL_BEGIN
+	memset(&tempBone, 0, sizeof(tempBone));
+	//rww - RAGDOLL_END
+
 	// look through entire list - see if it's already there first
 	for(size_t i=0; i<blist.size(); i++)
 	{
 		// if this bone entry has info in it, bounce over it
 		if (blist[i].boneNumber != -1)
 		{
-			skel = (mdxaSkel_t *)((byte *)mod->mdxa + sizeof(mdxaHeader_t) + offsets->offsets[blist[i].boneNumber]);
-			// if name is the same, we found it
-			if (!Q_stricmp(skel->name, boneName))
+			// if it's the same bone, we found it
+			if (blist[i].boneNumber == x)
 			{
 				return i;
 			}
@@ -137,9 +164,6 @@ int G2_Add_Bone (const model_t *mod, boneInfo_v &blist, const char *boneName)
 		}
 	}
 
-#ifdef _RAG_PRINT_TEST
-	Com_Printf("New bone added for %s\n", boneName);
-#endif
 	// ok, we didn't find an existing bone of that name, or an empty slot. Lets add an entry
 	tempBone.boneNumber = x;
 	tempBone.flags = 0;
@@ -494,12 +518,30 @@ qboolean G2_Set_Bone_Angles_Index( boneInfo_v &blist, const int index,
 qboolean G2_Set_Bone_Angles(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName, const float *angles,
 							const int flags, const Eorientations up, const Eorientations left, const Eorientations forward,
 							qhandle_t *modelList, const int modelIndex, const int blendTime, const int currentTime)
+{
+	int			boneNum = G2_Find_Skeleton_Bone(ghlInfo->animModel, boneName);
+
+	if (boneNum == -1)
+	{
+#ifdef _DEBUG
+		Com_Printf("WARNING: Failed to add bone %s\n", boneName);
+#endif
+		return qfalse;
+	}
+
+	return G2_Set_Bone_Angles_Num(ghlInfo, blist, boneNum, angles, flags, up, left, forward, modelList, modelIndex, blendTime, currentTime);
+}
+
+// as G2_Set_Bone_Angles, with the bone given by its index in the gla skeleton
+qboolean G2_Set_Bone_Angles_Num(CGhoul2Info *ghlInfo, boneInfo_v &blist, const int boneNum, const float *angles,
+							const int flags, const Eorientations up, const Eorientations left, const Eorientations forward,
+							qhandle_t *modelList, const int modelIndex, const int blendTime, const int currentTime)
 {
 	model_t		*mod_a;
 
 	mod_a = (model_t *)ghlInfo->animModel;
 
-	int			index = G2_Find_Bone(mod_a, blist, boneName);
+	int			index = G2_Find_Bone_In_List(blist, boneNum);
 
 	// did we find it?
 	if (index != -1)
@@ -523,7 +565,7 @@ qboolean G2_Set_Bone_Angles(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char
 	}
 
 	// no - lets try and add this bone in
-	index = G2_Add_Bone(mod_a, blist, boneName);
+	index = G2_Add_Bone_Num(blist, boneNum);
 
 	// did we find a free one?
 	if (index != -1)
@@ -838,12 +880,35 @@ qboolean G2_Set_Bone_Anim(CGhoul2Info *ghlInfo,
 						  const float setFrame,
 						  const int blendTime)
 {
-	model_t		*mod_a = (model_t *)ghlInfo->animModel;
+	int			boneNum = G2_Find_Skeleton_Bone(ghlInfo->animModel, boneName);
 
-	int			index = G2_Find_Bone(mod_a, blist, boneName);
+	if (boneNum == -1)
+	{
+#ifdef _DEBUG
+		Com_Printf("WARNING: Failed to add bone %s\n", boneName);
+#endif
+		return qfalse;
+	}
+
+	return G2_Set_Bone_Anim_Num(ghlInfo, blist, boneNum, startFrame, endFrame, flags, animSpeed, currentTime, setFrame, blendTime);
+}
+
+// as G2_Set_Bone_Anim, with the bone given by its index in the gla skeleton
+qboolean G2_Set_Bone_Anim_Num(CGhoul2Info *ghlInfo,
+						  boneInfo_v &blist,
+						  const int boneNum,
+						  const int startFrame,
+						  const int endFrame,
+						  const int flags,
+						  const float animSpeed,
+						  const int currentTime,
+						  const float setFrame,
+						  const int blendTime)
+{
+	int			index = G2_Find_Bone_In_List(blist, boneNum);
 	if (index == -1)
 	{
-		index = G2_Add_Bone(mod_a, blist, boneName);
+		index = G2_Add_Bone_Num(blist, boneNum);
 	}
 
 	if (index != -1)
@@ -1282,52 +1347,18 @@ static void G2_Generate_MatrixRag(
 
 int G2_Find_Bone_Rag(CGhoul2Info *ghlInfo, boneInfo_v &blist, const char *boneName)
 {
-	mdxaSkel_t			*skel;
-	mdxaSkelOffsets_t	*offsets;
-
-   	offsets = (mdxaSkelOffsets_t *)((byte *)ghlInfo->aHeader + sizeof(mdxaHeader_t));
-	skel = (mdxaSkel_t *)((byte *)ghlInfo->aHeader + sizeof(mdxaHeader_t) + offsets->offsets[0]);
-
-	/*
-	model_t			*currentModel;
-	model_t			*animModel;
-	mdxaHeader_t	*aHeader;
-
-	currentModel = R_GetModelByHandle(RE_RegisterModel(ghlInfo->mFileName));
-	assert(currentModel);
-	animModel =  R_GetModelByHandle(currentModel->mdxm->animIndex);
-	assert(animModel);
-	aHeader = animModel->mdxa;
-	assert(aHeader);
-
-   	offsets = (mdxaSkelOffsets_t *)((byte *)aHeader + sizeof(mdxaHeader_t));
-	skel = (mdxaSkel_t *)((byte *)aHeader + sizeof(mdxaHeader_t) + offsets->offsets[0]);
-	*/
+	int boneNum = G2_Find_Skeleton_Bone(ghlInfo->animModel, boneName);
 
-	// look through entire list
-	for(size_t i=0; i<blist.size(); i++)
+	if (boneNum == -1)
 	{
-		// if this bone entry has no info in it, bounce over it
-		if (blist[i].boneNumber == -1)
-		{
-			continue;
-		}
-
-		// figure out what skeletal info structure this bone entry is looking at
-		skel = (mdxaSkel_t *)((byte *)ghlInfo->aHeader + sizeof(mdxaHeader_t) + offsets->offsets[blist[i].boneNumber]);
-		//skel = (mdxaSkel_t *)((byte *)aHeader + sizeof(mdxaHeader_t) + offsets->offsets[blist[i].boneNumber]);
-
-		// if name is the same, we found it
-		if (!Q_stricmp(skel->name, boneName))
-		{
-			return i;
-		}
-	}
 #if _DEBUG
-//	G2_Bone_Not_Found(boneName,ghlInfo->mFileName);
+//		G2_Bone_Not_Found(boneName,ghlInfo->mFileName);
 #endif
-	// didn't find it
-	return -1;
+		return -1;
+	}
+
+	// look through entire list
+	return G2_Find_Bone_In_List(blist, boneNum);
 }
 
 static int G2_Set_Bone_Rag(const mdxaHeader_t *mod_a,
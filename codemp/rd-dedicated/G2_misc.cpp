@@ -25,6 +25,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/MiniHeap.h"
 #include "server/server.h"
 #include "ghoul2/g2_local.h"
+#include "ghoul2/G2_simd.h"
 
 #ifdef _G2_GORE
 #include "ghoul2/G2_gore.h"
@@ -386,9 +387,49 @@ int G2_DecideTraceLod(CGhoul2Info &ghoul2, int useLod)
 	return returnLod;
 }
 
+// transformed verts are stored as x y z s t per vert, followed by the model space mins and maxs of the surface
+static inline float *G2_TransformedSurfaceBounds( float *verts, const int numVerts )
+{
+	return &verts[numVerts * 5];
+}
+
+static inline const float *G2_TransformedSurfaceBounds( const float *verts, const int numVerts )
+{
+	return &verts[numVerts * 5];
+}
+
+// skin a single vertex by its weighted bones, writing the scaled position to out[0..2]. out[3] may be clobbered.
+static inline void G2_SkinVertex( const mdxmVertex_t *v, const int *piBoneReferences, CBoneCache *boneCache, const vec3_t scale, float *out )
+{
+	const mdxaBone_t	*bones[iMAX_G2_BONEWEIGHTS_PER_VERT];
+	float				weights[iMAX_G2_BONEWEIGHTS_PER_VERT];
+	const int iNumWeights = G2_GetVertWeights( v );
+	float fTotalWeight = 0.0f;
+
+	for ( int k = 0 ; k < iNumWeights ; k++ )
+	{
+		bones[k] = &EvalBoneCache( piBoneReferences[G2_GetVertBoneIndex( v, k )], boneCache );
+		weights[k] = G2_GetVertBoneWeight( v, k, fTotalWeight, iNumWeights );
+	}
+
+#if idsse2
+	G2_SkinVertex_SSE2( bones, weights, iNumWeights, v->vertCoords, scale, out );
+
+	if ( r_g2SimdCheck && r_g2SimdCheck->integer )
+	{
+		vec3_t scalar;
+
+		G2_SkinVertex_Scalar( bones, weights, iNumWeights, v->vertCoords, scale, scalar );
+		G2_CheckSimd( "G2_SkinVertex", scalar, out, 3 );
+	}
+#else
+	G2_SkinVertex_Scalar( bones, weights, iNumWeights, v->vertCoords, scale, out );
+#endif
+}
+
 void R_TransformEachSurface( const mdxmSurface_t *surface, vec3_t scale, IHeapAllocator *G2VertSpace, size_t *TransformedVertsArray,CBoneCache *boneCache)
 {
-	int				 j, k;
+	int				 j;
 	mdxmVertex_t 	*v;
 	float			*TransformedVerts;
 
@@ -397,103 +438,33 @@ void R_TransformEachSurface( const mdxmSurface_t *surface, vec3_t scale, IHeapAl
 	//
 	int *piBoneReferences = (int*) ((byte*)surface + surface->ofsBoneReferences);
 
-	// alloc some space for the transformed verts to get put in
-	TransformedVerts = (float *)G2VertSpace->MiniHeapAlloc(surface->numVerts * 5 * 4);
+	// alloc some space for the transformed verts to get put in, plus the bounds of the surface
+	TransformedVerts = (float *)G2VertSpace->MiniHeapAlloc(G2_TransformedSurfaceSize(surface->numVerts));
 	TransformedVertsArray[surface->thisSurfaceIndex] = (size_t)TransformedVerts;
 	if (!TransformedVerts)
 	{
-		Com_Error(ERR_DROP, "Ran out of transform space for Ghoul2 Models. Adjust MiniHeapSize in SV_SpawnServer.\n");
+		Com_Error(ERR_DROP, "Ran out of transform space for Ghoul2 Models. Adjust G2_VERT_SPACE_SERVER_MAX_SIZE.\n");
 	}
 
 	// whip through and actually transform each vertex
 	const int numVerts = surface->numVerts;
 	v = (mdxmVertex_t *) ((byte *)surface + surface->ofsVerts);
 	mdxmVertexTexCoord_t *pTexCoords = (mdxmVertexTexCoord_t *) &v[numVerts];
+	float *mins = G2_TransformedSurfaceBounds( TransformedVerts, numVerts );
+	float *maxs = mins + 3;
 
-	// optimisation issue
-	if ((scale[0] != 1.0) || (scale[1] != 1.0) || (scale[2] != 1.0))
-	{
-		for ( j = 0; j < numVerts; j++ )
-		{
-			vec3_t			tempVert, tempNormal;
-//			mdxmWeight_t	*w;
-
-			VectorClear( tempVert );
-			VectorClear( tempNormal );
-//			w = v->weights;
-
-			const int iNumWeights = G2_GetVertWeights( v );
-
-			float fTotalWeight = 0.0f;
-			for ( k = 0 ; k < iNumWeights ; k++ )
-			{
-				int		iBoneIndex	= G2_GetVertBoneIndex( v, k );
-				float	fBoneWeight	= G2_GetVertBoneWeight( v, k, fTotalWeight, iNumWeights );
-
-				const mdxaBone_t &bone=EvalBoneCache(piBoneReferences[iBoneIndex],boneCache);
-
-				tempVert[0] += fBoneWeight * ( DotProduct( bone.matrix[0], v->vertCoords ) + bone.matrix[0][3] );
-				tempVert[1] += fBoneWeight * ( DotProduct( bone.matrix[1], v->vertCoords ) + bone.matrix[1][3] );
-				tempVert[2] += fBoneWeight * ( DotProduct( bone.matrix[2], v->vertCoords ) + bone.matrix[2][3] );
-
-				tempNormal[0] += fBoneWeight * DotProduct( bone.matrix[0], v->normal );
-				tempNormal[1] += fBoneWeight * DotProduct( bone.matrix[1], v->normal );
-				tempNormal[2] += fBoneWeight * DotProduct( bone.matrix[2], v->normal );
-			}
-			int pos = j * 5;
-
-			// copy tranformed verts into temp space
-			TransformedVerts[pos++] = tempVert[0] * scale[0];
-			TransformedVerts[pos++] = tempVert[1] * scale[1];
-			TransformedVerts[pos++] = tempVert[2] * scale[2];
-			// we will need the S & T coors too for hitlocation and hitmaterial stuff
-			TransformedVerts[pos++] = pTexCoords[j].texCoords[0];
-			TransformedVerts[pos] = pTexCoords[j].texCoords[1];
-
-			v++;// = (mdxmVertex_t *)&v->weights[/*v->numWeights*/surface->maxVertBoneWeights];
-		}
-	}
-	else
+	ClearBounds( mins, maxs );
+	for ( j = 0; j < numVerts; j++ )
 	{
-		int pos = 0;
-	  	for ( j = 0; j < numVerts; j++ )
-		{
-			vec3_t			tempVert, tempNormal;
-//			const mdxmWeight_t	*w;
-
-			VectorClear( tempVert );
-			VectorClear( tempNormal );
-//			w = v->weights;
+		float *pos = &TransformedVerts[j * 5];
 
-			const int iNumWeights = G2_GetVertWeights( v );
+		G2_SkinVertex( v, piBoneReferences, boneCache, scale, pos );
+		AddPointToBounds( pos, mins, maxs );
+		// we will need the S & T coors too for hitlocation and hitmaterial stuff
+		pos[3] = pTexCoords[j].texCoords[0];
+		pos[4] = pTexCoords[j].texCoords[1];
 
-			float fTotalWeight = 0.0f;
-			for ( k = 0 ; k < iNumWeights ; k++ )
-			{
-				int		iBoneIndex	= G2_GetVertBoneIndex( v, k );
-				float	fBoneWeight	= G2_GetVertBoneWeight( v, k, fTotalWeight, iNumWeights );
-
-				const mdxaBone_t &bone=EvalBoneCache(piBoneReferences[iBoneIndex],boneCache);
-
-				tempVert[0] += fBoneWeight * ( DotProduct( bone.matrix[0], v->vertCoords ) + bone.matrix[0][3] );
-				tempVert[1] += fBoneWeight * ( DotProduct( bone.matrix[1], v->vertCoords ) + bone.matrix[1][3] );
-				tempVert[2] += fBoneWeight * ( DotProduct( bone.matrix[2], v->vertCoords ) + bone.matrix[2][3] );
-
-				tempNormal[0] += fBoneWeight * DotProduct( bone.matrix[0], v->normal );
-				tempNormal[1] += fBoneWeight * DotProduct( bone.matrix[1], v->normal );
-				tempNormal[2] += fBoneWeight * DotProduct( bone.matrix[2], v->normal );
-			}
-
-			// copy tranformed verts into temp space
-			TransformedVerts[pos++] = tempVert[0];
-			TransformedVerts[pos++] = tempVert[1];
-			TransformedVerts[pos++] = tempVert[2];
-			// we will need the S & T coors too for hitlocation and hitmaterial stuff
-			TransformedVerts[pos++] = pTexCoords[j].texCoords[0];
-			TransformedVerts[pos++] = pTexCoords[j].texCoords[1];
-
-			v++;// = (mdxmVertex_t *)&v->weights[/*v->numWeights*/surface->maxVertBoneWeights];
-		}
+		v++;// = (mdxmVertex_t *)&v->weights[/*v->numWeights*/surface->maxVertBoneWeights];
 	}
 }
 
@@ -617,14 +588,12 @@ void G2_TransformModel(CGhoul2Info_v &ghoul2, const int frameNum, vec3_t scale,
 #endif
 
 		// give us space for the transformed vertex array to be put in
-		if (!(g.mFlags & GHOUL2_ZONETRANSALLOC))
-		{ //do not stomp if we're using zone space
-			g.mTransformedVertsArray = (size_t*)G2VertSpace->MiniHeapAlloc(g.currentModel->mdxm->numSurfaces * sizeof (size_t));
-			if (!g.mTransformedVertsArray)
-			{
-				Com_Error(ERR_DROP, "Ran out of transform space for Ghoul2 Models. Adjust MiniHeapSize in SV_SpawnServer.\n");
-			}
+		g.mTransformedVertsArray = (size_t*)G2VertSpace->MiniHeapAlloc(g.currentModel->mdxm->numSurfaces * sizeof (size_t));
+		if (!g.mTransformedVertsArray)
+		{
+			Com_Error(ERR_DROP, "Ran out of transform space for Ghoul2 Models. Adjust G2_VERT_SPACE_SERVER_MAX_SIZE.\n");
 		}
+		g.mTransformedVertsGeneration = G2VertSpace->MiniHeapGeneration();
 
 		memset(g.mTransformedVertsArray, 0, g.currentModel->mdxm->numSurfaces * sizeof (size_t));
 
@@ -644,6 +613,24 @@ void G2_TransformModel(CGhoul2Info_v &ghoul2, const int frameNum, vec3_t scale,
 }
 
 
+// worst case vert space G2_TransformModel will need for this set of models, so it can all be reserved up front
+int G2_TransformedVertsSize(CGhoul2Info_v &ghoul2)
+{
+	int size = 0;
+
+	for (int i=0; i<ghoul2.size(); i++)
+	{
+		const CGhoul2Info &g=ghoul2[i];
+		if (!g.mValid || !g.currentModel || !g.currentModel->mdxm)
+		{
+			continue;
+		}
+		size += g.currentModel->mdxm->numSurfaces * sizeof (size_t) + g.currentModel->g2TransformSize;
+	}
+
+	return size;
+}
+
 // work out how much space a triangle takes
 static float	G2_AreaOfTri(const vec3_t A, const vec3_t B, const vec3_t C)
 {
@@ -1064,6 +1051,71 @@ struct SVertexTemp
 static SVertexTemp GoreVerts[MAX_GORE_VERTS];
 #endif
 
+// slab test of the segment start->end against a surface's bounds, so whole surfaces can be skipped before the triangle tests
+static bool G2_SegmentHitsBounds( const vec3_t start, const vec3_t end, const float *bounds )
+{
+	static const float epsilon = 0.125f;
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+
+	for ( int i = 0; i < 3; i++ )
+	{
+		const float mins = bounds[i] - epsilon;
+		const float maxs = bounds[i + 3] + epsilon;
+		const float delta = end[i] - start[i];
+
+		if ( fabs( delta ) < 1E-10f )
+		{
+			if ( start[i] < mins || start[i] > maxs )
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float t1 = ( mins - start[i] ) / delta;
+		float t2 = ( maxs - start[i] ) / delta;
+		if ( t1 > t2 )
+		{
+			const float temp = t1;
+			t1 = t2;
+			t2 = temp;
+		}
+
+		if ( t1 > tMin )
+		{
+			tMin = t1;
+		}
+		if ( t2 < tMax )
+		{
+			tMax = t2;
+		}
+		if ( tMin > tMax )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// true if every point inside bounds projects onto axis (relative to origin) at or below low, or at or above high
+static bool G2_BoundsOutsideSlab( const float *bounds, const vec3_t origin, const vec3_t axis, const float low, const float high )
+{
+	vec3_t center, extents;
+
+	for ( int i = 0; i < 3; i++ )
+	{
+		center[i] = ( bounds[i] + bounds[i + 3] ) * 0.5f - origin[i];
+		extents[i] = ( bounds[i + 3] - bounds[i] ) * 0.5f;
+	}
+
+	const float mid = DotProduct( center, axis );
+	const float radius = extents[0] * fabs( axis[0] ) + extents[1] * fabs( axis[1] ) + extents[2] * fabs( axis[2] );
+
+	return ( mid + radius <= low ) || ( mid - radius >= high );
+}
+
 // now we're at poly level, check each model space transformed poly against the model world transfomed ray
 static bool G2_TracePolys(const mdxmSurface_t *surface, const mdxmSurfHierarchy_t *surfInfo, CTraceSurface &TS)
 {
@@ -1072,6 +1124,13 @@ static bool G2_TracePolys(const mdxmSurface_t *surface, const mdxmSurfHierarchy_
 	// whip through and actually transform each vertex
 	const mdxmTriangle_t *tris = (mdxmTriangle_t *) ((byte *)surface + surface->ofsTriangles);
 	const float *verts = (float *)TS.TransformedVertsArray[surface->thisSurfaceIndex];
+
+	// don't bother with any of the triangles if the ray misses the whole surface
+	if (!G2_SegmentHitsBounds(TS.rayStart, TS.rayEnd, G2_TransformedSurfaceBounds(verts, surface->numVerts)))
+	{
+		return false;
+	}
+
 	numTris = surface->numTriangles;
 	for ( j = 0; j < numTris; j++ )
 	{
@@ -1250,6 +1309,15 @@ static bool G2_RadiusTracePolys(
 	v3RayDir[1]/=f;
 	v3RayDir[2]/=f;
 
+	// the same rejection as the per vert flags below, but against the bounds of the surface
+	const float *bounds = G2_TransformedSurfaceBounds(verts, numVerts);
+	if (G2_BoundsOutsideSlab(bounds, TS.rayStart, saxis, -0.5f, 0.5f) ||
+		G2_BoundsOutsideSlab(bounds, TS.rayStart, taxis, -0.5f, 0.5f) ||
+		G2_BoundsOutsideSlab(bounds, TS.rayStart, v3RayDir, 0.0f, 1.0f))
+	{
+		return false;
+	}
+
 	for ( j = 0; j < numVerts; j++ )
 	{
 		const int pos=j*5;
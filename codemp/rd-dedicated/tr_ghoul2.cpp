@@ -32,6 +32,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "qcommon/disablewarnings.h"
 
+#include "ghoul2/G2_simd.h"
+
 #define	LL(x) x=LittleLong(x)
 
 #ifdef G2_PERFORMANCE_ANALYSIS
@@ -894,24 +896,42 @@ void G2_CreateMatrixFromQuaterion(mdxaBone_t *mat, vec4_t quat)
     mat->matrix[0][3]  = mat->matrix[1][3] = mat->matrix[2][3] = 0;
 }
 
+/*
+Runs with r_g2SimdCheck set, after a kernel has been computed both ways
+*/
+void G2_CheckSimd( const char *kernel, const float *scalar, const float *simd, int count )
+{
+	static int warnings = 0;
+	const float error = G2_SimdError( scalar, simd, count );
+
+	if ( error > G2_SIMD_TOLERANCE )
+	{
+		assert( 0 );
+		if ( warnings++ < 10 )
+		{
+			Com_Printf( S_COLOR_YELLOW "WARNING: %s SSE2 result is off from the scalar one by %g (tolerance %g)\n", kernel, error, G2_SIMD_TOLERANCE );
+		}
+	}
+}
+
 // nasty little matrix multiply going on here..
 void Multiply_3x4Matrix(mdxaBone_t *out, mdxaBone_t *in2, mdxaBone_t *in)
 {
-	// first row of out
-	out->matrix[0][0] = (in2->matrix[0][0] * in->matrix[0][0]) + (in2->matrix[0][1] * in->matrix[1][0]) + (in2->matrix[0][2] * in->matrix[2][0]);
-	out->matrix[0][1] = (in2->matrix[0][0] * in->matrix[0][1]) + (in2->matrix[0][1] * in->matrix[1][1]) + (in2->matrix[0][2] * in->matrix[2][1]);
-	out->matrix[0][2] = (in2->matrix[0][0] * in->matrix[0][2]) + (in2->matrix[0][1] * in->matrix[1][2]) + (in2->matrix[0][2] * in->matrix[2][2]);
-	out->matrix[0][3] = (in2->matrix[0][0] * in->matrix[0][3]) + (in2->matrix[0][1] * in->matrix[1][3]) + (in2->matrix[0][2] * in->matrix[2][3]) + in2->matrix[0][3];
-	// second row of outf out
-	out->matrix[1][0] = (in2->matrix[1][0] * in->matrix[0][0]) + (in2->matrix[1][1] * in->matrix[1][0]) + (in2->matrix[1][2] * in->matrix[2][0]);
-	out->matrix[1][1] = (in2->matrix[1][0] * in->matrix[0][1]) + (in2->matrix[1][1] * in->matrix[1][1]) + (in2->matrix[1][2] * in->matrix[2][1]);
-	out->matrix[1][2] = (in2->matrix[1][0] * in->matrix[0][2]) + (in2->matrix[1][1] * in->matrix[1][2]) + (in2->matrix[1][2] * in->matrix[2][2]);
-	out->matrix[1][3] = (in2->matrix[1][0] * in->matrix[0][3]) + (in2->matrix[1][1] * in->matrix[1][3]) + (in2->matrix[1][2] * in->matrix[2][3]) + in2->matrix[1][3];
-	// third row of out  out
-	out->matrix[2][0] = (in2->matrix[2][0] * in->matrix[0][0]) + (in2->matrix[2][1] * in->matrix[1][0]) + (in2->matrix[2][2] * in->matrix[2][0]);
-	out->matrix[2][1] = (in2->matrix[2][0] * in->matrix[0][1]) + (in2->matrix[2][1] * in->matrix[1][1]) + (in2->matrix[2][2] * in->matrix[2][1]);
-	out->matrix[2][2] = (in2->matrix[2][0] * in->matrix[0][2]) + (in2->matrix[2][1] * in->matrix[1][2]) + (in2->matrix[2][2] * in->matrix[2][2]);
-	out->matrix[2][3] = (in2->matrix[2][0] * in->matrix[0][3]) + (in2->matrix[2][1] * in->matrix[1][3]) + (in2->matrix[2][2] * in->matrix[2][3]) + in2->matrix[2][3];
+#if idsse2
+	if ( r_g2SimdCheck && r_g2SimdCheck->integer )
+	{
+		mdxaBone_t scalar;
+
+		G2_Multiply3x4_Scalar( &scalar, in2, in );
+		G2_Multiply3x4_SSE2( out, in2, in );
+		G2_CheckSimd( "Multiply_3x4Matrix", &scalar.matrix[0][0], &out->matrix[0][0], 12 );
+		return;
+	}
+
+	G2_Multiply3x4_SSE2( out, in2, in );
+#else
+	G2_Multiply3x4_Scalar( out, in2, in );
+#endif
 }
 
 
@@ -3302,6 +3322,22 @@ Bone  52:   "face_always_":
 */
 
 
+// how much vert space transforming every surface of the most detailed lod takes, see R_TransformEachSurface
+int R_MDXMTransformSize( const mdxmHeader_t *mdxm )
+{
+	const mdxmLOD_t		*lod = (mdxmLOD_t *) ( (byte *)mdxm + mdxm->ofsLODs );
+	const mdxmSurface_t	*surf = (mdxmSurface_t *) ( (byte *)lod + sizeof (mdxmLOD_t) + (mdxm->numSurfaces * sizeof(mdxmLODSurfOffset_t)) );
+	int					size = 0;
+
+	for ( int i = 0 ; i < mdxm->numSurfaces ; i++ )
+	{
+		size += G2_TransformedSurfaceSize( surf->numVerts );
+		surf = (mdxmSurface_t *)( (byte *)surf + surf->ofsEnd );
+	}
+
+	return size;
+}
+
 qboolean R_LoadMDXM( model_t *mod, void *buffer, const char *mod_name, qboolean &bAlreadyCached ) {
 	int					i,l, j;
 	mdxmHeader_t		*pinmodel, *mdxm;
@@ -3383,6 +3419,7 @@ qboolean R_LoadMDXM( model_t *mod, void *buffer, const char *mod_name, qboolean
 
 	if (bAlreadyFound)
 	{
+		mod->g2TransformSize = R_MDXMTransformSize( mdxm );
 		return qtrue;	// All done. Stop, go no further, do not LittleLong(), do not pass Go...
 	}
 
@@ -3519,6 +3556,8 @@ qboolean R_LoadMDXM( model_t *mod, void *buffer, const char *mod_name, qboolean
 		// find the next LOD
 		lod = (mdxmLOD_t *)( (byte *)lod + lod->ofsEnd );
 	}
+
+	mod->g2TransformSize = R_MDXMTransformSize( mdxm );
 	return qtrue;
 }
 
@@ -3722,6 +3761,43 @@ int BoneParentChildIndex(mdxaHeader_t *mdxa, mdxaSkelOffsets_t *offsets, mdxaSke
 }
 #endif //CREATE_LIMB_HIERARCHY
 
+/*
+=================
+R_MDXABuildBoneHash
+
+Index the skeleton by bone name so G2_Find_Skeleton_Bone doesn't have to
+walk every bone in the gla with Q_stricmp. The table lives as long as the model_t.
+=================
+*/
+void R_MDXABuildBoneHash( model_t *mod )
+{
+	const mdxaHeader_t		*mdxa = mod->mdxa;
+	const mdxaSkelOffsets_t	*offsets = (mdxaSkelOffsets_t *)((byte *)mdxa + sizeof(mdxaHeader_t));
+	int						size = 16;
+
+	while ( size < mdxa->numBones * 2 )
+	{
+		size <<= 1;
+	}
+
+	mod->g2BoneHash = (int *)Hunk_Alloc( size * sizeof( int ), h_low );
+	mod->g2BoneHashMask = size - 1;
+	memset( mod->g2BoneHash, -1, size * sizeof( int ) );
+
+	// insert in skeleton order, so with duplicate names the first bone still wins like it did with the linear scan
+	for ( int i = 0 ; i < mdxa->numBones ; i++ )
+	{
+		const mdxaSkel_t *skel = (mdxaSkel_t *)((byte *)mdxa + sizeof(mdxaHeader_t) + offsets->offsets[i]);
+		int h = G2_BoneNameHash( skel->name ) & mod->g2BoneHashMask;
+
+		while ( mod->g2BoneHash[h] != -1 )
+		{
+			h = (h + 1) & mod->g2BoneHashMask;
+		}
+		mod->g2BoneHash[h] = i;
+	}
+}
+
 /*
 =================
 R_LoadMDXA - load a Ghoul 2 animation file
@@ -3927,6 +4003,8 @@ qboolean R_LoadMDXA( model_t *mod, void *buffer, const char *mod_name, qboolean
 		return qfalse;
 	}
 
+	R_MDXABuildBoneHash( mod );
+
 	if (bAlreadyFound)
 	{
 		return qtrue;	// All done, stop here, do not LittleLong() etc. Do not pass go...
@@ -183,6 +183,7 @@ cvar_t	*r_noPrecacheGLA;
 #endif
 
 cvar_t	*r_noServerGhoul2;
+cvar_t	*r_g2SimdCheck;
 cvar_t	*r_Ghoul2AnimSmooth=0;
 cvar_t	*r_Ghoul2UnSqashAfterSmooth=0;
 //cvar_t	*r_Ghoul2UnSqash;
@@ -436,6 +437,7 @@ Ghoul2 Insert Start
 	r_noPrecacheGLA						= ri.Cvar_Get( "r_noPrecacheGLA",					"0",						CVAR_CHEAT, "" );
 #endif
 	r_noServerGhoul2					= ri.Cvar_Get( "r_noserverghoul2",					"0",						CVAR_CHEAT, "" );
+	r_g2SimdCheck						= ri.Cvar_Get( "r_g2SimdCheck",					"0",						CVAR_CHEAT, "Run the Ghoul2 SSE2 kernels against their scalar versions and warn when they disagree" );
 	r_Ghoul2AnimSmooth					= ri.Cvar_Get( "r_ghoul2animsmooth",				"0.3",						CVAR_NONE, "" );
 	r_Ghoul2UnSqashAfterSmooth			= ri.Cvar_Get( "r_ghoul2unsqashaftersmooth",		"1",						CVAR_NONE, "" );
 	broadsword							= ri.Cvar_Get( "broadsword",						"0",						CVAR_NONE, "" );
@@ -590,6 +592,7 @@ refexport_t *GetRefAPI ( int apiVersion, refimport_t *rimp ) {
 	re.G2API_AbsurdSmoothing				= G2API_AbsurdSmoothing;
 	re.G2API_BoltMatrixReconstruction		= G2API_BoltMatrixReconstruction;
 	re.G2API_BoltMatrixSPMethod				= G2API_BoltMatrixSPMethod;
+	re.G2API_BoneLookupStats				= G2_Bone_Lookup_Stats;
 	re.G2API_CleanEntAttachments			= G2API_CleanEntAttachments;
 	re.G2API_CleanGhoul2Models				= G2API_CleanGhoul2Models;
 	re.G2API_ClearAttachedInstance			= G2API_ClearAttachedInstance;
@@ -607,6 +610,7 @@ refexport_t *GetRefAPI ( int apiVersion, refimport_t *rimp ) {
 	re.G2API_GetBoltMatrix					= G2API_GetBoltMatrix;
 	re.G2API_GetBoneAnim					= G2API_GetBoneAnim;
 	re.G2API_GetBoneIndex					= G2API_GetBoneIndex;
+	re.G2API_GetBoneNum						= G2API_GetBoneNum;
 	re.G2API_GetGhoul2ModelFlags			= G2API_GetGhoul2ModelFlags;
 	re.G2API_GetGLAName						= G2API_GetGLAName;
 	re.G2API_GetModelName					= G2API_GetModelName;
@@ -649,8 +653,10 @@ refexport_t *GetRefAPI ( int apiVersion, refimport_t *rimp ) {
 	re.G2API_SetBoneAnglesIndex				= G2API_SetBoneAnglesIndex;
 	re.G2API_SetBoneAnglesMatrix			= G2API_SetBoneAnglesMatrix;
 	re.G2API_SetBoneAnglesMatrixIndex		= G2API_SetBoneAnglesMatrixIndex;
+	re.G2API_SetBoneAnglesNum				= G2API_SetBoneAnglesNum;
 	re.G2API_SetBoneAnim					= G2API_SetBoneAnim;
 	re.G2API_SetBoneAnimIndex				= G2API_SetBoneAnimIndex;
+	re.G2API_SetBoneAnimNum					= G2API_SetBoneAnimNum;
 	re.G2API_SetBoneIKState					= G2API_SetBoneIKState;
 	re.G2API_SetGhoul2ModelIndexes			= G2API_SetGhoul2ModelIndexes;
 	re.G2API_SetGhoul2ModelFlags			= G2API_SetGhoul2ModelFlags;
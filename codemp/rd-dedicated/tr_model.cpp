@@ -697,6 +697,8 @@ qboolean ServerLoadMDXA( model_t *mod, void *buffer, const char *mod_name, qbool
 		return qfalse;
 	}
 
+	R_MDXABuildBoneHash( mod );
+
 	if (bAlreadyFound)
 	{
 		return qtrue;	// All done, stop here, do not LittleLong() etc. Do not pass go...
@@ -828,6 +830,7 @@ qboolean ServerLoadMDXM( model_t *mod, void *buffer, const char *mod_name, qbool
 
 	if (bAlreadyFound)
 	{
+		mod->g2TransformSize = R_MDXMTransformSize( mdxm );
 		return qtrue;	// All done. Stop, go no further, do not LittleLong(), do not pass Go...
 	}
 
@@ -944,6 +947,7 @@ qboolean ServerLoadMDXM( model_t *mod, void *buffer, const char *mod_name, qbool
 		lod = (mdxmLOD_t *)( (byte *)lod + lod->ofsEnd );
 	}
 
+	mod->g2TransformSize = R_MDXMTransformSize( mdxm );
 	return qtrue;
 }
 
@@ -423,10 +423,11 @@ Load
 -------------------------
 */
 
-int CNode::Load( int numNodes, fileHandle_t file )
+int CNode::Load( int numNodes, CNavReader &reader )
 {
 	unsigned int header;
-	FS_Read( &header, sizeof(header), file );
+	if ( !reader.Read( &header, sizeof(header) ) )
+		return false;
 
 	//Validate the header
 	if ( header != NODE_HEADER_ID )
@@ -435,20 +436,28 @@ int CNode::Load( int numNodes, fileHandle_t file )
 	//Get the basic information
 	int i;
 	for ( i = 0; i < 3; i++ )
-		FS_Read( &m_position[i], sizeof( float ), file );
+	{
+		if ( !reader.Read( &m_position[i], sizeof( float ) ) )
+			return false;
+	}
 
-	FS_Read( &m_flags, sizeof( m_flags ), file );
-	FS_Read( &m_ID, sizeof( m_ID ), file );
-	FS_Read( &m_radius, sizeof( m_radius ), file );
+	if ( !reader.Read( &m_flags, sizeof( m_flags ) ) )
+		return false;
+	if ( !reader.Read( &m_ID, sizeof( m_ID ) ) )
+		return false;
+	if ( !reader.Read( &m_radius, sizeof( m_radius ) ) )
+		return false;
 
 	//Get the edge information
-	FS_Read( &m_numEdges, sizeof( m_numEdges ), file );
+	if ( !reader.Read( &m_numEdges, sizeof( m_numEdges ) ) )
+		return false;
 
 	for ( i = 0; i < m_numEdges; i++ )
 	{
 		edge_t	edge;
 
-		FS_Read( &edge, sizeof( edge_t ), file );
+		if ( !reader.Read( &edge, sizeof( edge_t ) ) )
+			return false;
 
 		STL_INSERT( m_edges, edge );
 	}
@@ -456,15 +465,17 @@ int CNode::Load( int numNodes, fileHandle_t file )
 	//Read the node ranks
 	int	numRanks;
 
-	FS_Read( &numRanks, sizeof( numRanks ), file );
+	if ( !reader.Read( &numRanks, sizeof( numRanks ) ) )
+		return false;
+
+	if ( numRanks < 0 || numRanks > reader.Remaining() / (int)sizeof( int ) )
+		return false;
 
 	//Allocate the memory
 	InitRanks( numRanks );
 
-	for ( i = 0; i < numRanks; i++ )
-	{
-		FS_Read( &m_ranks[i], sizeof( int ), file );
-	}
+	if ( !reader.Read( m_ranks, numRanks * sizeof( int ) ) )
+		return false;
 
 	return true;
 }
@@ -606,6 +617,22 @@ Load
 -------------------------
 */
 
+// the last .nav file read, kept so a map_restart or another round on the same
+// map rebuilds the nodes without reading and inflating it again
+static std::vector<byte>	navImage;
+static char					navImageName[MAX_QPATH];
+static int					navImagePak;	// checksum of the pack it came from
+
+bool CNavReader::Read( void *out, int len )
+{
+	if ( len < 0 || len > m_size - m_offset )
+		return false;
+
+	memcpy( out, m_data + m_offset, len );
+	m_offset += len;
+	return true;
+}
+
 bool CNavigator::Load( const char *filename, int checksum )
 {
 	fileHandle_t	file;
@@ -614,39 +641,57 @@ bool CNavigator::Load( const char *filename, int checksum )
 	Free();
 
 	//Attempt to load the file
-	FS_FOpenFileByMode( va( "maps/%s.nav", filename ), &file, FS_READ );
+	int len = FS_FOpenFileByMode( va( "maps/%s.nav", filename ), &file, FS_READ );
 
 	//See if we succeeded
 	if ( file == 0 )
 		return false;
 
+	// loose files could have changed without us knowing, those are always read
+	int pakChecksum = FS_FileHandlePakChecksum( file );
+	if ( !pakChecksum || pakChecksum != navImagePak || len != (int)navImage.size() || Q_stricmp( filename, navImageName ) )
+	{
+		navImage.resize( Q_max( len, 0 ) );
+		navImageName[0] = '\0';
+
+		if ( len > 0 && FS_Read( navImage.data(), len, file ) != len )
+		{
+			FS_FCloseFile( file );
+			return false;
+		}
+
+		Q_strncpyz( navImageName, filename, sizeof( navImageName ) );
+		navImagePak = pakChecksum;
+	}
+
+	FS_FCloseFile( file );
+
+	CNavReader	reader( navImage.data(), (int)navImage.size() );
+
 	//Check the header id
-	int navID = GetLong( file );
+	int navID;
 
-	if ( navID != NAV_HEADER_ID )
-	{
-		FS_FCloseFile( file );
+	if ( !reader.Read( &navID, sizeof( navID ) ) || navID != NAV_HEADER_ID )
 		return false;
-	}
 
 	//Check the checksum to see if this file is out of date
-	int check = GetInt( file );
+	int check;
 
-	if ( check != checksum )
-	{
-		FS_FCloseFile( file );
+	if ( !reader.Read( &check, sizeof( check ) ) || check != checksum )
 		return false;
-	}
 
-	int numNodes = GetInt( file );
+	int numNodes;
+
+	if ( !reader.Read( &numNodes, sizeof( numNodes ) ) )
+		return false;
 
 	for ( int i = 0; i < numNodes; i++ )
 	{
 		CNode	*node = CNode::Create();
 
-		if ( node->Load( numNodes, file ) == false )
+		if ( node->Load( numNodes, reader ) == false )
 		{
-			FS_FCloseFile( file );
+			delete node;
 			return false;
 		}
 
@@ -654,15 +699,14 @@ bool CNavigator::Load( const char *filename, int checksum )
 	}
 
 	//read in the failed edges
-	FS_Read( &failedEdges, sizeof( failedEdges ), file );
+	if ( !reader.Read( &failedEdges, sizeof( failedEdges ) ) )
+		return false;
+
 	for ( int j = 0; j < MAX_FAILED_EDGES; j++ )
 	{
 		m_edgeLookupMap.insert(std::pair<int, int>(failedEdges[j].startID, j));
 	}
 
-
-	FS_FCloseFile( file );
-
 	return true;
 }
 
@@ -72,6 +72,30 @@ public:
 	int		m_cost;
 };
 
+/*
+-------------------------
+CNavReader
+-------------------------
+*/
+
+// a .nav file held in memory, the navigator parses it from here instead of
+// going through FS_Read for every field
+class CNavReader
+{
+public:
+
+	CNavReader( const byte *data, int size ) : m_data( data ), m_size( size ), m_offset( 0 ) {}
+
+	bool Read( void *out, int len );
+	int Remaining( void )	const	{	return m_size - m_offset;	}
+
+protected:
+
+	const byte	*m_data;
+	int			m_size;
+	int			m_offset;
+};
+
 /*
 -------------------------
 CNode
@@ -121,7 +145,7 @@ public:
 	void RemoveFlag( int oldFlag )		{	m_flags &= ~oldFlag; }
 
 	int	Save( int numNodes, fileHandle_t file );
-	int Load( int numNodes, fileHandle_t file );
+	int Load( int numNodes, CNavReader &reader );
 
 protected:
 
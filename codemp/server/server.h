@@ -58,6 +58,21 @@ typedef enum {
 	SS_GAME				// actively running
 } serverState_t;
 
+#define	CLIENT_HISTORY_FRAMES	128		// must be a power of two, a second of frames even at high sv_fps
+#define	CLIENT_HISTORY_MSEC		1000	// furthest back SV_TimeShiftTrace will look
+
+// where each client was at the end of the last few frames, one row of each
+// array per frame so recording and rewinding only touch contiguous memory
+typedef struct clientHistory_s {
+	int			numFrames;		// recorded since the map started, the newest is (numFrames-1) & (CLIENT_HISTORY_FRAMES-1)
+	int			time[CLIENT_HISTORY_FRAMES];
+	uint32_t	solid[CLIENT_HISTORY_FRAMES];	// a bit for each client that could be hit that frame
+	vec3_t		origin[CLIENT_HISTORY_FRAMES][MAX_CLIENTS];
+	vec3_t		mins[CLIENT_HISTORY_FRAMES][MAX_CLIENTS];
+	vec3_t		maxs[CLIENT_HISTORY_FRAMES][MAX_CLIENTS];
+	vec3_t		angles[CLIENT_HISTORY_FRAMES][MAX_CLIENTS];
+} clientHistory_t;
+
 typedef struct server_s {
 	serverState_t	state;
 	qboolean		restarting;			// if true, send configstring changes during SS_LOADING
@@ -68,6 +83,9 @@ typedef struct server_s {
 	int				timeResidual;		// <= 1000 / sv_frame->value
 	int				nextFrameTime;		// when time > nextFrameTime, process world
 	char			*configstrings[MAX_CONFIGSTRINGS];
+	int				pendingConfigstrings[MAX_CONFIGSTRINGS];	// changed but not sent to clients yet, in the order they first changed
+	int				numPendingConfigstrings;
+	qboolean		configstringPending[MAX_CONFIGSTRINGS];
 	svEntity_t		svEntities[MAX_GENTITIES];
 
 	char			*entityParsePoint;	// used during game VM init
@@ -90,6 +108,8 @@ typedef struct server_s {
 
 	char			*mSharedMemory;
 
+	clientHistory_t	clientHistory;		// for SV_TimeShiftTrace
+
 	time_t			realMapTimeStarted;	// time the current map was started
 	qboolean		demosPruned; // whether or not existing demos were cleaned up already
 } server_t;
@@ -135,14 +155,28 @@ typedef struct {
 	int			botReliableAcknowledge; // for bots, need to maintain a separate reliableAcknowledge to record server messages into the demo file
 } demoInfo_t;
 
+// a pk3 mapped once and shared by every client downloading it
+#define	MAX_DOWNLOAD_MAPS			16
+#define	MAX_DOWNLOAD_MAP_WINDOW		64		// blocks in flight, mapped blocks need no buffers
+
+typedef struct downloadMap_s {
+	char		name[MAX_QPATH];
+	byte		*data;
+	int			size;
+	time_t		mtime;				// with the name and size, tells a replaced file from the mapped one
+	int			refCount;
+} downloadMap_t;
+
 
 typedef struct client_s {
 	clientState_t	state;
 	char			userinfo[MAX_INFO_STRING];		// name, etc
+	infoIndex_t		userinfoIndex;			// userinfo split into pairs, see SV_UserinfoIndex
+	qboolean		userinfoIndexed;		// cleared whenever userinfo is set
 
 	qboolean		sentGamedir; //see if he has been sent an svc_setgame
 
-	char			reliableCommands[MAX_RELIABLE_COMMANDS][MAX_STRING_CHARS];
+	char			*reliableCommands[MAX_RELIABLE_COMMANDS];	// ref counted, a broadcast is one string shared by every client
 	int				reliableSequence;		// last added reliable message, not necesarily sent or acknowledged yet
 	int				reliableAcknowledge;	// last acknowledged reliable message
 	int				reliableSent;			// last sent reliable message, not necesarily acknowledged yet
@@ -169,7 +203,9 @@ typedef struct client_s {
 	unsigned char	*downloadBlocks[MAX_DOWNLOAD_WINDOW];	// the buffers for the download blocks
 	int				downloadBlockSize[MAX_DOWNLOAD_WINDOW];
 	qboolean		downloadEOF;		// We have sent the EOF block
+	downloadMap_t	*downloadMap;		// blocks are served from here instead of downloadBlocks
 	int				downloadSendTime;	// time we last got an ack from the client
+	int				downloadCredit;		// bytes SV_SendDownloadMessages may still send, see sv_dlRate
 
 	int				deltaMessage;		// frame last client usercmd message
 	int				lastReliableTime;	// svs.time when reliable command was last received
@@ -183,6 +219,14 @@ typedef struct client_s {
 	int				rate;				// bytes / second
 	int				snapshotMsec;		// requests a snapshot every snapshotMsec unless rate choked
 	int				wishSnaps;			// requested snapshot/sec rate
+	qboolean		gamestateDict;		// gets the gamestate coded with the map's own table
+
+	// when the rate can't keep up, the entity updates that have waited
+	// longest and matter most go first, see SV_PrioritizeSnapshotEntities
+	float			entityPriority[MAX_GENTITIES];
+	int				snapDeferred;		// entity updates held back from the last snapshot
+	int				snapDeferredTotal;
+	int				snapTrimmed;		// snapshots that had updates held back
 	int				pureAuthentic;
 	qboolean		gotCP; // TTimo - additional flag to distinguish between a bad pure checksum, and no cp command at all
 	netchan_t		netchan;
@@ -229,6 +273,14 @@ typedef struct serverStatic_s {
 	int			mostRecentFrameTimes[TRACKED_FRAMETIME_SECONDS * 1000];
 	int			lastFrameTimeIndex;
 	int			lastTime;
+
+	// bytes of reliable traffic avoided, see SV_ReliableStats_f
+	int			frameCsBytesCoalesced;		// configstring values replaced before they were sent
+	int			frameCmdBytesShared;		// broadcast commands not copied for every client
+	int			lastCsBytesCoalesced;
+	int			lastCmdBytesShared;
+	uint64_t	totalCsBytesCoalesced;
+	uint64_t	totalCmdBytesShared;
 } serverStatic_t;
 
 #define SERVER_MAXBANS	1024
@@ -266,6 +318,14 @@ extern	cvar_t	*sv_reconnectlimit;
 extern	cvar_t	*sv_showghoultraces;
 extern	cvar_t	*sv_showloss;
 extern	cvar_t	*sv_padPackets;
+extern	cvar_t	*sv_snapshotPriority;
+extern	cvar_t	*sv_dlWindow;
+extern	cvar_t	*sv_dlRate;
+extern	cvar_t	*sv_preloadNextMap;
+extern	cvar_t	*sv_httpMaxConnections;
+extern	cvar_t	*sv_httpMaxHostConnections;
+extern	cvar_t	*sv_httpConnectTimeout;
+extern	cvar_t	*sv_httpTimeout;
 extern	cvar_t	*sv_killserver;
 extern	cvar_t	*sv_mapname;
 extern	cvar_t	*sv_mapChecksum;
@@ -354,7 +414,11 @@ qboolean SVC_RateLimit( leakyBucket_t *bucket, int burst, int period );
 qboolean SVC_RateLimitAddress( netadr_t from, int burst, int period );
 void SV_FinalMessage (char *message);
 void QDECL SV_SendServerCommand( client_t *cl, const char *fmt, ...);
+const char *SV_ReliableCommand( client_t *client, int sequence );
+void SV_FreeReliableCommands( client_t *client );
+void SV_ReliableStats_f( void );
 void SV_LogSecurityEvent(netadr_t address, const char *description, const char *details);
+void SV_CheckLoadProfile( void );
 bool IsBannedFromRcon(netadr_t from);
 #define NUM_SAVED_SECURITY_PRINTS	(10)
 
@@ -375,6 +439,8 @@ void SV_MasterShutdown (void);
 void SV_SetConfigstring( int index, const char *val );
 void SV_SetConfigstringReal( int index, const char* val, qboolean dontUpdateClients );
 void SV_GetConfigstring( int index, char *buffer, int bufferSize );
+void SV_FlushConfigstrings( void );
+int SV_FindConfigstring( const char *name, int start, int max );
 void SV_UpdateConfigstrings( client_t *client );
 
 void SV_SetUserinfo( int index, const char *val );
@@ -383,6 +449,12 @@ void SV_GetUserinfo( int index, char *buffer, int bufferSize );
 void SV_ChangeMaxClients( void );
 void SV_SpawnServer( char *server, qboolean killBots, ForceReload_e eForceReload );
 
+#ifdef DEDICATED
+void SV_G2VertSpaceFrame( void );
+void SV_G2VertSpace_f( void );
+void SV_G2BoneLookups_f( void );
+#endif
+
 
 
 //
@@ -403,6 +475,7 @@ void SV_DirectConnect( netadr_t from );
 void SV_SendClientMapChange( client_t *client );
 void SV_ExecuteClientMessage( client_t *cl, msg_t *msg );
 void SV_UserinfoChanged( client_t *cl );
+const infoIndex_t *SV_UserinfoIndex( client_t *cl );
 
 void SV_ClientEnterWorld( client_t *client, usercmd_t *cmd );
 void SV_DropClient( client_t *drop, const char *reason );
@@ -411,6 +484,9 @@ void SV_ExecuteClientCommand( client_t *cl, const char *s, qboolean clientOK );
 void SV_ClientThink (client_t *cl, usercmd_t *cmd);
 
 void SV_WriteDownloadToClient( client_t *cl , msg_t *msg );
+void SV_SendDownloadMessages( void );
+void SV_FreeDownloadMaps( void );
+void SV_GamestateSize_f( void );
 
 //
 // sv_curl.cpp
@@ -421,6 +497,7 @@ void SV_CurlInit();
 void SV_CurlShutdown();
 
 void SV_RunTransfers();
+void SV_HTTPGet_f( void );
 
 qboolean SV_SendGETRequest(trsfHandle_t* handle,
 	const char* url,
@@ -563,6 +640,9 @@ int SV_PointContents( const vec3_t p, int passEntityNum );
 
 
 void SV_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int traceFlags, int useLod );
+void SV_TimeShiftTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int traceFlags, int useLod, int time );
+// SV_Trace with the clients where they were at the given time, up to CLIENT_HISTORY_MSEC ago
+void SV_RecordClientHistory( void );
 // mins and maxs are relative
 
 // if the entire move stays in a solid volume, trace.allsolid will be set,
@@ -591,6 +671,9 @@ namespace GeoIP {
 	void Init(void);
 	void Shutdown(void);
 	void GetCountry(const char *ipStr, char *outBuf, int outBufSize);
+	void GetCountry(const netadr_t &from, char *outBuf, int outBufSize);
+	void Prefetch(const netadr_t &from);
+	void Stats_f(void);
 }
 
 //
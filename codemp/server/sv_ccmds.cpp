@@ -293,6 +293,8 @@ static void SV_MapRestart_f( void ) {
 		return;
 	}
 
+	Com_LoadProfileBegin( "SV_MapRestart_f", Cvar_VariableString( "mapname" ) );
+
 	SV_StopAutoRecordDemos();
 
 	// toggle the server bit so clients can detect that a
@@ -325,19 +327,26 @@ static void SV_MapRestart_f( void ) {
 	sv.state = SS_LOADING;
 	sv.restarting = qtrue;
 
+	Com_LoadScopeEnter( "SV_RestartGame" );
 	SV_RestartGame();
+	Com_LoadScopeLeave();
 
 	// run a few frames to allow everything to settle
+	Com_LoadScopeEnter( "settle frames" );
 	for ( i = 0 ;i < 3 ; i++ ) {
+		Com_LoadScopeEnter( "GVM_RunFrame" );
 		GVM_RunFrame( sv.time );
+		Com_LoadScopeLeave();
 		sv.time += 100;
 		svs.time += 100;
 	}
+	Com_LoadScopeLeave();
 
 	sv.state = SS_GAME;
 	sv.restarting = qfalse;
 
 	// connect and begin all the clients
+	Com_LoadScopeEnter( "reconnect clients" );
 	for (i=0 ; i<sv_maxclients->integer ; i++) {
 		client = &svs.clients[i];
 
@@ -356,7 +365,9 @@ static void SV_MapRestart_f( void ) {
 		SV_AddServerCommand( client, "map_restart\n" );
 
 		// connect the client again, without the firstTime flag
+		Com_LoadScopeEnter( "GVM_ClientConnect" );
 		denied = GVM_ClientConnect( i, qfalse, isBot );
+		Com_LoadScopeLeave();
 		if ( denied ) {
 			// this generally shouldn't happen, because the client
 			// was connected before the level change
@@ -375,13 +386,21 @@ static void SV_MapRestart_f( void ) {
 			SV_ClientEnterWorld(client, NULL);
 		}
 	}
+	Com_LoadScopeLeave();
 
 	// run another frame to allow things to look at all the players
+	Com_LoadScopeEnter( "settle frames" );
+	Com_LoadScopeEnter( "GVM_RunFrame" );
 	GVM_RunFrame( sv.time );
+	Com_LoadScopeLeave();
+	Com_LoadScopeLeave();
 	sv.time += 100;
 	svs.time += 100;
 
 	SV_BeginAutoRecordDemos();
+
+	// clients keep their gamestate, so there is nothing to wait for
+	Com_LoadProfileEnd();
 }
 
 //===============================================================
@@ -1248,6 +1267,25 @@ static void SV_PrintSecurityEvents_f(void) {
 		Com_Printf(message.c_str());
 }
 
+static void SV_SnapStats_f( void ) {
+	client_t	*cl;
+	int			i;
+
+	if ( !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	Com_Printf( "cl  rate    held back last snap  total  trimmed snaps  name\n" );
+	Com_Printf( "--  ------  -------------------  -----  -------------  ---------------\n" );
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		if ( cl->state < CS_ACTIVE || cl->netchan.remoteAddress.type == NA_BOT ) {
+			continue;
+		}
+		Com_Printf( "%2i  %6i  %19i  %5i  %13i  %s\n", i, cl->rate, cl->snapDeferred, cl->snapDeferredTotal, cl->snapTrimmed, cl->name );
+	}
+}
+
 static void SV_BanAddr_f( void )
 {
 	SV_AddBanToList( qfalse );
@@ -2061,6 +2099,15 @@ void SV_AddOperatorCommands( void ) {
 	Cmd_AddCommand("rconbanlist", SV_RconBanlist_f, "Lists addresses banned from using rcon");
 	Cmd_AddCommand("userinfo", SV_PrintUserinfo_f, "Prints the userinfo of player(s)");
 	Cmd_AddCommand("securityevents", SV_PrintSecurityEvents_f, "Prints recent security events");
+	Cmd_AddCommand("gamestatesize", SV_GamestateSize_f, "Compares the gamestate size with the standard and the map's own Huffman table");
+	Cmd_AddCommand("snapstats", SV_SnapStats_f, "Prints the entity updates held back from each client to fit their rate");
+	Cmd_AddCommand("reliablestats", SV_ReliableStats_f, "Prints reliable traffic saved by coalescing configstrings and sharing broadcasts");
+	Cmd_AddCommand("httpget", SV_HTTPGet_f, "Fetches a URL through the transfer thread and prints the result");
+	Cmd_AddCommand("geoipstats", GeoIP::Stats_f, "Prints GeoIP cache statistics");
+#ifdef DEDICATED
+	Cmd_AddCommand("g2vertspace", SV_G2VertSpace_f, "Prints Ghoul2 collision vert space usage");
+	Cmd_AddCommand("g2bonelookups", SV_G2BoneLookups_f, "Prints Ghoul2 bone name lookups since the last call");
+#endif
 }
 
 /*
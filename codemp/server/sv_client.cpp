@@ -87,6 +87,11 @@ void SV_GetChallenge( netadr_t from ) {
 	clientChallenge = atoi(Cmd_Argv(1));
 
 	NET_OutOfBandPrint( NS_SERVER, from, "challengeResponse %i %i", challenge, clientChallenge );
+
+	// resolve the country while the client is still handshaking, so connect finds it cached
+	if ( !NET_IsLocalAddress( from ) ) {
+		GeoIP::Prefetch( from );
+	}
 }
 
 /*
@@ -337,6 +342,7 @@ A "connect" OOB command has been received
 */
 void SV_DirectConnect( netadr_t from ) {
 	char		userinfo[MAX_INFO_STRING];
+	infoIndex_t	info;
 	int			i;
 	client_t	*cl, *newcl;
 	client_t	temp;
@@ -345,7 +351,7 @@ void SV_DirectConnect( netadr_t from ) {
 	int			version;
 	int			qport;
 	int			challenge;
-	char		*password;
+	const char	*password;
 	int			startIndex;
 	char		*denied;
 	int			count;
@@ -356,13 +362,15 @@ void SV_DirectConnect( netadr_t from ) {
 	Q_strncpyz(userinfo, Cmd_Argv(1), sizeof(userinfo));
 	FilterStringedName(userinfo);
 
+	// the "ip" added below is the only change made to it, the index doesn't need it
+	Info_BuildIndex(&info, userinfo);
+
 	char country[128] = { 0 };
 	if (NET_IsLocalAddress(from)) {
 		Q_strncpyz(country, "Local address", sizeof(country));
 	}
 	else {
-		const char *ipStr = NET_AdrToString(from);
-		GeoIP::GetCountry(ipStr, country, sizeof(country));
+		GeoIP::GetCountry(from, country, sizeof(country));
 		if (!country[0])
 			Q_strncpyz(country, "Unknown country", sizeof(country));
 	}
@@ -380,7 +388,7 @@ void SV_DirectConnect( netadr_t from ) {
 		return;
 	}
 
-	version = atoi( Info_ValueForKey( userinfo, "protocol" ) );
+	version = atoi( Info_IndexValue( &info, "protocol" ) );
 	if ( version != PROTOCOL_VERSION ) {
 		SV_LogSecurityEvent(from, "Rejected connection: incorrect protocol", va("Country: %s, Userinfo: %s", country, userinfo));
 		if (!SVC_RateLimit(&badBucket, sv_rateLimit_bad_limit->integer, sv_rateLimit_bad_period->integer))
@@ -414,8 +422,8 @@ void SV_DirectConnect( netadr_t from ) {
 		return;
 	}
 
-	challenge = atoi( Info_ValueForKey( userinfo, "challenge" ) );
-	qport = atoi( Info_ValueForKey( userinfo, "qport" ) );
+	challenge = atoi( Info_IndexValue( &info, "challenge" ) );
+	qport = atoi( Info_IndexValue( &info, "qport" ) );
 
 	// quick reject
 	for (i=0,cl=svs.clients ; i < sv_maxclients->integer ; i++,cl++) {
@@ -505,7 +513,7 @@ void SV_DirectConnect( netadr_t from ) {
 	// servers so we can play without having to kick people.
 
 	// check for privateClient password
-	password = Info_ValueForKey( userinfo, "password" );
+	password = Info_IndexValue( &info, "password" );
 	if ( !strcmp( password, sv_privatePassword->string ) ) {
 		startIndex = 0;
 	} else {
@@ -551,7 +559,7 @@ void SV_DirectConnect( netadr_t from ) {
 
 			// notify the in game clients that someone is trying to connect
 			if ( ShouldLogFullServerConnect( from ) ) {
-				SV_SendServerCommand( NULL, "print \"%s^7 is trying to connect\n\"", Info_ValueForKey( userinfo, "name" ) );
+				SV_SendServerCommand( NULL, "print \"%s^7 is trying to connect\n\"", Info_IndexValue( &info, "name" ) );
 			}
 
 			return;
@@ -567,6 +575,7 @@ gotnewcl:
 	// build a new connection
 	// accept the new client
 	// this is the only place a client_t is ever initialized
+	SV_FreeReliableCommands( newcl );
 	*newcl = temp;
 	clientNum = newcl - svs.clients;
 	ent = SV_GentityNum( clientNum );
@@ -580,6 +589,7 @@ gotnewcl:
 
 	// save the userinfo
 	Q_strncpyz( newcl->userinfo, userinfo, sizeof(newcl->userinfo) );
+	newcl->userinfoIndexed = qfalse;
 
 	// get the game a chance to reject this connection or modify the userinfo
 	denied = GVM_ClientConnect( clientNum, qtrue, qfalse ); // firstTime = qtrue
@@ -689,23 +699,35 @@ void SV_DropClient( client_t *drop, const char *reason ) {
 	}
 }
 
-void SV_CreateClientGameStateMessage( client_t *client, msg_t *msg ) {
-	int			start;
-	entityState_t	*base, nullstate;
+/*
+=============================================================================
 
-	// NOTE, MRE: all server->client messages now acknowledge
-	// let the client know which reliable clientCommands we have received
-	MSG_WriteLong( msg, client->lastClientCommand );
+PER-MAP GAMESTATE TABLE
 
-	// send any server commands waiting to be sent first.
-	// we have to do this cause we send the client->reliableSequence
-	// with a gamestate and it sets the clc.serverCommandSequence at
-	// the client side
-	SV_UpdateServerCommandsToClient( client, msg );
+The standard Huffman table knows nothing about the current map's strings.
+Clients that ask with "gsdict" in their userinfo get the gamestate coded
+with a table built from the map's own configstrings and baselines, after
+the weights it was built from. Everyone else, and every demo, gets the
+standard gamestate.
+
+=============================================================================
+*/
+
+typedef struct gamestateDict_s {
+	int			serverId;		// the map the table was built for
+	byte		weights[256];
+	huffman_t	huff;
+} gamestateDict_t;
+
+static gamestateDict_t svGamestateDict = { -1 };
+
+static void SV_WriteGamestate( msg_t *msg, int reliableSequence, int clientNum ) {
+	int			start;
+	entityState_t	*base, nullstate;
 
 	// send the gamestate
 	MSG_WriteByte( msg, svc_gamestate );
-	MSG_WriteLong( msg, client->reliableSequence );
+	MSG_WriteLong( msg, reliableSequence );
 
 	// write the configstrings
 	for ( start = 0 ; start < MAX_CONFIGSTRINGS ; start++ ) {
@@ -729,7 +751,7 @@ void SV_CreateClientGameStateMessage( client_t *client, msg_t *msg ) {
 
 	MSG_WriteByte( msg, svc_EOF );
 
-	MSG_WriteLong( msg, client - svs.clients);
+	MSG_WriteLong( msg, clientNum );
 
 	// write the checksum feed
 	MSG_WriteLong( msg, sv.checksumFeed);
@@ -738,6 +760,124 @@ void SV_CreateClientGameStateMessage( client_t *client, msg_t *msg ) {
 	MSG_WriteShort ( msg, 0 );
 }
 
+/*
+================
+SV_GamestateDict
+
+The table for the current map, built the first time it's asked for
+================
+*/
+static const gamestateDict_t *SV_GamestateDict( void ) {
+	static byte	buf[MAX_MSGLEN];
+	int			counts[256];
+	msg_t		msg;
+	int			i, max;
+
+	if ( svGamestateDict.serverId == sv.serverId ) {
+		return &svGamestateDict;
+	}
+
+	// see what the gamestate sends with the standard table
+	Com_Memset( counts, 0, sizeof( counts ) );
+	MSG_Init( &msg, buf, sizeof( buf ) );
+	msg.allowoverflow = qtrue;
+	msg.huffCounts = counts;
+	SV_WriteGamestate( &msg, 0, 0 );
+
+	for ( i = max = 0 ; i < 256 ; i++ ) {
+		if ( counts[i] > max ) {
+			max = counts[i];
+		}
+	}
+
+	// every symbol has to stay sendable
+	for ( i = 0 ; i < 256 ; i++ ) {
+		svGamestateDict.weights[i] = max ? 1 + counts[i] * 254 / max : 1;
+	}
+
+	MSG_BuildHuffman( &svGamestateDict.huff, svGamestateDict.weights );
+	svGamestateDict.serverId = sv.serverId;
+
+	return &svGamestateDict;
+}
+
+static void SV_CreateGameStateMessage( client_t *client, msg_t *msg, const gamestateDict_t *dict ) {
+	int i;
+
+	// NOTE, MRE: all server->client messages now acknowledge
+	// let the client know which reliable clientCommands we have received
+	MSG_WriteLong( msg, client->lastClientCommand );
+
+	// send any server commands waiting to be sent first.
+	// we have to do this cause we send the client->reliableSequence
+	// with a gamestate and it sets the clc.serverCommandSequence at
+	// the client side
+	SV_UpdateServerCommandsToClient( client, msg );
+
+	if ( dict ) {
+		// everything after the weights uses the map's table
+		MSG_WriteByte( msg, svc_mapdict );
+		for ( i = 0 ; i < 256 ; i++ ) {
+			MSG_WriteByte( msg, dict->weights[i] );
+		}
+		msg->huff = (huffman_t *)&dict->huff;
+	}
+
+	SV_WriteGamestate( msg, client->reliableSequence, client - svs.clients );
+}
+
+void SV_CreateClientGameStateMessage( client_t *client, msg_t *msg ) {
+	SV_CreateGameStateMessage( client, msg, NULL );
+}
+
+/*
+================
+SV_GamestateSize_f
+
+Compares the current map's gamestate with the standard and the map's table
+================
+*/
+void SV_GamestateSize_f( void ) {
+	static byte				buf[MAX_MSGLEN];
+	const gamestateDict_t	*dict;
+	msg_t					msg;
+	client_t				*cl;
+	int						i, standard, table, mapped, clients;
+
+	if ( !com_sv_running->integer || sv.state != SS_GAME ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	MSG_Init( &msg, buf, sizeof( buf ) );
+	msg.allowoverflow = qtrue;
+	SV_WriteGamestate( &msg, 0, 0 );
+	standard = msg.cursize;
+
+	dict = SV_GamestateDict();
+	MSG_Init( &msg, buf, sizeof( buf ) );
+	msg.allowoverflow = qtrue;
+	MSG_WriteByte( &msg, svc_mapdict );
+	for ( i = 0 ; i < 256 ; i++ ) {
+		MSG_WriteByte( &msg, dict->weights[i] );
+	}
+	table = msg.cursize;
+	msg.huff = (huffman_t *)&dict->huff;
+	SV_WriteGamestate( &msg, 0, 0 );
+	mapped = msg.cursize;
+
+	for ( i = clients = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		if ( cl->state >= CS_CONNECTED && cl->gamestateDict ) {
+			clients++;
+		}
+	}
+
+	Com_Printf( "gamestate with the standard table: %6i bytes\n", standard );
+	Com_Printf( "gamestate with the map's table:    %6i bytes (%i of them the table), %.1f%% of the standard\n",
+		mapped, table, standard ? mapped * 100.0f / standard : 0.0f );
+	Com_Printf( "%i connected client%s asked for the map's table\n", clients, clients == 1 ? "" : "s" );
+}
+
 /*
 ================
 SV_SendClientGameState
@@ -755,6 +895,8 @@ void SV_SendClientGameState( client_t *client ) {
 
 	MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
 
+	Com_LoadScopeEnter( "SV_SendClientGameState" );
+
 	// MW - my attempt to fix illegible server message errors caused by
 	// packet fragmentation of initial snapshot.
 	while(client->state&&client->netchan.unsentFragments)
@@ -778,10 +920,13 @@ void SV_SendClientGameState( client_t *client ) {
 	// gamestate message was not just sent, forcing a retransmit
 	client->gamestateMessageNum = client->netchan.outgoingSequence;
 
-	SV_CreateClientGameStateMessage( client, &msg );
+	// demos have to play back on stock clients
+	SV_CreateGameStateMessage( client, &msg, ( client->gamestateDict && !client->demo.demorecording ) ? SV_GamestateDict() : NULL );
 
 	// deliver this to the client
 	SV_SendMessageToClient( &msg, client );
+
+	Com_LoadScopeLeave();
 }
 
 
@@ -843,7 +988,9 @@ void SV_ClientEnterWorld( client_t *client, usercmd_t *cmd ) {
 		memset(&client->lastUsercmd, '\0', sizeof(client->lastUsercmd));
 
 	// call the game begin function
+	Com_LoadScopeEnter( "GVM_ClientBegin" );
 	GVM_ClientBegin( client - svs.clients );
+	Com_LoadScopeLeave();
 
 	SV_BeginAutoRecordDemos();
 }
@@ -856,6 +1003,101 @@ CLIENT COMMAND EXECUTION
 ============================================================
 */
 
+static downloadMap_t svDownloadMaps[MAX_DOWNLOAD_MAPS];
+static int svDownloadTime;		// svs.time SV_SendDownloadMessages last handed out credit
+
+/*
+==================
+SV_MapDownload
+
+Map a file being downloaded, sharing the mapping with every other client
+downloading the same file.  Returns NULL if the file has to be streamed.
+==================
+*/
+static downloadMap_t *SV_MapDownload( const char *name, fileHandle_t f, int size ) {
+	downloadMap_t	*map, *freeMap = NULL;
+	time_t			mtime = FS_FileHandleTime( f );
+	int				i;
+
+	for ( i = 0, map = svDownloadMaps; i < MAX_DOWNLOAD_MAPS; i++, map++ ) {
+		if ( !map->refCount ) {
+			if ( !freeMap )
+				freeMap = map;
+			continue;
+		}
+		// a pak replaced by one of the same size must not be served from the old mapping
+		if ( map->size == size && map->mtime == mtime && mtime != -1 && !Q_stricmp( map->name, name ) ) {
+			map->refCount++;
+			return map;
+		}
+	}
+
+	if ( !freeMap )
+		return NULL;
+
+	freeMap->data = (byte *)FS_SV_MapFile( f, size );
+	if ( !freeMap->data )
+		return NULL;
+
+	Q_strncpyz( freeMap->name, name, sizeof( freeMap->name ) );
+	freeMap->size = size;
+	freeMap->mtime = mtime;
+	freeMap->refCount = 1;
+	return freeMap;
+}
+
+/*
+==================
+SV_ReleaseDownloadMap
+==================
+*/
+static void SV_ReleaseDownloadMap( downloadMap_t *map ) {
+	if ( --map->refCount > 0 )
+		return;
+
+	Sys_UnmapFile( map->data, map->size );
+	Com_Memset( map, 0, sizeof( *map ) );
+}
+
+/*
+==================
+SV_FreeDownloadMaps
+
+Called on shutdown, when the clients holding the mappings are already gone
+==================
+*/
+void SV_FreeDownloadMaps( void ) {
+	int i;
+
+	for ( i = 0; i < MAX_DOWNLOAD_MAPS; i++ ) {
+		if ( svDownloadMaps[i].data ) {
+			Sys_UnmapFile( svDownloadMaps[i].data, svDownloadMaps[i].size );
+		}
+	}
+	Com_Memset( svDownloadMaps, 0, sizeof( svDownloadMaps ) );
+}
+
+/*
+==================
+SV_DownloadBlockSize
+
+A zero-length block is the EOF marker
+==================
+*/
+static int SV_DownloadBlockSize( const client_t *cl, int block ) {
+	int offset;
+
+	if ( !cl->downloadMap )
+		return cl->downloadBlockSize[block % MAX_DOWNLOAD_WINDOW];
+
+	offset = block * MAX_DOWNLOAD_BLKSIZE;
+	if ( offset >= cl->downloadSize )
+		return 0;
+	if ( cl->downloadSize - offset < MAX_DOWNLOAD_BLKSIZE )
+		return cl->downloadSize - offset;
+	return MAX_DOWNLOAD_BLKSIZE;
+}
+
 /*
 ==================
 SV_CloseDownload
@@ -871,6 +1113,10 @@ static void SV_CloseDownload( client_t *cl ) {
 		FS_FCloseFile( cl->download );
 	}
 	cl->download = 0;
+	if ( cl->downloadMap ) {
+		SV_ReleaseDownloadMap( cl->downloadMap );
+		cl->downloadMap = NULL;
+	}
 	*cl->downloadName = 0;
 
 	// Free the temporary buffer space
@@ -932,7 +1178,7 @@ static void SV_NextDownload_f( client_t *cl )
 		Com_DPrintf( "clientDownload: %d : client acknowledge of block %d\n", cl - svs.clients, block );
 
 		// Find out if we are done.  A zero-length block indicates EOF
-		if (cl->downloadBlockSize[cl->downloadClientBlock % MAX_DOWNLOAD_WINDOW] == 0) {
+		if ( SV_DownloadBlockSize( cl, cl->downloadClientBlock ) == 0 ) {
 			Com_Printf( "clientDownload: %d : file \"%s\" completed\n", cl - svs.clients, cl->downloadName );
 			SV_CloseDownload( cl );
 			return;
@@ -967,26 +1213,25 @@ static void SV_BeginDownload_f( client_t *cl ) {
 
 /*
 ==================
-SV_WriteDownloadToClient
+SV_OpenDownload
 
-Check to see if the client wants a file, open it if needed and start pumping the client
-Fill up msg with data
+Check to see if the client wants a file and open it if needed, writing the
+error to msg if it can't be downloaded.  Returns qfalse if there is nothing
+to send.
 ==================
 */
-void SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
+static qboolean SV_OpenDownload(client_t *cl, msg_t *msg)
 {
 	int curindex;
-	int rate;
-	int blockspersnap;
 	int unreferenced = 1;
 	char errorMessage[1024];
 	char pakbuf[MAX_QPATH], *pakptr;
 	int numRefPaks;
 
 	if (!*cl->downloadName)
-		return;	// Nothing being downloaded
+		return qfalse;	// Nothing being downloaded
 
-	if(!cl->download)
+	if(!cl->download && !cl->downloadMap)
 	{
 		qboolean idPack = qfalse;
 		qboolean missionPack = qfalse;
@@ -1078,16 +1323,42 @@ void SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
 
 			if(cl->download)
 				FS_FCloseFile(cl->download);
+			cl->download = 0;
 
-			return;
+			return qfalse;
 		}
 
 		Com_Printf( "clientDownload: %d : beginning \"%s\"\n", (int) (cl - svs.clients), cl->downloadName );
 
+		// serve the blocks straight from a shared mapping if we can, the
+		// mapping outlives the file so don't hold a handle for every client
+		cl->downloadMap = SV_MapDownload( cl->downloadName, cl->download, cl->downloadSize );
+		if ( cl->downloadMap ) {
+			FS_FCloseFile( cl->download );
+			cl->download = 0;
+		}
+
 		// Init
 		cl->downloadCurrentBlock = cl->downloadClientBlock = cl->downloadXmitBlock = 0;
 		cl->downloadCount = 0;
 		cl->downloadEOF = qfalse;
+		cl->downloadCredit = 0;
+	}
+
+	if ( cl->downloadMap ) {
+		// every block is already in memory, just slide the window along
+		int window = Com_Clampi( 1, MAX_DOWNLOAD_MAP_WINDOW, sv_dlWindow->integer );
+		int eofBlock = ( cl->downloadSize + MAX_DOWNLOAD_BLKSIZE - 1 ) / MAX_DOWNLOAD_BLKSIZE;
+		int currentBlock = cl->downloadClientBlock + window;
+
+		if ( currentBlock > eofBlock + 1 )
+			currentBlock = eofBlock + 1;
+		if ( currentBlock > cl->downloadCurrentBlock )
+			cl->downloadCurrentBlock = currentBlock;
+
+		cl->downloadCount = cl->downloadSize;
+		cl->downloadEOF = (qboolean)( cl->downloadCurrentBlock > eofBlock );
+		return qtrue;
 	}
 
 	// Perform any reads that we need to
@@ -1124,38 +1395,29 @@ void SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
 		cl->downloadEOF = qtrue;  // We have added the EOF block
 	}
 
-	// Loop up to window size times based on how many blocks we can fit in the
-	// client snapMsec and rate
-
-	// based on the rate, how many bytes can we fit in the snapMsec time of the client
-	// normal rate / snapshotMsec calculation
-	rate = cl->rate;
-	if ( sv_maxRate->integer ) {
-		if ( sv_maxRate->integer < 1000 ) {
-			Cvar_Set( "sv_MaxRate", "1000" );
-		}
-		if ( sv_maxRate->integer < rate ) {
-			rate = sv_maxRate->integer;
-		}
-	}
+	return qtrue;
+}
 
-	if (!rate) {
-		blockspersnap = 1;
-	} else {
-		blockspersnap = ( (rate * cl->snapshotMsec) / 1000 + MAX_DOWNLOAD_BLKSIZE ) /
-			MAX_DOWNLOAD_BLKSIZE;
-	}
+/*
+==================
+SV_WriteDownloadBlocks
 
-	if (blockspersnap < 0)
-		blockspersnap = 1;
+Write up to maxBlocks blocks of the window, returns the number written
+==================
+*/
+static int SV_WriteDownloadBlocks(client_t *cl, msg_t *msg, int maxBlocks)
+{
+	int curindex;
+	int blockSize;
+	int written = 0;
 
-	while (blockspersnap--) {
+	while (written < maxBlocks) {
 
 		// Write out the next section of the file, if we have already reached our window,
 		// automatically start retransmitting
 
 		if (cl->downloadClientBlock == cl->downloadCurrentBlock)
-			return; // Nothing to transmit
+			break; // Nothing to transmit
 
 		if (cl->downloadXmitBlock == cl->downloadCurrentBlock) {
 			// We have transmitted the complete window, should we start resending?
@@ -1165,11 +1427,12 @@ void SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
 			if (svs.time - cl->downloadSendTime > 1000)
 				cl->downloadXmitBlock = cl->downloadClientBlock;
 			else
-				return;
+				break;
 		}
 
 		// Send current block
 		curindex = (cl->downloadXmitBlock % MAX_DOWNLOAD_WINDOW);
+		blockSize = SV_DownloadBlockSize( cl, cl->downloadXmitBlock );
 
 		MSG_WriteByte( msg, svc_download );
 		MSG_WriteShort( msg, cl->downloadXmitBlock );
@@ -1178,11 +1441,14 @@ void SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
 		if ( cl->downloadXmitBlock == 0 )
 			MSG_WriteLong( msg, cl->downloadSize );
 
-		MSG_WriteShort( msg, cl->downloadBlockSize[curindex] );
+		MSG_WriteShort( msg, blockSize );
 
 		// Write the block
-		if ( cl->downloadBlockSize[curindex] ) {
-			MSG_WriteData( msg, cl->downloadBlocks[curindex], cl->downloadBlockSize[curindex] );
+		if ( blockSize ) {
+			if ( cl->downloadMap )
+				MSG_WriteData( msg, cl->downloadMap->data + cl->downloadXmitBlock * MAX_DOWNLOAD_BLKSIZE, blockSize );
+			else
+				MSG_WriteData( msg, cl->downloadBlocks[curindex], blockSize );
 		}
 
 		Com_DPrintf( "clientDownload: %d : writing block %d\n", (int) (cl - svs.clients), cl->downloadXmitBlock );
@@ -1192,6 +1458,156 @@ void SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
 		cl->downloadXmitBlock++;
 
 		cl->downloadSendTime = svs.time;
+		written++;
+	}
+
+	return written;
+}
+
+/*
+==================
+SV_WriteDownloadToClient
+
+Check to see if the client wants a file, open it if needed and start pumping the client
+Fill up msg with data
+==================
+*/
+void SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
+{
+	int rate;
+	int blockspersnap;
+
+	if ( !SV_OpenDownload( cl, msg ) )
+		return;
+
+	// Loop up to window size times based on how many blocks we can fit in the
+	// client snapMsec and rate
+
+	// based on the rate, how many bytes can we fit in the snapMsec time of the client
+	// normal rate / snapshotMsec calculation
+	rate = cl->rate;
+	if ( sv_maxRate->integer ) {
+		if ( sv_maxRate->integer < 1000 ) {
+			Cvar_Set( "sv_MaxRate", "1000" );
+		}
+		if ( sv_maxRate->integer < rate ) {
+			rate = sv_maxRate->integer;
+		}
+	}
+
+	if (!rate) {
+		blockspersnap = 1;
+	} else {
+		blockspersnap = ( (rate * cl->snapshotMsec) / 1000 + MAX_DOWNLOAD_BLKSIZE ) /
+			MAX_DOWNLOAD_BLKSIZE;
+	}
+
+	if (blockspersnap < 0)
+		blockspersnap = 1;
+
+	SV_WriteDownloadBlocks( cl, msg, blockspersnap );
+}
+
+/*
+==================
+SV_SendDownloadFragments
+
+Send what is left of a fragmented download message, only as far as the
+client's credit goes when paced
+==================
+*/
+static void SV_SendDownloadFragments( client_t *cl, qboolean paced )
+{
+	int start;
+
+	while ( cl->netchan.unsentFragments && ( !paced || cl->downloadCredit > 0 ) ) {
+		start = cl->netchan.unsentFragmentStart;
+		SV_Netchan_TransmitNextFragment( &cl->netchan );
+		cl->downloadCredit -= cl->netchan.unsentFragmentStart - start;
+	}
+}
+
+/*
+==================
+SV_SendDownloadMessages
+
+Keep the window of a mapped download in flight every server frame instead of
+waiting for the next snapshot, so throughput is bound by the client's acks
+rather than the snapshot rate.  sv_dlRate is shared out between the clients
+downloading and every byte sent, fragments included, is paid for from it.
+==================
+*/
+void SV_SendDownloadMessages( void )
+{
+	byte		msgBuffer[MAX_MSGLEN];
+	msg_t		msg;
+	client_t	*cl;
+	int			i, msec, numDownloads, share, maxBlocks;
+	qboolean	paced;
+
+	msec = Com_Clampi( 0, 1000, svs.time - svDownloadTime );
+	svDownloadTime = svs.time;
+
+	if ( sv_dlWindow->integer <= 0 )
+		return;
+
+	numDownloads = 0;
+	for ( i = 0, cl = svs.clients; i < sv_maxclients->integer; i++, cl++ ) {
+		if ( cl->state >= CS_CONNECTED && cl->state != CS_ACTIVE && cl->downloadMap && cl->netchan.remoteAddress.type != NA_BOT )
+			numDownloads++;
+	}
+	if ( !numDownloads )
+		return;
+
+	paced = (qboolean)( sv_dlRate->integer > 0 );
+	share = paced ? (int)( (long long)sv_dlRate->integer * 1024 / numDownloads ) : 0;
+
+	for ( i = 0, cl = svs.clients; i < sv_maxclients->integer; i++, cl++ ) {
+		if ( cl->state < CS_CONNECTED || cl->state == CS_ACTIVE || !cl->downloadMap )
+			continue;
+
+		if ( cl->netchan.remoteAddress.type == NA_BOT )
+			continue;
+
+		// bank no more than a window, so a stalled client can't save up a burst
+		if ( paced ) {
+			cl->downloadCredit = (int)Q_min( (long long)cl->downloadCredit + (long long)share * msec / 1000,
+				(long long)Com_Clampi( 1, MAX_DOWNLOAD_MAP_WINDOW, sv_dlWindow->integer ) * MAX_DOWNLOAD_BLKSIZE );
+		}
+
+		// finish the last message before starting another
+		if ( cl->netchan.unsentFragments ) {
+			SV_SendDownloadFragments( cl, paced );
+			continue;
+		}
+
+		// leave room for the encoding and the trailing svc_EOF
+		maxBlocks = ( MAX_MSGLEN / 2 ) / MAX_DOWNLOAD_BLKSIZE;
+		if ( paced )
+			maxBlocks = Q_min( maxBlocks, cl->downloadCredit / MAX_DOWNLOAD_BLKSIZE );
+		if ( maxBlocks <= 0 )
+			continue;
+
+		if ( !SV_OpenDownload( cl, NULL ) )
+			continue;
+
+		MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
+
+		// all server->client messages acknowledge the reliable clientCommands
+		MSG_WriteLong( &msg, cl->lastClientCommand );
+
+		if ( !SV_WriteDownloadBlocks( cl, &msg, maxBlocks ) )
+			continue;
+
+		cl->frames[cl->netchan.outgoingSequence & PACKET_MASK].messageSize = msg.cursize;
+		cl->frames[cl->netchan.outgoingSequence & PACKET_MASK].messageSent = svs.time;
+		cl->frames[cl->netchan.outgoingSequence & PACKET_MASK].messageAcked = -1;
+
+		SV_Netchan_Transmit( cl, &msg );
+
+		// a fragmented message has only sent its first fragment so far
+		cl->downloadCredit -= cl->netchan.unsentFragments ? cl->netchan.unsentFragmentStart : msg.cursize;
+		SV_SendDownloadFragments( cl, paced );
 	}
 }
 
@@ -1367,6 +1783,23 @@ static void SV_ResetPureClient_f( client_t *cl ) {
 	cl->gotCP = qfalse;
 }
 
+/*
+=================
+SV_UserinfoIndex
+
+The client's userinfo split into pairs, built on the first lookup after it
+was last set
+=================
+*/
+const infoIndex_t *SV_UserinfoIndex( client_t *cl ) {
+	if ( !cl->userinfoIndexed ) {
+		Info_BuildIndex( &cl->userinfoIndex, cl->userinfo );
+		cl->userinfoIndexed = qtrue;
+	}
+
+	return &cl->userinfoIndex;
+}
+
 /*
 =================
 SV_UserinfoChanged
@@ -1376,11 +1809,12 @@ into a more C friendly form.
 =================
 */
 void SV_UserinfoChanged( client_t *cl ) {
-	char	*val=NULL, *ip=NULL;
+	const infoIndex_t *info = SV_UserinfoIndex( cl );
+	const char	*val=NULL, *ip=NULL;
 	int		i=0, len=0;
 
 	// name for C code
-	Q_strncpyz( cl->name, Info_ValueForKey (cl->userinfo, "name"), sizeof(cl->name) );
+	Q_strncpyz( cl->name, Info_IndexValue (info, "name"), sizeof(cl->name) );
 
 	// rate command
 
@@ -1389,7 +1823,7 @@ void SV_UserinfoChanged( client_t *cl ) {
 	if ( Sys_IsLANAddress( cl->netchan.remoteAddress ) && com_dedicated->integer != 2 && sv_lanForceRate->integer == 1 ) {
 		cl->rate = 100000;	// lans should not rate limit
 	} else {
-		val = Info_ValueForKey (cl->userinfo, "rate");
+		val = Info_IndexValue (info, "rate");
 		if (sv_ratePolicy->integer == 1)
 		{
 			// NOTE: what if server sets some dumb sv_clientRate value?
@@ -1409,11 +1843,14 @@ void SV_UserinfoChanged( client_t *cl ) {
 		}
 	}
 
+	// can read a gamestate coded with the map's own table
+	cl->gamestateDict = (qboolean)( atoi( Info_IndexValue( info, "gsdict" ) ) == 1 );
+
 	// snaps command
 	//Note: cl->snapshotMsec is also validated in sv_main.cpp -> SV_CheckCvars if sv_fps, sv_snapsMin or sv_snapsMax is changed
 	int minSnaps = Com_Clampi(1, sv_snapsMax->integer, sv_snapsMin->integer); // between 1 and sv_snapsMax ( 1 <-> 40 )
 	int maxSnaps = Q_min(sv_fps->integer, sv_snapsMax->integer); // can't produce more than sv_fps snapshots/sec, but can send less than sv_fps snapshots/sec
-	val = Info_ValueForKey(cl->userinfo, "snaps");
+	val = Info_IndexValue(info, "snaps");
 	cl->wishSnaps = atoi(val);
 	if (!cl->wishSnaps)
 		cl->wishSnaps = maxSnaps;
@@ -1443,9 +1880,9 @@ void SV_UserinfoChanged( client_t *cl ) {
 	if( NET_IsLocalAddress(cl->netchan.remoteAddress) )
 		ip = "localhost";
 	else
-		ip = (char*)NET_AdrToString( cl->netchan.remoteAddress );
+		ip = NET_AdrToString( cl->netchan.remoteAddress );
 
-	val = Info_ValueForKey( cl->userinfo, "ip" );
+	val = Info_IndexValue( info, "ip" );
 	if( val[0] )
 		len = strlen( ip ) - strlen( val ) + strlen( cl->userinfo );
 	else
@@ -1453,8 +1890,10 @@ void SV_UserinfoChanged( client_t *cl ) {
 
 	if( len >= MAX_INFO_STRING )
 		SV_DropClient( cl, "userinfo string length exceeded" );
-	else
+	else {
 		Info_SetValueForKey( cl->userinfo, "ip", ip );
+		cl->userinfoIndexed = qfalse;
+	}
 }
 
 #define INFO_CHANGE_MIN_INTERVAL	6000 //6 seconds is reasonable I suppose
@@ -1474,6 +1913,7 @@ static void SV_UpdateUserinfo_f( client_t *cl ) {
 
 	Q_strncpyz( cl->userinfo, arg, sizeof(cl->userinfo) );
 	FilterStringedName(cl->userinfo);
+	cl->userinfoIndexed = qfalse;
 
 #ifdef FINAL_BUILD
 	if (cl->lastUserInfoChange > svs.time)
@@ -1681,7 +2121,7 @@ static void SV_UserMove( client_t *cl, msg_t *msg, qboolean delta ) {
 	// also use the message acknowledge
 	key ^= cl->messageAcknowledge;
 	// also use the last acknowledged server command in the key
-	key ^= Com_HashKey(cl->reliableCommands[ cl->reliableAcknowledge & (MAX_RELIABLE_COMMANDS-1) ], 32);
+	key ^= Com_HashKey((char *)SV_ReliableCommand( cl, cl->reliableAcknowledge ), 32);
 
 	Com_Memset( &nullcmd, 0, sizeof(nullcmd) );
 	oldcmd = &nullcmd;
@@ -5,29 +5,38 @@
 
 #include <vector>
 #include <chrono>
+#include <atomic>
+#include <thread>
 #include <curl/curl.h>
 
 // http useragent used to identify the client
 #define HTTP_USERAGENT				"openjkded/1.0"
 
-// hard limits on the transfers
-#define MAX_PARALLEL_CONNECTIONS	5L		// max active handles in the multi, the rest is dormant
-#define MAX_HOST_CONNECTIONS		2L		// max handlers for a given host so we don't DoS them
-#define CONNECT_TIMEOUT_SEC			60L		// timeout in seconds for the connection phase alone
+// hard limits on the transfers, the connection limits and timeouts are the sv_http* cvars
+#define IDLE_CONNECTIONS			16L		// finished connections kept open for reuse by the next transfer to the same host
+#define POLL_TIMEOUT_MSEC			1000	// the transfer thread wakes up at least this often
+#define SHUTDOWN_TIMEOUT_SEC		10		// give up on aborted transfers that don't finish
 #define UPLOAD_RATE_LIMIT			1000000	// transfer upload rate limit in bytes/second
 #define DOWNLOAD_RATE_LIMIT			1000000	// transfer download rate limit in bytes/second
-//CURLOPT_TIMEOUT TODO: this timeout is bad to use in a multi, no total timeout for now
-//CURLOPT_LOW_SPEED_LIMIT: TODO: a companion to implement with the timeout as well
 //CURLOPT_MAXFILESIZE: if file download is implemented (not always transmitted)
 
 // global pointer to the multi interface, null if uninitialized
+// only the transfer thread touches it, apart from curl_multi_wakeup
 static CURLM* globalmcurl = nullptr;
 
-// used to keep track of how many easy handles are alive in the multi
+// the thread driving the multi
+static std::thread* transferThread = nullptr;
+static std::atomic<bool> quitTransferThread(false);
+
+// connection limits wanted by the main thread, applied by the transfer thread
+static std::atomic<long> maxConnections(0);
+static std::atomic<long> maxHostConnections(0);
+
+// used to keep track of how many transfers were queued and not yet finished, main thread only
 static int numActiveTransfers = 0;
 
 // set to true when want to abort all running handles in the multi
-static bool abortAll = false;
+static std::atomic<bool> abortAll(false);
 
 class CurlTransfer {
 	// The base class that represents a transfer and which can be extended to customize
@@ -54,6 +63,10 @@ protected:
 	TrsfResultCallback	callback;		// the callback to send the finalized data to
 	void*				userdata;		// a user defined pointer to pass to callback
 
+public:
+	CurlTransfer*		next;			// link in the queues between the main and transfer threads
+	CURLcode			result;			// the easy handle's result, set by the transfer thread
+
 public:
 	CurlTransfer(CURL* curl, const char* url) {
 		curl_easy_reset(curl);
@@ -62,6 +75,9 @@ public:
 		this->curl = curl;
 		this->active = qfalse;
 
+		this->next = nullptr;
+		this->result = CURLE_OK;
+
 		this->httpHeaders = nullptr;
 		this->postForm = nullptr;
 
@@ -87,9 +103,15 @@ public:
 		SetOpt(CURLOPT_XFERINFODATA, &abortAll);
 
 		// hard limits
-		SetOpt(CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT_SEC);
+		SetOpt(CURLOPT_CONNECTTIMEOUT, (long)sv_httpConnectTimeout->integer);
+		SetOpt(CURLOPT_TIMEOUT, (long)sv_httpTimeout->integer);
 		SetOpt(CURLOPT_MAX_SEND_SPEED_LARGE, (curl_off_t)UPLOAD_RATE_LIMIT);
 		SetOpt(CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)DOWNLOAD_RATE_LIMIT);
+
+		// reuse comes from the multi's connection cache (CURLMOPT_MAXCONNECTS), this
+		// only sends TCP keepalive probes so a NAT or firewall doesn't silently drop
+		// a connection while it idles in that cache
+		SetOpt(CURLOPT_TCP_KEEPALIVE, 1L);
 	}
 
 	virtual ~CurlTransfer() {
@@ -248,9 +270,8 @@ private:
 
 	static int AbortProgressCallback(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
 		// the only purpose of this callback is to abort if told to
-		// clientp contains a pointer to a bool that is true if we should abort
-		// TODO: we can also implement proper timeouts here
-		if (clientp && *((bool*)clientp)) {
+		// clientp contains a pointer to an atomic bool that is true if we should abort
+		if (clientp && ((std::atomic<bool>*)clientp)->load()) {
 			return 1;
 		}
 
@@ -337,6 +358,174 @@ static void CleanupEasyHandle(CURL* curl) {
 	curl_easy_cleanup(curl);
 }
 
+class TransferQueue {
+	// Lock-free list handing transfers between the main thread and the transfer thread.
+	// Any thread can push, and the consumer takes the whole list at once so there is no ABA.
+
+private:
+	std::atomic<CurlTransfer*> head;
+
+public:
+	TransferQueue() : head(nullptr) {
+	}
+
+	void Push(CurlTransfer* transfer) {
+		transfer->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(transfer->next, transfer, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+
+	// returns the list in the order it was pushed
+	CurlTransfer* TakeAll() {
+		CurlTransfer* list = head.exchange(nullptr, std::memory_order_acquire);
+		CurlTransfer* ordered = nullptr;
+
+		while (list) {
+			CurlTransfer* next = list->next;
+			list->next = ordered;
+			ordered = list;
+			list = next;
+		}
+
+		return ordered;
+	}
+};
+
+static TransferQueue submittedTransfers;	// queued by the main thread, attached by the transfer thread
+static TransferQueue finishedTransfers;		// detached by the transfer thread, completed by the main thread
+
+/*
+==================
+SV_TransferThread
+
+Owns the multi handle: attaches queued transfers, sleeps in curl_multi_poll
+until there is socket activity or a wakeup, and hands back finished transfers
+==================
+*/
+static void SV_TransferThread() {
+	long appliedMaxConnections = 0, appliedMaxHostConnections = 0;
+	std::chrono::steady_clock::time_point quitBegin;
+	bool quitting = false;
+	int stillRunning = 0;
+
+	while (true) {
+		CURLMcode mc;
+
+		if (quitTransferThread && !quitting) {
+			quitting = true;
+			quitBegin = std::chrono::steady_clock::now();
+		}
+
+		// cvars changed on the main thread
+		if (appliedMaxConnections != maxConnections || appliedMaxHostConnections != maxHostConnections) {
+			appliedMaxConnections = maxConnections;
+			appliedMaxHostConnections = maxHostConnections;
+			curl_multi_setopt(globalmcurl, CURLMOPT_MAX_TOTAL_CONNECTIONS, appliedMaxConnections);
+			curl_multi_setopt(globalmcurl, CURLMOPT_MAX_HOST_CONNECTIONS, appliedMaxHostConnections);
+		}
+
+		for (CurlTransfer* transfer = submittedTransfers.TakeAll(); transfer; ) {
+			CurlTransfer* next = transfer->next;
+
+			if (!transfer->Attach(globalmcurl)) {
+				transfer->result = CURLE_FAILED_INIT;
+				finishedTransfers.Push(transfer);
+			}
+
+			transfer = next;
+		}
+
+		mc = curl_multi_perform(globalmcurl, &stillRunning);
+
+		if (mc > CURLM_OK) {
+			Com_Printf("(SV_TransferThread) curl_multi_perform: %s\n", curl_multi_strerror(mc));
+		}
+
+		CURLMsg* msg = nullptr;
+		int msgsLeft;
+		while ((msg = curl_multi_info_read(globalmcurl, &msgsLeft))) {
+			// right now only this value is possible, so add a warning for future proofing
+			if (msg->msg != CURLMSG_DONE) {
+				Com_Printf("(SV_TransferThread) unknown message number %d\n", msg->msg);
+				continue;
+			}
+
+			CURL* curl = msg->easy_handle;
+
+			// retrieve the transfer object we stored earlier
+			CurlTransfer* transfer = nullptr;
+			curl_easy_getinfo(curl, CURLINFO_PRIVATE, &transfer);
+
+			if (transfer) {
+				transfer->result = msg->data.result; // the curl_easy_perform return code that the multi got
+				transfer->Detach(globalmcurl);
+				finishedTransfers.Push(transfer);
+			} else {
+				// this should never happen, but if it did it would likely mean memory leaks, so log it
+				Com_Printf("(SV_TransferThread) easy handle has no transfer pointer\n");
+				curl_multi_remove_handle(globalmcurl, curl);
+				curl_easy_cleanup(curl);
+			}
+		}
+
+		if (quitting) {
+			// everything was aborted, wait for the handles to actually finish
+			if (stillRunning <= 0) {
+				break;
+			}
+
+			// a bug in some versions of libcurl can cause an infinite loop if using CURLMOPT_MAX_HOST_CONNECTIONS
+			// i haven't seen the bug happen, but make sure we can't get stuck in a loop here
+			std::chrono::steady_clock::time_point clockNow = std::chrono::steady_clock::now();
+			if (std::chrono::duration_cast<std::chrono::seconds>(clockNow - quitBegin).count() > SHUTDOWN_TIMEOUT_SEC) {
+				Com_Printf("(SV_TransferThread) cleanup took too long, exiting\n");
+				break;
+			}
+		}
+
+		// sleep until a socket is ready, a timeout expires or the main thread wakes us up
+		mc = curl_multi_poll(globalmcurl, NULL, 0, POLL_TIMEOUT_MSEC, NULL);
+
+		if (mc != CURLM_OK) {
+			Com_Printf("(SV_TransferThread) curl_multi_poll: %s\n", curl_multi_strerror(mc));
+		}
+	}
+}
+
+/*
+==================
+SV_QueueTransfer
+
+Hands a fully set up transfer to the transfer thread
+==================
+*/
+static void SV_QueueTransfer(CurlTransfer* transfer) {
+	submittedTransfers.Push(transfer);
+	curl_multi_wakeup(globalmcurl);
+
+	++numActiveTransfers;
+}
+
+/*
+==================
+SV_DiscardTransfers
+
+Frees transfers without invoking their callbacks
+==================
+*/
+static void SV_DiscardTransfers(CurlTransfer* transfer) {
+	while (transfer) {
+		CurlTransfer* next = transfer->next;
+		CURL* curl = transfer->GetCurl();
+
+		Com_Printf("Transfer handle %d cancelled\n", transfer->GetHandle());
+		delete transfer;
+		CleanupEasyHandle(curl);
+
+		transfer = next;
+	}
+}
+
 /*
 ==================
 SV_CurlInit
@@ -368,9 +557,16 @@ void SV_CurlInit() {
 		return;
 	}
 
-	// setup some multi options
-	curl_multi_setopt(globalmcurl, CURLMOPT_MAX_TOTAL_CONNECTIONS, MAX_PARALLEL_CONNECTIONS);
-	curl_multi_setopt(globalmcurl, CURLMOPT_MAX_HOST_CONNECTIONS, MAX_HOST_CONNECTIONS);
+	// setup some multi options, the connection limits are applied by the transfer thread
+	curl_multi_setopt(globalmcurl, CURLMOPT_MAXCONNECTS, IDLE_CONNECTIONS);
+	maxConnections = Com_Clampi(1, 64, sv_httpMaxConnections->integer);
+	maxHostConnections = Com_Clampi(1, 64, sv_httpMaxHostConnections->integer);
+	sv_httpMaxConnections->modified = qfalse;
+	sv_httpMaxHostConnections->modified = qfalse;
+
+	// DNS, TLS and the transfers themselves all run off the main thread
+	quitTransferThread = false;
+	transferThread = new std::thread(SV_TransferThread);
 
 	// print the version string since the dynamic library could be replaced
 	curl_version_info_data* data = curl_version_info(CURLVERSION_NOW);
@@ -389,59 +585,17 @@ void SV_CurlShutdown() {
 		CURLMcode mc;
 
 		// abort and cleanup all the remaining transfers
-
-		int stillRunning;
 		abortAll = true; // this will cause all handles to fail with CURLE_ABORTED_BY_CALLBACK
+		quitTransferThread = true;
+		curl_multi_wakeup(globalmcurl);
 
-		// a bug in some versions of libcurl can cause an infinite loop if using CURLMOPT_MAX_HOST_CONNECTIONS
-		// i haven't seen the bug happen, but make sure we can't get stuck in a loop here
-		std::chrono::steady_clock::time_point clockBegin = std::chrono::steady_clock::now();
-
-		do {
-			mc = curl_multi_perform(globalmcurl, &stillRunning);
+		transferThread->join();
+		delete transferThread;
+		transferThread = nullptr;
 
-			if (mc != CURLM_OK) {
-				Com_Printf("(SV_CurlShutdown) curl_multi_perform: %s\n", curl_multi_strerror(mc));
-				break;
-			}
-
-			// wait at most a second for something to happen at shutdown
-			mc = curl_multi_wait(globalmcurl, NULL, 0, 1000, NULL);
-
-			if (mc != CURLM_OK) {
-				Com_Printf("(SV_CurlShutdown) curl_multi_wait: %s\n", curl_multi_strerror(mc));
-				break;
-			}
-
-			CURLMsg* msg = nullptr;
-			int msgsLeft;
-			while ((msg = curl_multi_info_read(globalmcurl, &msgsLeft))) {
-				if (msg->msg == CURLMSG_DONE) {
-					// this transfer was aborted successfully, free memory without doing any callback
-					CURL* curl = msg->easy_handle;
-					CurlTransfer* transfer = nullptr;
-					curl_easy_getinfo(curl, CURLINFO_PRIVATE, &transfer);
-
-					if (transfer) {
-						transfer->Detach(globalmcurl);
-						Com_Printf("Transfer handle %d cancelled\n", transfer->GetHandle());
-						delete transfer;
-					}
-
-					curl_easy_cleanup(curl);
-				}
-			}
-
-			// this should never happened unless using a bugged libcurl, but in any case don't let this last
-			// infinitely (more than 10 secs). This would cause memory leaks on application shutdown
-			std::chrono::steady_clock::time_point clockNow = std::chrono::steady_clock::now();
-			int secondsElapsed = std::chrono::duration_cast<std::chrono::seconds>(clockNow - clockBegin).count();
-			if (secondsElapsed > 10) {
-				Com_Printf("(SV_CurlShutdown) cleanup took too long, exiting\n");
-				break;
-			}
-
-		} while (stillRunning > 0);
+		// nothing gets a callback at this point, free memory only
+		SV_DiscardTransfers(submittedTransfers.TakeAll());
+		SV_DiscardTransfers(finishedTransfers.TakeAll());
 
 		// cleanup the multi handle
 		mc = curl_multi_cleanup(globalmcurl);
@@ -464,69 +618,53 @@ void SV_CurlShutdown() {
 ==================
 SV_RunTransfers
 
-Performs as much work as possible on queued transfers in a non blocking way.
-Triggers callbacks and cleanups finished transfers.
+Triggers callbacks and cleanups transfers finished by the transfer thread.
 This is meant to be called every frame.
 ==================
 */
 void SV_RunTransfers() {
-	if (numActiveTransfers > 0) {
-		CURLMcode mc;
-
-		int stillRunning;
-		mc = curl_multi_perform(globalmcurl, &stillRunning);
+	if (!globalmcurl) {
+		return;
+	}
 
-		if (mc > CURLM_OK) {
-			Com_Printf("(SV_RunCurlTransfers) curl_multi_perform: %s\n", curl_multi_strerror(mc));
-			return;
-		}
+	if (sv_httpMaxConnections->modified || sv_httpMaxHostConnections->modified) {
+		maxConnections = Com_Clampi(1, 64, sv_httpMaxConnections->integer);
+		maxHostConnections = Com_Clampi(1, 64, sv_httpMaxHostConnections->integer);
+		sv_httpMaxConnections->modified = qfalse;
+		sv_httpMaxHostConnections->modified = qfalse;
+		curl_multi_wakeup(globalmcurl);
+	}
 
-		if (stillRunning < numActiveTransfers) {
-			// at least one or more transfers less running, read all the pending messages
-			numActiveTransfers = stillRunning;
-
-			CURLMsg* msg = nullptr;
-			int msgsLeft;
-			while ((msg = curl_multi_info_read(globalmcurl, &msgsLeft))) {
-				// right now only this value is possible, so add a warning for future proofing
-				if (msg->msg != CURLMSG_DONE) {
-					Com_Printf("(SV_RunCurlTransfers) unknown message number %d\n", msg->msg);
-					continue;
-				}
+	if (numActiveTransfers <= 0) {
+		return;
+	}
 
-				CURL* curl = msg->easy_handle;
+	for (CurlTransfer* transfer = finishedTransfers.TakeAll(); transfer; ) {
+		CurlTransfer* next = transfer->next;
+		CURL* curl = transfer->GetCurl();
 
-				// retrieve the transfer object we stored earlier
-				CurlTransfer* transfer = nullptr;
-				curl_easy_getinfo(curl, CURLINFO_PRIVATE, &transfer);
+		// info about the error if one occured (in which case code > 0)
+		trsfErrorInfo_t errorInfo;
+		errorInfo.code = transfer->result;
+		errorInfo.desc = curl_easy_strerror(transfer->result); // this memory is safe to pass around
 
-				if (transfer) {
-					// info about the error if one occured (in which case code > 0)
-					trsfErrorInfo_t errorInfo;
-					errorInfo.code = msg->data.result; // the curl_easy_perform return code that the multi got
-					errorInfo.desc = curl_easy_strerror(msg->data.result); // this memory is safe to pass around
+		transfer->InvokeCallback(&errorInfo);
 
-					transfer->InvokeCallback(&errorInfo);
-					transfer->Detach(globalmcurl);
+		double totalTimeSeconds;
+		transfer->GetInfo(CURLINFO_TOTAL_TIME, &totalTimeSeconds);
+		if (!errorInfo.code) {
+			Com_Printf("Transfer handle %d completed in %.3f seconds\n", transfer->GetHandle(), totalTimeSeconds);
+		} else {
+			Com_Printf("Transfer handle %d failed after %.3f seconds\n", transfer->GetHandle(), totalTimeSeconds);
+		}
 
-					double totalTimeSeconds;
-					transfer->GetInfo(CURLINFO_TOTAL_TIME, &totalTimeSeconds);
-					if (!errorInfo.code) {
-						Com_Printf("Transfer handle %d completed in %.3f seconds\n", transfer->GetHandle(), totalTimeSeconds);
-					} else {
-						Com_Printf("Transfer handle %d failed after %.3f seconds\n", transfer->GetHandle(), totalTimeSeconds);
-					}
+		delete transfer; // this will invalidate any memory that was passed to the callbacks
 
-					delete transfer; // this will invalidate any memory that was passed to the callbacks
-				} else {
-					// this should never happen, but if it did it would likely mean memory leaks, so log it
-					Com_Printf("(SV_RunCurlTransfers) easy handle has no transfer pointer\n");
-				}
+		// in any case, we MUST cleanup the handle since the transfer wrapper leaves us that memory to manage
+		CleanupEasyHandle(curl);
 
-				// in any case, we MUST cleanup the handle since the transfer wrapper leaves us that memory to manage
-				curl_easy_cleanup(curl);
-			}
-		}
+		--numActiveTransfers;
+		transfer = next;
 	}
 }
 
@@ -574,18 +712,11 @@ qboolean SV_SendGETRequest(trsfHandle_t* handle,
 	transfer->SetNullTerminate(nullTerminate);
 	transfer->SetupHTTP(headerAccept, headerContentType);
 	// a transfer is already a GET by default
-	
-	if (!transfer->Attach(globalmcurl)) {
-		delete transfer;
-		CleanupEasyHandle(curl);
 
-		return qfalse;
-	}
+	SV_QueueTransfer(transfer);
 
 	Com_Printf("GET request handle %d queued [%s]\n", transfer->GetHandle(), url);
 
-	++numActiveTransfers;
-
 	return qtrue;
 }
 
@@ -645,17 +776,10 @@ qboolean SV_SendPOSTRequest(trsfHandle_t* handle,
 	transfer->SetOpt(CURLOPT_POST, 1L);
 	transfer->SetOpt(CURLOPT_COPYPOSTFIELDS, data);
 
-	if (!transfer->Attach(globalmcurl)) {
-		delete transfer;
-		CleanupEasyHandle(curl);
-
-		return qfalse;
-	}
+	SV_QueueTransfer(transfer);
 
 	Com_Printf("POST request handle %d queued [%s]\n", transfer->GetHandle(), url);
 
-	++numActiveTransfers;
-
 	return qtrue;
 }
 
@@ -689,23 +813,51 @@ qboolean SV_SendMultipartPOSTRequest(trsfHandle_t* handle,
 		transfer = new CurlTransfer(curl, url);
 	}
 
+	if (handle) {
+		*handle = transfer->GetHandle();
+	}
+
 	transfer->SetUserdata(userdata);
 	transfer->SetupHTTP(headerAccept, headerContentType);
 	// multipart post specific stuff
 	transfer->SetupMultipart(multiPart, numParts);
 
-	if (!transfer->Attach(globalmcurl)) {
-		delete transfer;
-		CleanupEasyHandle(curl);
+	SV_QueueTransfer(transfer);
 
-		return qfalse;
+	Com_Printf("POST multipart request handle %d queued [%s]\n", transfer->GetHandle(), url);
+
+	return qtrue;
+}
+
+static void HTTPGetResultCallback(trsfHandle_t handle, trsfErrorInfo_t* errorInfo, int responseCode, void* data, size_t size, void* userdata) {
+	if (errorInfo->code) {
+		Com_Printf("httpget %d: %s\n", handle, errorInfo->desc);
+		return;
 	}
 
-	Com_Printf("POST multipart request handle %d queued [%s]\n", transfer->GetHandle(), url);
+	// size includes the null terminator
+	Com_Printf("httpget %d: HTTP %d, %d bytes\n", handle, responseCode, size > 0 ? (int)size - 1 : 0);
+	if (data && size > 1) {
+		Com_Printf("%.256s\n", (const char*)data);
+	}
+}
 
-	++numActiveTransfers;
+/*
+==================
+SV_HTTPGet_f
 
-	return qtrue;
+Exercises the transfer thread, for instance against a local HTTP stub
+==================
+*/
+void SV_HTTPGet_f(void) {
+	if (Cmd_Argc() != 2) {
+		Com_Printf("Usage: httpget <url>\n");
+		return;
+	}
+
+	if (!SV_SendGETRequest(NULL, Cmd_Argv(1), HTTPGetResultCallback)) {
+		Com_Printf("httpget: the transfer system isn't running\n");
+	}
 }
 
 // This callback is common to all VM API calls and is where trap calls are routed from.
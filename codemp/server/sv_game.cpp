@@ -136,13 +136,19 @@ void SV_InitGameProgs( void ) {
 	cvar_t *var = Cvar_Get( "bot_enable", "1", CVAR_LATCH );
 	bot_enable = var ? var->integer : 0;
 
+	Com_LoadScopeEnter( "DB::Load" );
 	DB::Load();
+	Com_LoadScopeLeave();
 	LocationTree::Create();
 
 	svs.gameStarted = qtrue;
+	Com_LoadScopeEnter( "SV_BindGame" );
 	SV_BindGame();
+	Com_LoadScopeLeave();
 
+	Com_LoadScopeEnter( "GVM_InitGame" );
 	SV_InitGame( qfalse );
+	Com_LoadScopeLeave();
 
 	Cbuf_AddText("rconrehashbans\n");
 }
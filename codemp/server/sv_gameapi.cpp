@@ -651,6 +651,19 @@ static qboolean SV_GetEntityToken( char *buffer, int bufferSize ) {
 	}
 }
 
+// the game gets its own log channels, qconsole.log stays the engine's
+static void SV_LogBind( int channel, fileHandle_t f ) {
+	if ( channel == LOGCHAN_CONSOLE )
+		return;
+	Com_LogBind( channel, f );
+}
+
+static qboolean SV_LogPrint( int channel, int level, const char *text ) {
+	if ( channel == LOGCHAN_CONSOLE )
+		return qfalse;
+	return Com_LogPrint( channel, level, text );
+}
+
 static void SV_PrecisionTimerStart( void **timer ) {
 	timing_c *newTimer = new timing_c; //create the new timer
 	*timer = newTimer; //assign the pointer within the pointer to point at the mem addr of our new timer
@@ -1556,6 +1569,21 @@ static qboolean SV_G2API_SetBoneAnim( void *ghoul2, const int modelIndex, const
 	return re->G2API_SetBoneAnim( *((CGhoul2Info_v *)ghoul2), modelIndex, boneName, startFrame, endFrame, flags, animSpeed, currentTime, setFrame, blendTime );
 }
 
+static int SV_G2API_GetBoneNum( void *ghoul2, int modelIndex, const char *boneName ) {
+	if ( !ghoul2 ) return -1;
+	return re->G2API_GetBoneNum( *((CGhoul2Info_v *)ghoul2), modelIndex, boneName );
+}
+
+static qboolean SV_G2API_SetBoneAnglesNum( void *ghoul2, int modelIndex, int boneNum, const vec3_t angles, const int flags, const int up, const int right, const int forward, qhandle_t *modelList, int blendTime , int currentTime ) {
+	if ( !ghoul2 ) return qfalse;
+	return re->G2API_SetBoneAnglesNum( *((CGhoul2Info_v *)ghoul2), modelIndex, boneNum, angles, flags, (const Eorientations)up, (const Eorientations)right, (const Eorientations)forward, modelList, blendTime , currentTime );
+}
+
+static qboolean SV_G2API_SetBoneAnimNum( void *ghoul2, const int modelIndex, int boneNum, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime ) {
+	if ( !ghoul2 ) return qfalse;
+	return re->G2API_SetBoneAnimNum( *((CGhoul2Info_v *)ghoul2), modelIndex, boneNum, startFrame, endFrame, flags, animSpeed, currentTime, setFrame, blendTime );
+}
+
 static qboolean SV_G2API_GetBoneAnim( void *ghoul2, const char *boneName, const int currentTime, float *currentFrame, int *startFrame, int *endFrame, int *flags, float *animSpeed, int *modelList, const int modelIndex ) {
 	if ( !ghoul2 ) return qfalse;
 	CGhoul2Info_v &g2 = *((CGhoul2Info_v *)ghoul2);
@@ -2870,6 +2898,48 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 		LocationTree::ResFree((void *)VMA(1));
 		return 0;
 
+	case G_FIND_CONFIGSTRING:
+		return SV_FindConfigstring((const char *)VMA(1), args[2], args[3]);
+
+	case G_TIMESHIFT_TRACE:
+		SV_TimeShiftTrace( (trace_t *)VMA(1), (const float *)VMA(2), (const float *)VMA(3), (const float *)VMA(4), (const float *)VMA(5), args[6], args[7], args[8], args[9], args[10], args[11] );
+		return 0;
+
+	case G_LOG_BIND:
+		SV_LogBind( args[1], args[2] );
+		return 0;
+
+	case G_LOG_PRINT:
+		return SV_LogPrint( args[1], args[2], (const char *)VMA(3) );
+
+	case G_PD_STORE_BLOB:
+		return PD_StoreBlob( (const char *)VMA(1), args[2], args[3], VMA(4), args[5] );
+
+	case G_PD_LOAD_BLOB:
+		return PD_LoadBlob( (const char *)VMA(1), args[2], args[3], VMA(4), args[5] );
+
+	case G_PD_FILE_CHECKSUM:
+		return PD_FileChecksum( (const char *)VMA(1) );
+
+	case G_LOAD_SCOPE_ENTER:
+		Com_LoadScopeEnter( (const char *)VMA(1) );
+		return 0;
+
+	case G_LOAD_SCOPE_LEAVE:
+		Com_LoadScopeLeave();
+		return 0;
+
+	case G_G2_GETBONENUM:
+		return SV_G2API_GetBoneNum( VMA(1), args[2], (const char *)VMA(3) );
+
+	case G_G2_ANGLEOVERRIDE_NUM:
+		return SV_G2API_SetBoneAnglesNum( VMA(1), args[2], args[3], (float *)VMA(4), args[5], args[6], args[7], args[8],
+							 (qhandle_t *)VMA(9), args[10], args[11] );
+
+	case G_G2_PLAYANIM_NUM:
+		return SV_G2API_SetBoneAnimNum( VMA(1), args[2], args[3], args[4], args[5],
+								args[6], VMF(7), args[8], VMF(9), args[10] );
+
 	default:
 		Com_Error( ERR_DROP, "Bad game system trap: %ld", (long int) args[0] );
 	}
@@ -3208,6 +3278,19 @@ void SV_BindGame( void ) {
 		gi.G2API_OverrideServer					= SV_G2API_OverrideServer;
 		gi.G2API_GetSurfaceName					= SV_G2API_GetSurfaceName;
 
+		gi.FindConfigstring						= SV_FindConfigstring;
+		gi.TimeShiftTrace						= SV_TimeShiftTrace;
+		gi.LogBind								= SV_LogBind;
+		gi.LogPrint								= SV_LogPrint;
+		gi.PD_StoreBlob							= PD_StoreBlob;
+		gi.PD_LoadBlob							= PD_LoadBlob;
+		gi.PD_FileChecksum						= PD_FileChecksum;
+		gi.LoadScopeEnter						= Com_LoadScopeEnter;
+		gi.LoadScopeLeave						= Com_LoadScopeLeave;
+		gi.G2API_GetBoneNum						= SV_G2API_GetBoneNum;
+		gi.G2API_SetBoneAnglesNum				= SV_G2API_SetBoneAnglesNum;
+		gi.G2API_SetBoneAnimNum					= SV_G2API_SetBoneAnimNum;
+
 		GetGameAPI = (GetGameAPI_t)gvm->GetModuleAPI;
 		ret = GetGameAPI( GAME_API_VERSION, &gi );
 		if ( !ret ) {
@@ -3235,15 +3318,21 @@ void SV_UnbindGame( void ) {
 }
 
 void SV_RestartGame( void ) {
+	Com_LoadScopeEnter( "GVM_ShutdownGame" );
 	GVM_ShutdownGame( qtrue );
+	Com_LoadScopeLeave();
 
+	Com_LoadScopeEnter( "VM_Restart" );
 	gvm = VM_Restart( gvm );
 	SV_BindGame();
+	Com_LoadScopeLeave();
 	if ( !gvm ) {
 		svs.gameStarted = qfalse;
 		Com_Error( ERR_DROP, "VM_Restart on game failed" );
 		return;
 	}
 
+	Com_LoadScopeEnter( "GVM_InitGame" );
 	SV_InitGame( qtrue );
+	Com_LoadScopeLeave();
 }
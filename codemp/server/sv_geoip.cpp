@@ -3,9 +3,124 @@ extern "C" {
 	#include "maxminddb.h"
 }
 
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#define GEOIP_CACHE_SIZE	4096	// addresses remembered, the least recently used are evicted
+#define GEOIP_QUEUE_SIZE	256		// prefetches waiting for the resolver, the rest resolve on connect
+
 namespace GeoIP {
 	static MMDB_s *dbHandle = nullptr;
 
+	typedef struct cacheEntry_s {
+		uint32_t	ip;				// network byte order
+		char		country[64];	// empty if the database has no country for it
+	} cacheEntry_t;
+
+	// most recently used at the front, guarded by cacheLock along with everything below
+	static std::list<cacheEntry_t> lru;
+	static std::unordered_map<uint32_t, std::list<cacheEntry_t>::iterator> cache;
+	static std::mutex cacheLock;
+
+	// addresses seen in getchallenge, resolved before they connect
+	static std::thread *resolver = nullptr;
+	static std::deque<uint32_t> pending;
+	static std::condition_variable pendingCv;
+	static bool quitResolver = false;
+
+	static int statHits, statMisses, statPrefetched, statPrefetchDropped;
+
+	// look up an IPv4 address directly, without going through the string parser and getaddrinfo
+	static void LookupAddress(uint32_t ip, char *outBuf, int outBufSize) {
+		struct sockaddr_in sa;
+		int error = MMDB_SUCCESS;
+
+		*outBuf = '\0';
+
+		memset(&sa, 0, sizeof(sa));
+		sa.sin_family = AF_INET;
+		sa.sin_addr.s_addr = ip;
+
+		MMDB_lookup_result_s result = MMDB_lookup_sockaddr(dbHandle, (const struct sockaddr *)&sa, &error);
+		if (error != MMDB_SUCCESS) {
+			Com_DPrintf("GeoIP lookup error: %s\n", MMDB_strerror(error));
+			return;
+		}
+		if (!result.found_entry) {
+			return;
+		}
+
+		// convert it to a country name
+		MMDB_entry_data_s entry_data;
+		if ((error = MMDB_get_value(&result.entry, &entry_data, "country", "names", "en", nullptr)) != MMDB_SUCCESS) {
+			Com_DPrintf("GeoIP get_value error: %s\n", MMDB_strerror(error));
+			return;
+		}
+		if (!entry_data.has_data) {
+			return;
+		}
+
+		// the database string isn't null terminated
+		int len = Q_min((int)entry_data.data_size, outBufSize - 1);
+		memcpy(outBuf, entry_data.utf8_string, len);
+		outBuf[len] = '\0';
+	}
+
+	// cacheLock must be held
+	static void StoreLocked(uint32_t ip, const char *country) {
+		auto it = cache.find(ip);
+
+		if (it != cache.end()) {
+			lru.splice(lru.begin(), lru, it->second);
+		} else {
+			lru.push_front(cacheEntry_t());
+			lru.front().ip = ip;
+			cache[ip] = lru.begin();
+
+			if ((int)cache.size() > GEOIP_CACHE_SIZE) {
+				cache.erase(lru.back().ip);
+				lru.pop_back();
+			}
+		}
+
+		Q_strncpyz(lru.front().country, country, sizeof(lru.front().country));
+	}
+
+	static void ResolverThread(void) {
+		std::unique_lock<std::mutex> l(cacheLock);
+
+		while (true) {
+			pendingCv.wait(l, [] { return quitResolver || !pending.empty(); });
+			if (quitResolver)
+				break;
+
+			uint32_t ip = pending.front();
+			pending.pop_front();
+			if (cache.count(ip))
+				continue;
+
+			char country[64];
+			l.unlock();
+			LookupAddress(ip, country, sizeof(country));
+			l.lock();
+
+			StoreLocked(ip, country);
+			statPrefetched++;
+		}
+	}
+
+	static void ClearCache(void) {
+		std::lock_guard<std::mutex> l(cacheLock);
+
+		lru.clear();
+		cache.clear();
+		pending.clear();
+	}
+
 	void Init(void) {
 		if (dbHandle)
 			return; // already initialized
@@ -21,19 +136,100 @@ namespace GeoIP {
 			Com_Printf("Error initializing GeoIP database %s: %s\n", filename, MMDB_strerror(status));
 			delete dbHandle;
 			dbHandle = nullptr;
+			return;
 		}
+
+		// results from another database can't be trusted
+		ClearCache();
+
+		quitResolver = false;
+		resolver = new std::thread(ResolverThread);
 	}
 
 	void Shutdown(void) {
 		if (!dbHandle)
 			return; // not initialized
 
+		{
+			std::lock_guard<std::mutex> l(cacheLock);
+			quitResolver = true;
+		}
+		pendingCv.notify_one();
+		resolver->join();
+		delete resolver;
+		resolver = nullptr;
+
+		ClearCache();
+
 		MMDB_close(dbHandle);
 		delete dbHandle;
 		dbHandle = nullptr;
 		Com_Printf("GeoIP database unloaded.\n");
 	}
 
+	static void GetCountryIPv4(uint32_t ip, char *outBuf, int outBufSize) {
+		{
+			std::lock_guard<std::mutex> l(cacheLock);
+			auto it = cache.find(ip);
+
+			if (it != cache.end()) {
+				lru.splice(lru.begin(), lru, it->second);
+				Q_strncpyz(outBuf, it->second->country, outBufSize);
+				statHits++;
+				return;
+			}
+
+			statMisses++;
+		}
+
+		char country[64];
+		LookupAddress(ip, country, sizeof(country));
+		Q_strncpyz(outBuf, country, outBufSize);
+
+		std::lock_guard<std::mutex> l(cacheLock);
+		StoreLocked(ip, country);
+	}
+
+	// "a.b.c.d" with an optional ":port"
+	static qboolean ParseIPv4(const char *s, uint32_t *ip) {
+		byte b[4];
+
+		for (int i = 0; i < 4; i++) {
+			int value = 0, digits = 0;
+
+			while (isdigit((unsigned char)*s) && digits < 3) {
+				value = value * 10 + (*s++ - '0');
+				digits++;
+			}
+			if (!digits || value > 255)
+				return qfalse;
+			b[i] = (byte)value;
+
+			if (i < 3 && *s++ != '.')
+				return qfalse;
+		}
+
+		if (*s && *s != ':')
+			return qfalse;
+
+		memcpy(ip, b, sizeof(*ip));
+		return qtrue;
+	}
+
+	static qboolean EnsureInit(void) {
+		if (!sv_countryDetection->integer)
+			return qfalse;
+
+		if (!dbHandle) {
+			// not already initialized; could happen if the cvar was changed mid-game
+			Init();
+			if (!dbHandle)
+				return qfalse;
+		}
+
+		return qtrue;
+	}
+
 	void GetCountry(const char *ipStr, char *outBuf, int outBufSize) {
 		if (!outBuf || outBufSize <= 0) {
 			assert(false);
@@ -42,48 +238,89 @@ namespace GeoIP {
 
 		*outBuf = '\0';
 
-		if (!sv_countryDetection->integer || !VALIDSTRING(ipStr) || !isdigit((unsigned int)*ipStr))
+		if (!VALIDSTRING(ipStr) || !isdigit((unsigned int)*ipStr) || !EnsureInit())
 			return;
 
-		if (!dbHandle) {
-			// not already initialized; could happen if the cvar was changed mid-game
-			Init();
-			if (!dbHandle)
-				return;
+		uint32_t ip;
+		if (ParseIPv4(ipStr, &ip)) {
+			GetCountryIPv4(ip, outBuf, outBufSize);
+			return;
 		}
 
-		// chop off port
-		std::string filtered = std::string(ipStr);
-		filtered = filtered.substr(0, filtered.find(":", 0));
-		ipStr = filtered.c_str();
+		// anything else goes through the string lookup, uncached
+		char filtered[NET_ADDRSTRMAXLEN];
+		Q_strncpyz(filtered, ipStr, sizeof(filtered));
+		char *port = strchr(filtered, ':');
+		if (port)
+			*port = '\0';
 
-		// look up the ip
 		int error = -1, gai_error = -1;
-		MMDB_lookup_result_s result = MMDB_lookup_string(dbHandle, ipStr, &gai_error, &error);
+		MMDB_lookup_result_s result = MMDB_lookup_string(dbHandle, filtered, &gai_error, &error);
 		if (error != MMDB_SUCCESS || gai_error != 0) {
-			Com_DPrintf("GeoIP lookup error for %s: %s\n", ipStr, MMDB_strerror(error));
+			Com_DPrintf("GeoIP lookup error for %s: %s\n", filtered, MMDB_strerror(error));
 			return;
 		}
 		if (!result.found_entry) {
-			Com_DPrintf("GeoIP found no country for %s.\n", ipStr);
+			Com_DPrintf("GeoIP found no country for %s.\n", filtered);
 			return;
 		}
 
-		// convert it to a country name
-		MMDB_entry_s entry = result.entry;
 		MMDB_entry_data_s entry_data;
-		if ((error = MMDB_get_value(&entry, &entry_data, "country", "names", "en", nullptr)) != MMDB_SUCCESS) {
-			Com_DPrintf("GeoIP get_value error for %s: %s\n", ipStr, MMDB_strerror(error));
+		if ((error = MMDB_get_value(&result.entry, &entry_data, "country", "names", "en", nullptr)) != MMDB_SUCCESS || !entry_data.has_data) {
+			Com_DPrintf("GeoIP found no country name for %s.\n", filtered);
 			return;
 		}
-		if (!entry_data.has_data) {
-			Com_DPrintf("GeoIP found no country name for %s.\n", ipStr);
+
+		int len = Q_min((int)entry_data.data_size, outBufSize - 1);
+		memcpy(outBuf, entry_data.utf8_string, len);
+		outBuf[len] = '\0';
+	}
+
+	void GetCountry(const netadr_t &from, char *outBuf, int outBufSize) {
+		if (from.type != NA_IP) {
+			GetCountry(NET_AdrToString(from), outBuf, outBufSize);
 			return;
 		}
 
-		// write to the supplied buffer
-		std::string countryStr = entry_data.utf8_string;
-		countryStr.resize(entry_data.data_size);
-		Q_strncpyz(outBuf, countryStr.c_str(), outBufSize);
+		*outBuf = '\0';
+
+		if (!EnsureInit())
+			return;
+
+		uint32_t ip;
+		memcpy(&ip, from.ip, sizeof(ip));
+		GetCountryIPv4(ip, outBuf, outBufSize);
 	}
-}
\ No newline at end of file
+
+	void Prefetch(const netadr_t &from) {
+		if (from.type != NA_IP || !sv_countryDetection->integer || !dbHandle)
+			return;
+
+		uint32_t ip;
+		memcpy(&ip, from.ip, sizeof(ip));
+
+		{
+			std::lock_guard<std::mutex> l(cacheLock);
+
+			if (cache.count(ip))
+				return;
+
+			if ((int)pending.size() >= GEOIP_QUEUE_SIZE) {
+				statPrefetchDropped++;
+				return;
+			}
+
+			pending.push_back(ip);
+		}
+		pendingCv.notify_one();
+	}
+
+	void Stats_f(void) {
+		std::lock_guard<std::mutex> l(cacheLock);
+		int lookups = statHits + statMisses;
+
+		Com_Printf("GeoIP database %s, %d of %d addresses cached\n", dbHandle ? "loaded" : "not loaded", (int)cache.size(), GEOIP_CACHE_SIZE);
+		Com_Printf("%d lookups, %d hits (%.1f%%), %d misses\n", lookups, statHits, lookups ? 100.0f * statHits / lookups : 0.0f, statMisses);
+		Com_Printf("%d resolved ahead of connecting, %d pending, %d not queued\n", statPrefetched, (int)pending.size(), statPrefetchDropped);
+	}
+}
@@ -136,6 +136,15 @@ void SV_SetConfigstringReal( int index, const char* val, qboolean dontUpdateClie
 		return;
 	}
 
+	if ( !dontUpdateClients && sv.configstringPending[index] ) {
+		// the value still waiting to go out is never going to be sent now
+		for (i = 0, client = svs.clients; i < sv_maxclients->integer ; i++, client++) {
+			if ( client->state >= CS_PRIMED ) {
+				svs.frameCsBytesCoalesced += strlen( sv.configstrings[index] );
+			}
+		}
+	}
+
 	// change the string in sv
 	Z_Free( sv.configstrings[index] );
 	sv.configstrings[index] = CopyString( val );
@@ -145,8 +154,37 @@ void SV_SetConfigstringReal( int index, const char* val, qboolean dontUpdateClie
 	}
 
 	// send it to all the clients if we aren't
-	// spawning a new server
-	if ( sv.state == SS_GAME || sv.restarting ) {
+	// spawning a new server, once the frame is done
+	if ( ( sv.state == SS_GAME || sv.restarting ) && !sv.configstringPending[index] ) {
+		sv.configstringPending[index] = qtrue;
+		sv.pendingConfigstrings[sv.numPendingConfigstrings++] = index;
+	}
+}
+
+/*
+===============
+SV_FlushConfigstrings
+
+Send the configstrings changed since the last flush to the clients. Done at
+the end of the frame, and before any other reliable command so they still
+arrive in the order they were made in.
+===============
+*/
+void SV_FlushConfigstrings( void ) {
+	int			i, j, index, count;
+	client_t	*client;
+
+	count = sv.numPendingConfigstrings;
+	if ( !count ) {
+		return;
+	}
+
+	// sending them queues commands, which flush again
+	sv.numPendingConfigstrings = 0;
+
+	for ( j = 0 ; j < count ; j++ ) {
+		index = sv.pendingConfigstrings[j];
+		sv.configstringPending[index] = qfalse;
 
 		// send the data to all relevent clients
 		for (i = 0, client = svs.clients; i < sv_maxclients->integer ; i++, client++) {
@@ -186,6 +224,39 @@ void SV_GetConfigstring( int index, char *buffer, int bufferSize ) {
 	Q_strncpyz( buffer, sv.configstrings[index], bufferSize );
 }
 
+/*
+===============
+SV_FindConfigstring
+
+Returns the index of name in the configstrings start+1 to start+max-1, or 0 if it
+isn't registered there. Same search the game does for its model/sound indexes,
+without copying each configstring out to it.
+===============
+*/
+int SV_FindConfigstring( const char *name, int start, int max ) {
+	int i;
+
+	if ( start < 0 || max < 0 || start + max > MAX_CONFIGSTRINGS ) {
+		Com_Error (ERR_DROP, "SV_FindConfigstring: bad range %i, %i\n", start, max);
+	}
+	if ( !name || !name[0] ) {
+		return 0;
+	}
+
+	for ( i = 1; i < max; i++ ) {
+		const char *s = sv.configstrings[start + i];
+
+		if ( !s || !s[0] ) {
+			break;
+		}
+		if ( !strcmp( s, name ) ) {
+			return i;
+		}
+	}
+
+	return 0;
+}
+
 /*
 ===============
 SV_SetUserinfo
@@ -202,7 +273,8 @@ void SV_SetUserinfo( int index, const char *val ) {
 	}
 
 	Q_strncpyz( svs.clients[index].userinfo, val, sizeof( svs.clients[ index ].userinfo ) );
-	Q_strncpyz( svs.clients[index].name, Info_ValueForKey( val, "name" ), sizeof(svs.clients[index].name) );
+	svs.clients[index].userinfoIndexed = qfalse;
+	Q_strncpyz( svs.clients[index].name, Info_IndexValue( SV_UserinfoIndex( &svs.clients[index] ), "name" ), sizeof(svs.clients[index].name) );
 }
 
 /*
@@ -354,9 +426,13 @@ void SV_ChangeMaxClients( void ) {
 			oldClients[i] = svs.clients[i];
 		}
 		else {
+			SV_FreeReliableCommands( &svs.clients[i] );
 			Com_Memset(&oldClients[i], 0, sizeof(client_t));
 		}
 	}
+	for ( ; i < oldMaxClients ; i++ ) {
+		SV_FreeReliableCommands( &svs.clients[i] );
+	}
 
 	// free old clients arrays
 	Z_Free( svs.clients );
@@ -511,14 +587,21 @@ void SV_SpawnServer( char *server, qboolean killBots, ForceReload_e eForceReload
 	char		systemInfo[16384];
 	const char	*p;
 
+	// timed until every client has its new gamestate, see SV_CheckLoadProfile
+	Com_LoadProfileBegin( "SV_SpawnServer", server );
+
 	SV_StopAutoRecordDemos();
 
 	SV_SendMapChange();
 
+	Com_LoadScopeEnter( "RegisterMedia_LevelLoadBegin" );
 	re->RegisterMedia_LevelLoadBegin(server, eForceReload);
+	Com_LoadScopeLeave();
 
 	// shut down the existing game if it is running
+	Com_LoadScopeEnter( "SV_ShutdownGameProgs" );
 	SV_ShutdownGameProgs();
+	Com_LoadScopeLeave();
 	svs.gameStarted = qfalse;
 
 	CheckFsGameOverride();
@@ -547,9 +630,12 @@ Ghoul2 Insert End
 
 #ifndef DEDICATED
 	// make sure all the client stuff is unloaded
+	Com_LoadScopeEnter( "CL_ShutdownAll" );
 	CL_ShutdownAll( qfalse );
+	Com_LoadScopeLeave();
 #endif
 
+	Com_LoadScopeEnter( "Hunk_Clear" );
 	CM_ClearMap();
 
 	// clear the whole hunk because we're (re)loading the server
@@ -557,8 +643,10 @@ Ghoul2 Insert End
 
 	re->InitSkins();
 	re->InitShaders(qtrue);
+	Com_LoadScopeLeave();
 
 	// init client structures and svs.numSnapshotEntities
+	Com_LoadScopeEnter( "SV_Startup" );
 	if ( !Cvar_VariableValue("sv_running") ) {
 		SV_Startup();
 	} else {
@@ -567,6 +655,7 @@ Ghoul2 Insert End
 			SV_ChangeMaxClients();
 		}
 	}
+	Com_LoadScopeLeave();
 
 	SV_SendMapChange();
 
@@ -590,7 +679,9 @@ Ghoul2 Insert Start
 	*/
 	if (com_dedicated->integer)
 	{
+		Com_LoadScopeEnter( "SVModelInit" );
 		re->SVModelInit();
+		Com_LoadScopeLeave();
 	}
 
 	SV_SendMapChange();
@@ -606,9 +697,11 @@ Ghoul2 Insert Start
 	svs.nextSnapshotEntities = 0;
 
 	// allocate the snapshot entities
+	Com_LoadScopeEnter( "snapshot entities" );
 	svs.snapshotEntities = new entityState_s[svs.numSnapshotEntities];
 	// we CAN afford to do this here, since we know the STL vectors in Ghoul2 are empty
 	memset(svs.snapshotEntities, 0, sizeof(entityState_t)*svs.numSnapshotEntities);
+	Com_LoadScopeLeave();
 
 /*
 Ghoul2 Insert End
@@ -631,10 +724,12 @@ Ghoul2 Insert End
 	}
 
 	// wipe the entire per-level structure
+	Com_LoadScopeEnter( "SV_ClearServer" );
 	SV_ClearServer();
 	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
 		sv.configstrings[i] = CopyString("");
 	}
+	Com_LoadScopeLeave();
 
 	//rww - RAGDOLL_BEGIN
 	re->G2API_SetTime(sv.time,0);
@@ -646,9 +741,16 @@ Ghoul2 Insert End
 	// get a new checksum feed and restart the file system
 	srand(Com_Milliseconds());
 	sv.checksumFeed = ( ((int) rand() << 16) ^ rand() ) ^ Com_Milliseconds();
+
+	// a background read of this map may still hold a file handle
+	Com_LoadScopeEnter( "FS_Restart" );
+	CM_FinishPreload( qtrue );
 	FS_Restart( sv.checksumFeed );
+	Com_LoadScopeLeave();
 
+	Com_LoadScopeEnter( "CM_LoadMap" );
 	CM_LoadMap( va("maps/%s.bsp", server), qfalse, &checksum );
+	Com_LoadScopeLeave();
 
 	SV_SendMapChange();
 
@@ -677,27 +779,39 @@ Ghoul2 Insert End
 	sv.state = SS_LOADING;
 
 	// load and spawn all other entities
+	Com_LoadScopeEnter( "SV_InitGameProgs" );
 	SV_InitGameProgs();
+	Com_LoadScopeLeave();
 
 	// don't allow a map_restart if game is modified
 	sv_gametype->modified = qfalse;
 
 	// run a few frames to allow everything to settle
+	Com_LoadScopeEnter( "settle frames" );
 	for ( i = 0 ;i < 3 ; i++ ) {
 		//rww - RAGDOLL_BEGIN
 		re->G2API_SetTime(sv.time,0);
 		//rww - RAGDOLL_END
+		Com_LoadScopeEnter( "GVM_RunFrame" );
 		GVM_RunFrame( sv.time );
+		Com_LoadScopeLeave();
+		Com_LoadScopeEnter( "SV_BotFrame" );
 		SV_BotFrame( sv.time );
+		Com_LoadScopeLeave();
 		sv.time += 100;
 		svs.time += 100;
 	}
+	Com_LoadScopeLeave();
 	//rww - RAGDOLL_BEGIN
 	re->G2API_SetTime(sv.time,0);
 	//rww - RAGDOLL_END
 
 	// create a baseline for more efficient communications
+	Com_LoadScopeEnter( "SV_CreateBaseline" );
 	SV_CreateBaseline ();
+	Com_LoadScopeLeave();
+
+	Com_LoadScopeEnter( "reconnect clients" );
 
 	for (i=0 ; i<sv_maxclients->integer ; i++) {
 		// send the new gamestate to all connected clients
@@ -716,7 +830,9 @@ Ghoul2 Insert End
 			}
 
 			// connect the client again
+			Com_LoadScopeEnter( "GVM_ClientConnect" );
 			denied = GVM_ClientConnect( i, qfalse, isBot );	// firstTime = qfalse
+			Com_LoadScopeLeave();
 			if ( denied ) {
 				// this generally shouldn't happen, because the client
 				// was connected before the level change
@@ -740,21 +856,31 @@ Ghoul2 Insert End
 					client->deltaMessage = -1;
 					client->nextSnapshotTime = svs.time;	// generate a snapshot immediately
 
+					Com_LoadScopeEnter( "GVM_ClientBegin" );
 					GVM_ClientBegin( i );
+					Com_LoadScopeLeave();
 				}
 			}
 		}
 	}
+	Com_LoadScopeLeave();
 
 	// run another frame to allow things to look at all the players
+	Com_LoadScopeEnter( "settle frames" );
+	Com_LoadScopeEnter( "GVM_RunFrame" );
 	GVM_RunFrame( sv.time );
+	Com_LoadScopeLeave();
+	Com_LoadScopeEnter( "SV_BotFrame" );
 	SV_BotFrame( sv.time );
+	Com_LoadScopeLeave();
+	Com_LoadScopeLeave();
 	sv.time += 100;
 	svs.time += 100;
 	//rww - RAGDOLL_BEGIN
 	re->G2API_SetTime(sv.time,0);
 	//rww - RAGDOLL_END
 
+	Com_LoadScopeEnter( "pak lists" );
 	if ( sv_pure->integer ) {
 		// the server sends these to the clients so they will only
 		// load pk3s also loaded at the server
@@ -782,6 +908,7 @@ Ghoul2 Insert End
 	Cvar_Set( "sv_referencedPaks", p );
 	p = FS_ReferencedPakNames();
 	Cvar_Set( "sv_referencedPakNames", p );
+	Com_LoadScopeLeave();
 
 	// save systeminfo and serverinfo strings
 	Q_strncpyz( systemInfo, Cvar_InfoString_Big( CVAR_SYSTEMINFO ), sizeof( systemInfo ) );
@@ -799,7 +926,9 @@ Ghoul2 Insert End
 	// send a heartbeat now so the master will get up to date info
 	SV_Heartbeat_f();
 
+	Com_LoadScopeEnter( "Hunk_SetMark" );
 	Hunk_SetMark();
+	Com_LoadScopeLeave();
 
 	/* MrE: 2000-09-13: now called in CL_DownloadsComplete
 	// don't call when running dedicated
@@ -818,6 +947,9 @@ Ghoul2 Insert End
 	}
 
 	SV_BeginAutoRecordDemos();
+
+	// clients still to be sent a gamestate are timed from SV_Frame
+	SV_CheckLoadProfile();
 }
 
 
@@ -832,9 +964,48 @@ void SV_BotInitBotLib(void);
 
 #ifdef DEDICATED
 
+// the vert space is reset once per server frame, so every model transformed for collision during a frame can
+// keep its verts until the next one. it grows (up to the max) when a frame's worth of models doesn't fit.
 #define G2_VERT_SPACE_SERVER_SIZE 256
+#define G2_VERT_SPACE_SERVER_MAX_SIZE 16384
 IHeapAllocator *G2VertSpaceServer = NULL;
-CMiniHeap IHeapAllocator_singleton(G2_VERT_SPACE_SERVER_SIZE * 1024);
+CMiniHeap IHeapAllocator_singleton(G2_VERT_SPACE_SERVER_SIZE * 1024, G2_VERT_SPACE_SERVER_MAX_SIZE * 1024);
+
+/*
+================
+SV_G2VertSpaceFrame
+
+Start a new frame's worth of Ghoul2 collision transforms
+================
+*/
+void SV_G2VertSpaceFrame( void ) {
+	IHeapAllocator_singleton.NewFrame();
+}
+
+/*
+================
+SV_G2VertSpace_f
+================
+*/
+void SV_G2VertSpace_f( void ) {
+	Com_Printf( "Ghoul2 vert space: %d KB (max %d KB)\n", IHeapAllocator_singleton.Size() / 1024, IHeapAllocator_singleton.MaxSize() / 1024 );
+	Com_Printf( "High water mark: %d KB\n", IHeapAllocator_singleton.HighWater() / 1024 );
+	Com_Printf( "Early resets (frame didn't fit): %d\n", IHeapAllocator_singleton.Overflows() );
+}
+
+/*
+================
+SV_G2BoneLookups_f
+
+Report how many Ghoul2 bone name lookups were done since the last call
+================
+*/
+void SV_G2BoneLookups_f( void ) {
+	int lookups, probes;
+
+	re->G2API_BoneLookupStats( &lookups, &probes, qtrue );
+	Com_Printf( "Ghoul2 bone name lookups: %d (%.2f probes each)\n", lookups, lookups ? (float)probes / lookups : 0.0f );
+}
 
 
 /*
@@ -1058,6 +1229,14 @@ void SV_Init (void) {
 	sv_showghoultraces = Cvar_Get ("sv_showghoultraces", "0", 0);
 	sv_showloss = Cvar_Get ("sv_showloss", "0", 0);
 	sv_padPackets = Cvar_Get ("sv_padPackets", "0", 0);
+	sv_httpMaxConnections = Cvar_Get ("sv_httpMaxConnections", "5", CVAR_ARCHIVE_ND, "Maximum simultaneous HTTP connections for game and server transfers, the rest wait their turn" );
+	sv_httpMaxHostConnections = Cvar_Get ("sv_httpMaxHostConnections", "2", CVAR_ARCHIVE_ND, "Maximum simultaneous HTTP connections to a single host" );
+	sv_httpConnectTimeout = Cvar_Get ("sv_httpConnectTimeout", "60", CVAR_ARCHIVE_ND, "Seconds an HTTP transfer may spend connecting" );
+	sv_httpTimeout = Cvar_Get ("sv_httpTimeout", "0", CVAR_ARCHIVE_ND, "Seconds an HTTP transfer may take in total, 0 for no limit" );
+	sv_dlWindow = Cvar_Get ("sv_dlWindow", "16", CVAR_ARCHIVE_ND, "Download blocks kept in flight to each downloading client and sent every server frame, 0 only sends blocks with snapshots" );
+	sv_dlRate = Cvar_Get ("sv_dlRate", "100", CVAR_ARCHIVE_ND, "Total kB/s for the downloads sent every server frame, split evenly between the clients downloading, 0 for no limit" );
+	sv_preloadNextMap = Cvar_Get ("sv_preloadNextMap", "1", CVAR_ARCHIVE_ND, "Read the map in nextmap in the background before the map change" );
+	sv_snapshotPriority = Cvar_Get ("sv_snapshotPriority", "1", CVAR_ARCHIVE_ND, "Hold back the least important entity updates instead of the whole snapshot when a client's rate is saturated" );
 	sv_killserver = Cvar_Get ("sv_killserver", "0", 0);
 	sv_mapChecksum = Cvar_Get ("sv_mapChecksum", "", CVAR_ROM);
 	sv_lanForceRate = Cvar_Get ("sv_lanForceRate", "1", CVAR_ARCHIVE_ND );
@@ -1204,11 +1383,16 @@ Ghoul2 Insert Start
 
 	// free current level
 	SV_ClearServer();
+	CM_FinishPreload( qtrue );
 	CM_ClearMap();//jfm: add a clear here since it's commented out in clearServer.  This prevents crashing cmShaderTable on exit.
 
 	// free server static data
 	if ( svs.clients ) {
+		for ( int i = 0 ; i < sv_maxclients->integer ; i++ ) {
+			SV_FreeReliableCommands( &svs.clients[i] );
+		}
 		Z_Free( svs.clients );
+		SV_FreeDownloadMaps();
 	}
 	Com_Memset( &svs, 0, sizeof( svs ) );
 
@@ -25,6 +25,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "server.h"
 
 #include "ghoul2/ghoul2_shared.h"
+#include "qcommon/cm_public.h"
 #include "sv_gameapi.h"
 
 serverStatic_t	svs;				// persistant server info
@@ -47,6 +48,14 @@ cvar_t	*sv_reconnectlimit;		// minimum seconds between connect messages
 cvar_t	*sv_showghoultraces;	// report ghoul2 traces
 cvar_t	*sv_showloss;			// report when usercmds are lost
 cvar_t	*sv_padPackets;			// add nop bytes to messages
+cvar_t	*sv_snapshotPriority;	// send the most important entity updates first when rate limited
+cvar_t	*sv_dlWindow;			// blocks of a mapped download in flight, sent every frame
+cvar_t	*sv_dlRate;				// kB/s for all of those downloads together
+cvar_t	*sv_preloadNextMap;
+cvar_t	*sv_httpMaxConnections;
+cvar_t	*sv_httpMaxHostConnections;
+cvar_t	*sv_httpConnectTimeout;
+cvar_t	*sv_httpTimeout;
 cvar_t	*sv_killserver;			// menu system can set to 1 to shut server down
 cvar_t	*sv_mapname;
 cvar_t	*sv_mapChecksum;
@@ -142,15 +151,77 @@ char	*SV_ExpandNewlines( char *in ) {
 	return string;
 }
 
+/*
+==============================================================================
+
+RELIABLE COMMANDS
+
+A command is stored once with a reference count, and every client it goes
+to points at that copy until the slot is reused, so a broadcast doesn't
+cost a copy per client.
+
+==============================================================================
+*/
+
+typedef struct reliableCommand_s {
+	int		refCount;
+	char	string[1];
+} reliableCommand_t;
+
+#define RELIABLE_COMMAND( s )	( (reliableCommand_t *)( (s) - offsetof( reliableCommand_t, string ) ) )
+
+static char *SV_NewReliableCommand( const char *cmd ) {
+	reliableCommand_t	*rc;
+	size_t				len = strlen( cmd );
+
+	if ( len > MAX_STRING_CHARS - 1 ) {
+		len = MAX_STRING_CHARS - 1;
+	}
+
+	rc = (reliableCommand_t *)Z_Malloc( offsetof( reliableCommand_t, string ) + len + 1, TAG_CLIENTS, qfalse );
+	rc->refCount = 0;
+	memcpy( rc->string, cmd, len );
+	rc->string[len] = 0;
+
+	return rc->string;
+}
+
+static void SV_ReleaseReliableCommand( char *cmd ) {
+	if ( cmd && --RELIABLE_COMMAND( cmd )->refCount <= 0 ) {
+		Z_Free( RELIABLE_COMMAND( cmd ) );
+	}
+}
+
 /*
 ======================
-SV_AddServerCommand
+SV_ReliableCommand
 
-The given command will be transmitted to the client, and is guaranteed to
-not have future snapshot_t executed before it is executed
+The command the client has in the slot for this sequence, "" if there never was one
 ======================
 */
-void SV_AddServerCommand( client_t *client, const char *cmd ) {
+const char *SV_ReliableCommand( client_t *client, int sequence ) {
+	const char *cmd = client->reliableCommands[ sequence & (MAX_RELIABLE_COMMANDS-1) ];
+
+	return cmd ? cmd : "";
+}
+
+/*
+======================
+SV_FreeReliableCommands
+
+Drop the client's references, before its client_t is cleared or freed
+======================
+*/
+void SV_FreeReliableCommands( client_t *client ) {
+	int i;
+
+	for ( i = 0 ; i < MAX_RELIABLE_COMMANDS ; i++ ) {
+		SV_ReleaseReliableCommand( client->reliableCommands[i] );
+		client->reliableCommands[i] = NULL;
+	}
+}
+
+static void SV_AddReliableCommand( client_t *client, char *cmd ) {
 	int		index, i;
 
 	// do not send commands until the gamestate has been sent
@@ -166,14 +237,42 @@ void SV_AddServerCommand( client_t *client, const char *cmd ) {
 	if ( client->reliableSequence - client->reliableAcknowledge == MAX_RELIABLE_COMMANDS + 1 ) {
 		Com_Printf( "===== pending server commands =====\n" );
 		for ( i = client->reliableAcknowledge + 1 ; i <= client->reliableSequence ; i++ ) {
-			Com_Printf( "cmd %5d: %s\n", i, client->reliableCommands[ i & (MAX_RELIABLE_COMMANDS-1) ] );
+			Com_Printf( "cmd %5d: %s\n", i, SV_ReliableCommand( client, i ) );
 		}
 		Com_Printf( "cmd %5d: %s\n", i, cmd );
 		SV_DropClient( client, "Server command overflow" );
 		return;
 	}
 	index = client->reliableSequence & ( MAX_RELIABLE_COMMANDS - 1 );
-	Q_strncpyz( client->reliableCommands[ index ], cmd, sizeof( client->reliableCommands[ index ] ) );
+	SV_ReleaseReliableCommand( client->reliableCommands[ index ] );
+	client->reliableCommands[ index ] = cmd;
+	RELIABLE_COMMAND( cmd )->refCount++;
+}
+
+/*
+======================
+SV_AddServerCommand
+
+The given command will be transmitted to the client, and is guaranteed to
+not have future snapshot_t executed before it is executed
+======================
+*/
+void SV_AddServerCommand( client_t *client, const char *cmd ) {
+	char	*shared;
+
+	if ( client->state < CS_PRIMED ) {
+		return;
+	}
+
+	// configstring changes made before this command have to get there first
+	SV_FlushConfigstrings();
+
+	shared = SV_NewReliableCommand( cmd );
+	SV_AddReliableCommand( client, shared );
+
+	if ( !RELIABLE_COMMAND( shared )->refCount ) {
+		Z_Free( RELIABLE_COMMAND( shared ) );
+	}
 }
 
 
@@ -190,6 +289,7 @@ void QDECL SV_SendServerCommand(client_t *cl, const char *fmt, ...) {
 	va_list		argptr;
 	byte		message[MAX_MSGLEN];
 	client_t	*client;
+	char		*shared;
 	int			j;
 
 	va_start (argptr,fmt);
@@ -214,12 +314,35 @@ void QDECL SV_SendServerCommand(client_t *cl, const char *fmt, ...) {
 		Com_Printf ("broadcast: %s\n", SV_ExpandNewlines((char *)message) );
 	}
 
-	// send the data to all relevent clients
+	SV_FlushConfigstrings();
+
+	// send the data to all relevent clients, they all share the one copy
+	shared = SV_NewReliableCommand( (char *)message );
+
 	for (j = 0, client = svs.clients; j < sv_maxclients->integer ; j++, client++) {
-		SV_AddServerCommand( client, (char *)message );
+		SV_AddReliableCommand( client, shared );
+	}
+
+	if ( !RELIABLE_COMMAND( shared )->refCount ) {
+		Z_Free( RELIABLE_COMMAND( shared ) );
+	} else {
+		svs.frameCmdBytesShared += ( RELIABLE_COMMAND( shared )->refCount - 1 ) * strlen( shared );
 	}
 }
 
+/*
+=================
+SV_ReliableStats_f
+
+How much reliable traffic coalesced configstrings and shared broadcasts saved
+=================
+*/
+void SV_ReliableStats_f( void ) {
+	Com_Printf( "                        last frame        total\n" );
+	Com_Printf( "configstrings coalesced %10d %12llu bytes\n", svs.lastCsBytesCoalesced, (unsigned long long)svs.totalCsBytesCoalesced );
+	Com_Printf( "broadcasts shared       %10d %12llu bytes\n", svs.lastCmdBytesShared, (unsigned long long)svs.totalCmdBytesShared );
+}
+
 
 /*
 ==============================================================================
@@ -877,8 +1000,7 @@ void SVC_RemoteCommand( netadr_t from, msg_t *msg ) {
 		Q_strncpyz(country, "Local address", sizeof(country));
 	}
 	else {
-		const char *ipStr = NET_AdrToString(from);
-		GeoIP::GetCountry(ipStr, country, sizeof(country));
+		GeoIP::GetCountry(from, country, sizeof(country));
 		if (!country[0])
 			Q_strncpyz(country, "Unknown country", sizeof(country));
 	}
@@ -1174,6 +1296,137 @@ qboolean SV_CheckPaused( void ) {
 	return qtrue;
 }
 
+/*
+==================
+SV_PredictNextMap
+
+Follows nextmap through any vstr chain to the map it will load
+==================
+*/
+static qboolean SV_PredictNextMap( char *mapname, int size ) {
+	char	cmd[MAX_CVAR_VALUE_STRING];
+	char	args[2][MAX_QPATH];
+	int		depth, numArgs, len;
+	const char *p;
+	qboolean followed;
+
+	Cvar_VariableStringBuffer( "nextmap", cmd, sizeof( cmd ) );
+
+	for ( depth = 0; depth < 8; depth++ ) {
+		followed = qfalse;
+
+		for ( p = cmd; *p && !followed; ) {
+			// split off one command, keeping its first two words
+			numArgs = 0;
+			while ( *p && *p != ';' ) {
+				while ( *p == ' ' || *p == '\t' || *p == '"' ) {
+					p++;
+				}
+				if ( !*p || *p == ';' ) {
+					break;
+				}
+
+				len = 0;
+				while ( *p && *p != ';' && *p != ' ' && *p != '\t' && *p != '"' ) {
+					if ( numArgs < 2 && len < MAX_QPATH - 1 ) {
+						args[numArgs][len++] = *p;
+					}
+					p++;
+				}
+				if ( numArgs < 2 ) {
+					args[numArgs][len] = '\0';
+				}
+				numArgs++;
+			}
+			if ( *p == ';' ) {
+				p++;
+			}
+
+			if ( numArgs < 2 ) {
+				continue;
+			}
+			if ( !Q_stricmp( args[0], "map" ) || !Q_stricmp( args[0], "devmap" ) ) {
+				Q_strncpyz( mapname, args[1], size );
+				return qtrue;
+			}
+			if ( !Q_stricmp( args[0], "vstr" ) ) {
+				Cvar_VariableStringBuffer( args[1], cmd, sizeof( cmd ) );
+				followed = qtrue;
+			}
+		}
+
+		if ( !followed ) {
+			break;
+		}
+	}
+
+	return qfalse;
+}
+
+/*
+==================
+SV_PreloadNextMap
+
+Has the collision code read the next map's BSP in the background
+==================
+*/
+static void SV_PreloadNextMap( void ) {
+	static char	lastMap[MAX_QPATH];
+	static int	lastCheck;
+	char		mapname[MAX_QPATH];
+	int			now;
+
+	CM_FinishPreload( qfalse );
+
+	if ( !sv_preloadNextMap->integer || sv.state != SS_GAME ) {
+		return;
+	}
+
+	// the rotation only changes when the game or an admin sets it
+	now = Sys_Milliseconds();
+	if ( now - lastCheck < 1000 ) {
+		return;
+	}
+	lastCheck = now;
+
+	if ( !SV_PredictNextMap( mapname, sizeof( mapname ) ) || !Q_stricmp( mapname, lastMap ) ) {
+		return;
+	}
+
+	if ( CM_PreloadMap( va( "maps/%s.bsp", mapname ) ) ) {
+		Q_strncpyz( lastMap, mapname, sizeof( lastMap ) );
+	}
+}
+
+/*
+==================
+SV_CheckLoadProfile
+
+A map change is timed until the clients that were connected have been sent
+the new gamestate, or for LOAD_PROFILE_WAIT msec if some never ask for it
+==================
+*/
+#define LOAD_PROFILE_WAIT	10000
+
+void SV_CheckLoadProfile( void ) {
+	client_t	*cl;
+	int			i;
+
+	if ( !Com_LoadProfileActive() ) {
+		return;
+	}
+
+	if ( Com_LoadProfileElapsed() < LOAD_PROFILE_WAIT ) {
+		for ( i = 0, cl = svs.clients; i < sv_maxclients->integer; i++, cl++ ) {
+			if ( cl->state == CS_CONNECTED ) {
+				return;
+			}
+		}
+	}
+
+	Com_LoadProfileEnd();
+}
+
 /*
 ==================
 SV_CheckCvars
@@ -1426,8 +1679,13 @@ void SV_Frame( int msec ) {
 		svs.time += frameMsec;
 		sv.time += frameMsec;
 
+#ifdef DEDICATED
+		SV_G2VertSpaceFrame();
+#endif
+
 		// let everything in the world think and move
 		GVM_RunFrame( sv.time );
+		SV_RecordClientHistory();
 		if (!svs.lastTime) {
 			svs.lastTime = Sys_Milliseconds();
 		}
@@ -1473,8 +1731,18 @@ void SV_Frame( int msec ) {
 	// check timeouts
 	SV_CheckTimeouts();
 
+	// only the last value of each configstring changed this frame goes out
+	SV_FlushConfigstrings();
+
+	svs.lastCsBytesCoalesced = svs.frameCsBytesCoalesced;
+	svs.lastCmdBytesShared = svs.frameCmdBytesShared;
+	svs.totalCsBytesCoalesced += svs.frameCsBytesCoalesced;
+	svs.totalCmdBytesShared += svs.frameCmdBytesShared;
+	svs.frameCsBytesCoalesced = svs.frameCmdBytesShared = 0;
+
 	// send messages back to the clients
 	SV_SendClientMessages();
+	SV_SendDownloadMessages();
 
 	SV_CheckCvars();
 
@@ -1483,6 +1751,10 @@ void SV_Frame( int msec ) {
 
 	// run pending curl transfers
 	SV_RunTransfers();
+
+	SV_PreloadNextMap();
+
+	SV_CheckLoadProfile();
 }
 
 //============================================================================
@@ -113,6 +113,238 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 	MSG_WriteBits( msg, (MAX_GENTITIES-1), GENTITYNUM_BITS );	// end of packetentities
 }
 
+/*
+=============================================================================
+
+When a client's rate can't carry everything that changed, the entity
+updates with the most priority built up go out and the rest wait. Priority
+builds up every snapshot an update is held back, faster for near entities
+and for the kinds the client notices most.
+
+A held back entity keeps the state the client already has in the new
+frame, so it deltas to nothing now and to the right thing once it's sent.
+An entity new to the client is left out of the frame until there's room.
+
+=============================================================================
+*/
+
+#define	HEADER_RATE_BYTES	48		// include our header, IP header, and some overhead
+#define	MIN_ENTITY_BYTES	128		// entity updates always get at least this much of a snapshot
+
+static int SV_ClientRate( client_t *client );
+
+typedef struct snapCandidate_s {
+	int				index;			// in the new frame
+	entityState_t	*oldent;		// what the client has, NULL if it's new to them
+	int				bits;			// size of the delta
+	qboolean		mandatory;		// events can't wait, they'd be lost
+	float			priority;
+} snapCandidate_t;
+
+static int QDECL SV_QsortCandidates( const void *a, const void *b ) {
+	const snapCandidate_t *ca = (const snapCandidate_t *)a;
+	const snapCandidate_t *cb = (const snapCandidate_t *)b;
+
+	if ( ca->mandatory != cb->mandatory ) {
+		return ca->mandatory ? -1 : 1;
+	}
+	if ( ca->priority > cb->priority ) {
+		return -1;
+	}
+	if ( ca->priority < cb->priority ) {
+		return 1;
+	}
+	return ca->index - cb->index;
+}
+
+static int SV_DeltaEntityBits( entityState_t *from, entityState_t *to, qboolean force ) {
+	static byte	buf[MAX_MSGLEN];
+	msg_t		msg;
+
+	MSG_Init( &msg, buf, sizeof( buf ) );
+	MSG_WriteDeltaEntity( &msg, from, to, force );
+
+	return msg.bit;
+}
+
+static float SV_EntityUpdatePriority( const clientSnapshot_t *frame, const entityState_t *s ) {
+	sharedEntity_t	*ent = SV_GentityNum( s->number );
+	vec3_t			delta;
+	float			weight;
+
+	switch ( s->eType ) {
+	case ET_PLAYER:
+	case ET_NPC:
+		weight = 4.0f;
+		break;
+	case ET_MISSILE:
+	case ET_MOVER:
+		weight = 3.0f;
+		break;
+	default:
+		weight = 1.0f;
+		break;
+	}
+
+	VectorSubtract( ent->r.currentOrigin, frame->ps.origin, delta );
+
+	return weight * 512.0f / ( 512.0f + VectorLength( delta ) );
+}
+
+/*
+=============
+SV_PrioritizeSnapshotEntities
+
+Holds back the entity updates that don't fit the client's rate
+=============
+*/
+static void SV_PrioritizeSnapshotEntities( client_t *client, clientSnapshot_t *from, clientSnapshot_t *to, msg_t *msg ) {
+	static snapCandidate_t	candidates[MAX_SNAPSHOT_ENTITIES];
+	static qboolean			dropped[MAX_SNAPSHOT_ENTITIES];
+	entityState_t	*oldent, *newent;
+	int		oldindex, newindex;
+	int		oldnum, newnum;
+	int		from_num_entities;
+	int		numCandidates, totalBits, budgetBytes, budgetBits, snapMsec;
+	int		i, count;
+
+	if ( !sv_snapshotPriority->integer || client->netchan.remoteAddress.type == NA_LOOPBACK || client->netchan.remoteAddress.type == NA_BOT ) {
+		return;
+	}
+	if ( sv_lanForceRate->integer && Sys_IsLANAddress( client->netchan.remoteAddress ) ) {
+		return;
+	}
+
+	// only worth measuring once the rate is what's holding the client back
+	if ( !client->rateDelayed && !client->snapDeferred ) {
+		return;
+	}
+
+	from_num_entities = from ? from->num_entities : 0;
+	numCandidates = 0;
+	totalBits = GENTITYNUM_BITS;	// end of packetentities
+
+	newent = NULL;
+	oldent = NULL;
+	newindex = 0;
+	oldindex = 0;
+	while ( newindex < to->num_entities || oldindex < from_num_entities ) {
+		snapCandidate_t *c;
+
+		if ( newindex >= to->num_entities ) {
+			newnum = 9999;
+		} else {
+			newent = &svs.snapshotEntities[(to->first_entity+newindex) % svs.numSnapshotEntities];
+			newnum = newent->number;
+		}
+
+		if ( oldindex >= from_num_entities ) {
+			oldnum = 9999;
+		} else {
+			oldent = &svs.snapshotEntities[(from->first_entity+oldindex) % svs.numSnapshotEntities];
+			oldnum = oldent->number;
+		}
+
+		if ( newnum > oldnum ) {
+			// removals are a few bits and always go
+			totalBits += GENTITYNUM_BITS + 1;
+			client->entityPriority[oldnum] = 0.0f;
+			oldindex++;
+			continue;
+		}
+
+		c = &candidates[numCandidates];
+		c->index = newindex;
+		if ( newnum == oldnum ) {
+			c->oldent = oldent;
+			c->bits = SV_DeltaEntityBits( oldent, newent, qfalse );
+			c->mandatory = (qboolean)( newent->event != oldent->event );
+			oldindex++;
+		} else {
+			c->oldent = NULL;
+			c->bits = SV_DeltaEntityBits( &sv.svEntities[newnum].baseline, newent, qtrue );
+			c->mandatory = (qboolean)( newent->eType >= ET_EVENTS );
+		}
+		newindex++;
+
+		if ( !c->bits ) {
+			// nothing changed
+			client->entityPriority[newnum] = 0.0f;
+			continue;
+		}
+
+		client->entityPriority[newnum] += SV_EntityUpdatePriority( to, newent );
+		c->priority = client->entityPriority[newnum];
+		totalBits += c->bits;
+		numCandidates++;
+	}
+
+	snapMsec = client->snapshotMsec > 0 ? client->snapshotMsec : 1000 / sv_fps->integer;
+	budgetBytes = SV_ClientRate( client ) * snapMsec / 1000 - HEADER_RATE_BYTES - msg->cursize;
+	if ( budgetBytes < MIN_ENTITY_BYTES ) {
+		budgetBytes = MIN_ENTITY_BYTES;
+	}
+	budgetBits = budgetBytes * 8;
+
+	if ( totalBits <= budgetBits ) {
+		// everything fits
+		for ( i = 0 ; i < numCandidates ; i++ ) {
+			newent = &svs.snapshotEntities[(to->first_entity+candidates[i].index) % svs.numSnapshotEntities];
+			client->entityPriority[newent->number] = 0.0f;
+		}
+		client->snapDeferred = 0;
+		return;
+	}
+
+	qsort( candidates, numCandidates, sizeof( candidates[0] ), SV_QsortCandidates );
+
+	budgetBits -= totalBits;
+	for ( i = 0 ; i < numCandidates ; i++ ) {
+		budgetBits += candidates[i].bits;
+	}
+
+	count = 0;
+	Com_Memset( dropped, 0, to->num_entities * sizeof( dropped[0] ) );
+	for ( i = 0 ; i < numCandidates ; i++ ) {
+		snapCandidate_t *c = &candidates[i];
+
+		newent = &svs.snapshotEntities[(to->first_entity+c->index) % svs.numSnapshotEntities];
+
+		if ( c->mandatory || c->bits <= budgetBits ) {
+			budgetBits -= c->bits;
+			client->entityPriority[newent->number] = 0.0f;
+			continue;
+		}
+
+		// hold it back
+		if ( c->oldent ) {
+			*newent = *c->oldent;
+		} else {
+			dropped[c->index] = qtrue;
+		}
+		count++;
+	}
+
+	// take the new entities that have to wait out of the frame
+	for ( i = newindex = 0 ; i < to->num_entities ; i++ ) {
+		if ( dropped[i] ) {
+			continue;
+		}
+		if ( newindex != i ) {
+			svs.snapshotEntities[(to->first_entity+newindex) % svs.numSnapshotEntities] =
+				svs.snapshotEntities[(to->first_entity+i) % svs.numSnapshotEntities];
+		}
+		newindex++;
+	}
+	to->num_entities = newindex;
+
+	client->snapDeferred = count;
+	if ( count ) {
+		client->snapDeferredTotal += count;
+		client->snapTrimmed++;
+	}
+}
+
 
 
 /*
@@ -261,6 +493,7 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 	}
 
 	// delta encode the entities
+	SV_PrioritizeSnapshotEntities (client, oldframe, frame, msg);
 	SV_EmitPacketEntities (oldframe, frame, msg);
 
 	// padding for rate debugging
@@ -293,7 +526,7 @@ void SV_UpdateServerCommandsToClient( client_t *client, msg_t *msg ) {
 	for ( i = reliableAcknowledge + 1 ; i <= client->reliableSequence ; i++ ) {
 		MSG_WriteByte( msg, svc_serverCommand );
 		MSG_WriteLong( msg, i );
-		MSG_WriteString( msg, client->reliableCommands[ i & (MAX_RELIABLE_COMMANDS-1) ] );
+		MSG_WriteString( msg, SV_ReliableCommand( client, i ) );
 	}
 	client->reliableSent = client->reliableSequence;
 }
@@ -648,15 +881,9 @@ Return the number of msec a given size message is supposed
 to take to clear, based on the current rate
 ====================
 */
-#define	HEADER_RATE_BYTES	48		// include our header, IP header, and some overhead
-static int SV_RateMsec( client_t *client, int messageSize ) {
+static int SV_ClientRate( client_t *client ) {
 	int		rate;
-	int		rateMsec;
 
-	// individual messages will never be larger than fragment size
-	if ( messageSize > 1500 ) {
-		messageSize = 1500;
-	}
 	rate = client->rate;
 	if ( sv_maxRate->integer ) {
 		if ( sv_maxRate->integer < 1000 ) {
@@ -675,7 +902,18 @@ static int SV_RateMsec( client_t *client, int messageSize ) {
 		}
 	}
 
-	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / ((int) (rate * com_timescale->value));
+	return rate;
+}
+
+static int SV_RateMsec( client_t *client, int messageSize ) {
+	int		rateMsec;
+
+	// individual messages will never be larger than fragment size
+	if ( messageSize > 1500 ) {
+		messageSize = 1500;
+	}
+
+	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / ((int) (SV_ClientRate( client ) * com_timescale->value));
 
 	return rateMsec;
 }
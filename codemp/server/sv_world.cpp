@@ -470,6 +470,12 @@ Ghoul2 Insert Start
 
 	int			traceFlags;
 	int			useLod;
+
+	int			time;			// sv.time, or when the clients are rewound to
+	qboolean	rewind;			// clients are traced where they were at time
+	int			rewindFrom, rewindTo;
+	float		rewindFrac;
+	uint32_t	rewindSolid;	// clients that could be hit at time
 	trace_t		trace;			// make sure nothing goes under here for Ghoul2 collision purposes
 /*
 Ghoul2 Insert End
@@ -477,6 +483,179 @@ Ghoul2 Insert End
 } moveclip_t;
 
 
+/*
+===============================================================================
+
+LAG COMPENSATION
+
+Clients are never relinked to where they used to be. A rewound trace skips
+their current positions in the sector lists and clips against the recorded
+boxes instead.
+
+===============================================================================
+*/
+
+/*
+====================
+SV_RecordClientHistory
+
+Called after each game frame
+====================
+*/
+void SV_RecordClientHistory( void ) {
+	clientHistory_t	*history = &sv.clientHistory;
+	sharedEntity_t	*ent;
+	int				i, frame;
+	uint32_t		solid = 0;
+
+	// map_restart can take the time back
+	if ( history->numFrames && sv.time < history->time[(history->numFrames - 1) & (CLIENT_HISTORY_FRAMES - 1)] ) {
+		history->numFrames = 0;
+	}
+
+	frame = history->numFrames & (CLIENT_HISTORY_FRAMES - 1);
+	history->time[frame] = sv.time;
+
+	for ( i = 0 ; i < sv_maxclients->integer && i < MAX_CLIENTS ; i++ ) {
+		if ( svs.clients[i].state != CS_ACTIVE ) {
+			continue;
+		}
+		ent = SV_GentityNum( i );
+		if ( !ent->r.linked || !ent->r.contents || ent->r.bmodel ) {
+			continue;
+		}
+
+		solid |= 1u << i;
+		VectorCopy( ent->r.currentOrigin, history->origin[frame][i] );
+		VectorCopy( ent->r.mins, history->mins[frame][i] );
+		VectorCopy( ent->r.maxs, history->maxs[frame][i] );
+		VectorCopy( ent->s.apos.trBase, history->angles[frame][i] );
+	}
+
+	history->solid[frame] = solid;
+	history->numFrames++;
+}
+
+/*
+====================
+SV_RewindClients
+
+Picks the recorded frames either side of time, false if the clients
+haven't moved since then as far as the history knows
+====================
+*/
+static qboolean SV_RewindClients( moveclip_t *clip, int time ) {
+	const clientHistory_t *history = &sv.clientHistory;
+	const int	mask = CLIENT_HISTORY_FRAMES - 1;
+	int			newest, oldest, i;
+
+	if ( !history->numFrames ) {
+		return qfalse;
+	}
+
+	newest = history->numFrames - 1;
+	if ( time >= history->time[newest & mask] ) {
+		return qfalse;
+	}
+	if ( time < sv.time - CLIENT_HISTORY_MSEC ) {
+		time = sv.time - CLIENT_HISTORY_MSEC;
+	}
+
+	oldest = history->numFrames - CLIENT_HISTORY_FRAMES;
+	if ( oldest < 0 ) {
+		oldest = 0;
+	}
+
+	// usually only a few frames back
+	for ( i = newest ; i > oldest && history->time[(i - 1) & mask] > time ; i-- ) {
+	}
+
+	if ( i == oldest ) {
+		// older than anything recorded
+		clip->rewindFrom = clip->rewindTo = i & mask;
+		clip->rewindFrac = 0.0f;
+		clip->time = history->time[i & mask];
+	} else {
+		clip->rewindFrom = (i - 1) & mask;
+		clip->rewindTo = i & mask;
+		clip->rewindFrac = (float)(time - history->time[clip->rewindFrom]) / (history->time[clip->rewindTo] - history->time[clip->rewindFrom]);
+		clip->time = time;
+	}
+
+	clip->rewind = qtrue;
+	clip->rewindSolid = history->solid[clip->rewindFrom] | history->solid[clip->rewindTo];
+	return qtrue;
+}
+
+/*
+====================
+SV_RewoundClient
+
+Where a client in clip->rewindSolid was at clip->time
+====================
+*/
+static void SV_RewoundClient( const moveclip_t *clip, int clientNum, vec3_t origin, vec3_t mins, vec3_t maxs, vec3_t angles ) {
+	const clientHistory_t *history = &sv.clientHistory;
+	const uint32_t	bit = 1u << clientNum;
+	int				from = clip->rewindFrom, to = clip->rewindTo;
+	int				nearest, i;
+
+	// only there for one of the two, so don't blend
+	if ( !(history->solid[from] & bit) ) {
+		from = to;
+	} else if ( !(history->solid[to] & bit) ) {
+		to = from;
+	}
+
+	for ( i = 0 ; i < 3 ; i++ ) {
+		origin[i] = history->origin[from][clientNum][i] + clip->rewindFrac * ( history->origin[to][clientNum][i] - history->origin[from][clientNum][i] );
+	}
+
+	nearest = clip->rewindFrac < 0.5f ? from : to;
+	VectorCopy( history->mins[nearest][clientNum], mins );
+	VectorCopy( history->maxs[nearest][clientNum], maxs );
+	VectorCopy( history->angles[nearest][clientNum], angles );
+}
+
+/*
+====================
+SV_RewindTouchList
+
+Swaps the clients in the touch list for the ones whose recorded boxes
+touch the move
+====================
+*/
+static int SV_RewindTouchList( const moveclip_t *clip, int *touchlist, int num ) {
+	vec3_t	origin, mins, maxs, angles;
+	int		i, j, count;
+
+	for ( i = count = 0 ; i < num ; i++ ) {
+		if ( touchlist[i] >= MAX_CLIENTS ) {
+			touchlist[count++] = touchlist[i];
+		}
+	}
+
+	for ( i = 0 ; i < MAX_CLIENTS ; i++ ) {
+		if ( !(clip->rewindSolid & (1u << i)) ) {
+			continue;
+		}
+
+		SV_RewoundClient( clip, i, origin, mins, maxs, angles );
+
+		// same padding as SV_LinkEntity
+		for ( j = 0 ; j < 3 ; j++ ) {
+			if ( origin[j] + mins[j] - 1 > clip->boxmaxs[j] || origin[j] + maxs[j] + 1 < clip->boxmins[j] ) {
+				break;
+			}
+		}
+		if ( j == 3 ) {
+			touchlist[count++] = i;
+		}
+	}
+
+	return count;
+}
+
 /*
 ====================
 SV_ClipToEntity
@@ -536,13 +715,15 @@ static float VectorDistance(vec3_t p1, vec3_t p2)
 #endif
 
 static void SV_ClipMoveToEntities( moveclip_t *clip ) {
-	static int	touchlist[MAX_GENTITIES];
+	static int	touchlist[MAX_GENTITIES + MAX_CLIENTS];
 	int			i, num;
 	sharedEntity_t *touch;
 	int			passOwnerNum;
 	trace_t		trace, oldTrace= {0};
 	clipHandle_t	clipHandle;
 	float		*origin, *angles;
+	vec3_t		rewoundOrigin, rewoundMins, rewoundMaxs, rewoundAngles;
+	qboolean	rewound;
 	int			thisOwnerShared = 1;
 
 	if ( SV_GentityNum( clip->passEntityNum )->r.svFlags & SVF_GHOST ) {
@@ -552,6 +733,9 @@ static void SV_ClipMoveToEntities( moveclip_t *clip ) {
 	int flags = SV_GentityNum(clip->passEntityNum)->r.svFlags;
 
 	num = SV_AreaEntities( clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
+	if ( clip->rewind ) {
+		num = SV_RewindTouchList( clip, touchlist, num );
+	}
 
 	if ( clip->passEntityNum != ENTITYNUM_NONE ) {
 		passOwnerNum = ( SV_GentityNum( clip->passEntityNum ) )->r.ownerNum;
@@ -638,9 +822,15 @@ static void SV_ClipMoveToEntities( moveclip_t *clip ) {
 		}
 
 		// might intersect, so do an exact clip
-		clipHandle = SV_ClipHandleForEntity (touch);
-
-		origin = touch->r.currentOrigin;
+		rewound = (qboolean)( clip->rewind && touchlist[i] < MAX_CLIENTS );
+		if ( rewound ) {
+			SV_RewoundClient( clip, touchlist[i], rewoundOrigin, rewoundMins, rewoundMaxs, rewoundAngles );
+			clipHandle = CM_TempBoxModel( rewoundMins, rewoundMaxs, ( touch->r.svFlags & SVF_CAPSULE ) ? qtrue : qfalse );
+			origin = rewoundOrigin;
+		} else {
+			clipHandle = SV_ClipHandleForEntity (touch);
+			origin = touch->r.currentOrigin;
+		}
 		angles = touch->r.currentAngles;
 
 
@@ -758,7 +948,11 @@ Ghoul2 Insert Start
 				tN++;
 			}
 
-			if (touch->s.number < MAX_CLIENTS)
+			if (rewound)
+			{
+				VectorCopy(rewoundAngles, angles);
+			}
+			else if (touch->s.number < MAX_CLIENTS)
 			{
 				VectorCopy(touch->s.apos.trBase, angles);
 			}
@@ -783,11 +977,11 @@ Ghoul2 Insert Start
 				touch->s.NPC_class == CLASS_VEHICLE &&
 				touch->m_pVehicle)
 			{ //for vehicles cache the transform data.
-				re->G2API_CollisionDetectCache(G2Trace, *((CGhoul2Info_v *)touch->ghoul2), angles, touch->r.currentOrigin, sv.time, touch->s.number, clip->start, clip->end, touch->modelScale, G2VertSpaceServer, 0, clip->useLod, fRadius);
+				re->G2API_CollisionDetectCache(G2Trace, *((CGhoul2Info_v *)touch->ghoul2), angles, origin, clip->time, touch->s.number, clip->start, clip->end, touch->modelScale, G2VertSpaceServer, 0, clip->useLod, fRadius);
 			}
 			else
 			{
-				re->G2API_CollisionDetect(G2Trace, *((CGhoul2Info_v *)touch->ghoul2), angles, touch->r.currentOrigin, sv.time, touch->s.number, clip->start, clip->end, touch->modelScale, G2VertSpaceServer, 0, clip->useLod, fRadius);
+				re->G2API_CollisionDetect(G2Trace, *((CGhoul2Info_v *)touch->ghoul2), angles, origin, clip->time, touch->s.number, clip->start, clip->end, touch->modelScale, G2VertSpaceServer, 0, clip->useLod, fRadius);
 			}
 
 			tN = 0;
@@ -842,9 +1036,21 @@ passEntityNum and entities owned by passEntityNum are explicitly not checked.
 Ghoul2 Insert Start
 */
 void SV_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int traceFlags, int useLod ) {
+	SV_TimeShiftTrace( results, start, mins, maxs, end, passEntityNum, contentmask, capsule, traceFlags, useLod, sv.time );
+}
 /*
 Ghoul2 Insert End
 */
+
+/*
+==================
+SV_TimeShiftTrace
+
+SV_Trace with the clients where they were at the given time, for lag
+compensated hitscan weapons
+==================
+*/
+void SV_TimeShiftTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int traceFlags, int useLod, int time ) {
 	moveclip_t	clip;
 	int			i;
 
@@ -856,6 +1062,7 @@ Ghoul2 Insert End
 	}
 
 	Com_Memset ( &clip, 0, sizeof ( moveclip_t ) );
+	clip.time = sv.time;
 
 	// clip to world
 	CM_BoxTrace( &clip.trace, start, end, mins, maxs, 0, contentmask, capsule );
@@ -896,6 +1103,10 @@ Ghoul2 Insert End
 		}
 	}
 
+	if ( time < sv.time ) {
+		SV_RewindClients( &clip, time );
+	}
+
 	// clip to other solid entities
 	SV_ClipMoveToEntities ( &clip );
 
@@ -239,6 +239,9 @@ void NORETURN QDECL Sys_Error( const char *error, ... )
 
 	Sys_Print( string );
 
+	// keep the tail of the logs
+	Com_LogCrashFlush();
+
 	// Only print Sys_ErrorDialog for client binary. The dedicated
 	// server binary is meant to be a command line program so you would
 	// expect to see the error printed.
@@ -270,6 +273,42 @@ time_t Sys_FileTime( const char *path )
 	return buf.st_mtime;
 }
 
+/*
+============
+Sys_FileTimeForFile
+
+returns -1 if it can't be determined
+============
+*/
+time_t Sys_FileTimeForFile( FILE *f )
+{
+	struct stat buf;
+
+	if ( fstat( fileno( f ), &buf ) == -1 )
+		return -1;
+
+	return buf.st_mtime;
+}
+
+/*
+============
+Sys_FileStat
+
+returns qfalse if not present
+============
+*/
+qboolean Sys_FileStat( const char *path, int *size, time_t *mtime )
+{
+	struct stat buf;
+
+	if ( stat( path, &buf ) == -1 )
+		return qfalse;
+
+	*size = (int)buf.st_size;
+	*mtime = buf.st_mtime;
+	return qtrue;
+}
+
 /*
 =================
 Sys_UnloadDll
@@ -689,6 +728,7 @@ void Sys_SigHandler( int signal )
 #endif
 		SV_Shutdown(va("Received signal %d", signal) );
 		//VM_Forced_Unload_Done();
+		Com_LogCrashFlush();
 	}
 
 	if( signal == SIGTERM || signal == SIGINT )
@@ -150,6 +150,13 @@ void	Sys_FreeFileList( char **fileList );
 //rwwRMG - changed to fileList to not conflict with list type
 
 time_t Sys_FileTime( const char *path );
+time_t Sys_FileTimeForFile( FILE *f );
+qboolean Sys_FileStat( const char *path, int *size, time_t *mtime );
+
+void	*Sys_MapFile( FILE *f, int size );
+void	Sys_UnmapFile( void *data, int size );
+
+int		Sys_PID( void );
 
 qboolean Sys_LowPhysicalMemory();
 
@@ -27,6 +27,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <pwd.h>
 #include <libgen.h>
@@ -159,6 +160,48 @@ qboolean Sys_LowPhysicalMemory( void )
 	return qfalse;
 }
 
+/*
+==================
+Sys_PID
+==================
+*/
+int Sys_PID( void )
+{
+	return (int)getpid();
+}
+
+/*
+==================
+Sys_MapFile
+
+Maps an open file read-only, the mapping stays valid after the file is closed
+==================
+*/
+void *Sys_MapFile( FILE *f, int size )
+{
+	void *data;
+
+	if ( size <= 0 )
+		return NULL;
+
+	data = mmap( NULL, size, PROT_READ, MAP_SHARED, fileno( f ), 0 );
+	if ( data == MAP_FAILED )
+		return NULL;
+
+	return data;
+}
+
+/*
+==================
+Sys_UnmapFile
+==================
+*/
+void Sys_UnmapFile( void *data, int size )
+{
+	if ( data )
+		munmap( data, size );
+}
+
 /*
 ==================
 Sys_Basename
@@ -218,6 +218,49 @@ void Sys_SetProcessorAffinity( void ) {
 		Com_DPrintf( "Setting affinity mask failed (%s)\n", GetErrorString( GetLastError() ) );
 }
 
+/*
+==================
+Sys_PID
+==================
+*/
+int Sys_PID( void ) {
+	return (int)GetCurrentProcessId();
+}
+
+/*
+==================
+Sys_MapFile
+
+Maps an open file read-only, the mapping stays valid after the file is closed
+==================
+*/
+void *Sys_MapFile( FILE *f, int size ) {
+	HANDLE	mapping;
+	void	*data;
+
+	if ( size <= 0 )
+		return NULL;
+
+	mapping = CreateFileMapping( (HANDLE)_get_osfhandle( _fileno( f ) ), NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( !mapping )
+		return NULL;
+
+	data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, size );
+	CloseHandle( mapping );
+
+	return data;
+}
+
+/*
+==================
+Sys_UnmapFile
+==================
+*/
+void Sys_UnmapFile( void *data, int size ) {
+	if ( data )
+		UnmapViewOfFile( data );
+}
+
 /*
 ==================
 Sys_LowPhysicalMemory()